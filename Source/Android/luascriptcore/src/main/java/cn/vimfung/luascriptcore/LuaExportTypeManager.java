@@ -714,7 +714,16 @@ class LuaExportTypeManager
                 }
             }
 
-            exportFieldSet.add(String.format("%s_rw", fieldName));
+            String typeSignature = getTypeSignature(field.getType());
+            if (field.getType().isPrimitive() && !typeSignature.equals("@") && !Modifier.isFinal(modifier))
+            {
+                //基础类型字段附带类型签名，由原生层通过JNI直接读写，无需经过getterMethodRoute/setterMethodRoute进行装箱
+                exportFieldSet.add(String.format("%s_rw_%s", fieldName, typeSignature));
+            }
+            else
+            {
+                exportFieldSet.add(String.format("%s_rw", fieldName));
+            }
             exportFields.put(fieldName, field);
         }
 
@@ -12,12 +12,166 @@
 #include <jni.h>
 
 
+/**
+ * 根据字段类型签名获取基础类型
+ *
+ * @param typeSignature 类型签名
+ * @return 基础类型，非基础类型字段返回LuaValueTypeNil
+ */
+static LuaValueType getPrimitiveType(char typeSignature)
+{
+    switch (typeSignature)
+    {
+        case 'i':
+        case 's':
+        case 'q':
+            return LuaValueTypeInteger;
+        case 'f':
+        case 'd':
+            return LuaValueTypeNumber;
+        case 'B':
+            return LuaValueTypeBoolean;
+        default:
+            return LuaValueTypeNil;
+    }
+}
+
+/**
+ * 根据字段类型签名获取JNI字段签名
+ *
+ * @param typeSignature 类型签名
+ * @return JNI字段签名
+ */
+static const char* getJavaFieldSignature(char typeSignature)
+{
+    switch (typeSignature)
+    {
+        case 'i':
+            return "I";
+        case 's':
+            return "S";
+        case 'q':
+            return "J";
+        case 'f':
+            return "F";
+        case 'd':
+            return "D";
+        default:
+            return "Z";
+    }
+}
+
 LuaJavaExportPropertyDescriptor::LuaJavaExportPropertyDescriptor(std::string name,
                                                                  bool canRead,
                                                                  bool canWrite)
     : LuaExportPropertyDescriptor(name, canRead, canWrite)
 {
+    _typeSignature = '@';
+    _fieldId = NULL;
+}
+
+LuaJavaExportPropertyDescriptor::LuaJavaExportPropertyDescriptor(std::string name,
+                                                                 bool canRead,
+                                                                 bool canWrite,
+                                                                 std::string typeSignature)
+    : LuaExportPropertyDescriptor(name, canRead, canWrite, getPrimitiveType(typeSignature.empty() ? '@' : typeSignature[0]))
+{
+    _typeSignature = primitiveType() != LuaValueTypeNil ? typeSignature[0] : '@';
+    _fieldId = NULL;
+}
+
+jfieldID LuaJavaExportPropertyDescriptor::getFieldId(JNIEnv *env)
+{
+    if (_fieldId == NULL)
+    {
+        //字段标识在类型卸载前一直有效，多个线程同时获取时得到的是相同的标识
+        LuaJavaExportTypeDescriptor *javaTypeDescriptor = (LuaJavaExportTypeDescriptor *)typeDescriptor;
+        _fieldId = env -> GetFieldID(javaTypeDescriptor -> getJavaType(), name().c_str(), getJavaFieldSignature(_typeSignature));
+        if (env -> ExceptionCheck())
+        {
+            env -> ExceptionClear();
+            _fieldId = NULL;
+        }
+    }
+
+    return _fieldId;
+}
+
+LuaPrimitiveValue LuaJavaExportPropertyDescriptor::invokePrimitiveGetter(LuaObjectDescriptor *instance)
+{
+    LuaPrimitiveValue value;
+    value.integerValue = 0;
+
+    JNIEnv *env = LuaJavaEnv::getEnv();
+
+    jfieldID fieldId = getFieldId(env);
+    if (fieldId != NULL)
+    {
+        jobject jInstance = ((LuaJavaObjectDescriptor *)instance) -> getJavaObject();
+        switch (_typeSignature)
+        {
+            case 'i':
+                value.integerValue = env -> GetIntField(jInstance, fieldId);
+                break;
+            case 's':
+                value.integerValue = env -> GetShortField(jInstance, fieldId);
+                break;
+            case 'q':
+                value.integerValue = (lua_Integer)env -> GetLongField(jInstance, fieldId);
+                break;
+            case 'f':
+                value.numberValue = env -> GetFloatField(jInstance, fieldId);
+                break;
+            case 'd':
+                value.numberValue = env -> GetDoubleField(jInstance, fieldId);
+                break;
+            case 'B':
+                value.booleanValue = env -> GetBooleanField(jInstance, fieldId) == JNI_TRUE;
+                break;
+            default:
+                break;
+        }
+    }
+
+    LuaJavaEnv::resetEnv(env);
+
+    return value;
+}
+
+void LuaJavaExportPropertyDescriptor::invokePrimitiveSetter(LuaObjectDescriptor *instance, LuaPrimitiveValue value)
+{
+    JNIEnv *env = LuaJavaEnv::getEnv();
+
+    jfieldID fieldId = getFieldId(env);
+    if (fieldId != NULL)
+    {
+        jobject jInstance = ((LuaJavaObjectDescriptor *)instance) -> getJavaObject();
+        switch (_typeSignature)
+        {
+            case 'i':
+                env -> SetIntField(jInstance, fieldId, (jint)value.integerValue);
+                break;
+            case 's':
+                env -> SetShortField(jInstance, fieldId, (jshort)value.integerValue);
+                break;
+            case 'q':
+                env -> SetLongField(jInstance, fieldId, (jlong)value.integerValue);
+                break;
+            case 'f':
+                env -> SetFloatField(jInstance, fieldId, (jfloat)value.numberValue);
+                break;
+            case 'd':
+                env -> SetDoubleField(jInstance, fieldId, (jdouble)value.numberValue);
+                break;
+            case 'B':
+                env -> SetBooleanField(jInstance, fieldId, value.booleanValue ? JNI_TRUE : JNI_FALSE);
+                break;
+            default:
+                break;
+        }
+    }
 
+    LuaJavaEnv::resetEnv(env);
 }
 
 LuaValue* LuaJavaExportPropertyDescriptor::invokeGetter(LuaSession *session, LuaObjectDescriptor *instance)
@@ -6,6 +6,7 @@
 #define ANDROID_LUAJAVAEXPORTPROPERTYDESCRIPTOR_H
 
 #include "LuaExportPropertyDescriptor.hpp"
+#include <jni.h>
 
 using namespace cn::vimfung::luascriptcore;
 
@@ -27,6 +28,19 @@ public:
                                     bool canRead,
                                     bool canWrite);
 
+    /**
+     * 初始化基础类型字段，读写时通过JNI直接存取字段值
+     *
+     * @param name 属性名称
+     * @param canRead 是否可读
+     * @param canWrite 是否可写
+     * @param typeSignature 字段类型签名，如i、s、q、f、d、B
+     */
+    LuaJavaExportPropertyDescriptor(std::string name,
+                                    bool canRead,
+                                    bool canWrite,
+                                    std::string typeSignature);
+
     /**
      调用Getter方法
 
@@ -45,6 +59,42 @@ public:
      @param value 属性值
      */
     virtual void invokeSetter(LuaSession *session, LuaObjectDescriptor *instance, LuaValue *value);
+
+    /**
+     调用基础类型Getter
+
+     @param instance 实例对象
+     @return 属性值
+     */
+    virtual LuaPrimitiveValue invokePrimitiveGetter(LuaObjectDescriptor *instance);
+
+    /**
+     调用基础类型Setter
+
+     @param instance 实例对象
+     @param value 属性值
+     */
+    virtual void invokePrimitiveSetter(LuaObjectDescriptor *instance, LuaPrimitiveValue value);
+
+private:
+
+    /**
+     * 字段类型签名
+     */
+    char _typeSignature;
+
+    /**
+     * 字段标识，首次读写时获取
+     */
+    jfieldID _fieldId;
+
+    /**
+     * 获取字段标识
+     *
+     * @param env JNI环境
+     * @return 字段标识
+     */
+    jfieldID getFieldId(JNIEnv *env);
 };
 
 
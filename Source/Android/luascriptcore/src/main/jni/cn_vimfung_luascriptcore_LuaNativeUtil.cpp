@@ -362,7 +362,16 @@ JNIEXPORT jboolean JNICALL Java_cn_vimfung_luascriptcore_LuaNativeUtil_registerT
                 canWrite = true;
             }
 
-            LuaJavaExportPropertyDescriptor *propertyDescriptor = new LuaJavaExportPropertyDescriptor(fieldComps[0], canRead, canWrite);
+            LuaJavaExportPropertyDescriptor *propertyDescriptor = NULL;
+            if (fieldComps.size() > 2)
+            {
+                //基础类型字段附带类型签名
+                propertyDescriptor = new LuaJavaExportPropertyDescriptor(fieldComps[0], canRead, canWrite, fieldComps[2]);
+            }
+            else
+            {
+                propertyDescriptor = new LuaJavaExportPropertyDescriptor(fieldComps[0], canRead, canWrite);
+            }
             typeDescriptor -> addProperty(propertyDescriptor -> name(), propertyDescriptor);
             propertyDescriptor -> release();
 
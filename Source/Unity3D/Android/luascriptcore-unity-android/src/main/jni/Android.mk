@@ -72,6 +72,12 @@ LOCAL_SRC_FILES := \
 	../../../../../../lua-common/LuaExportPropertyDescriptor.cpp \
 	../../../../../../lua-common/LuaTmpValue.cpp \
 	../../../../../../lua-common/LuaOperationQueue.cpp \
+	../../../../../../lua-common/LuaTableValue.cpp \
+	../../../../../../lua-common/LuaBytecodeCache.cpp \
+	../../../../../../lua-common/LuaAllocator.cpp \
+	../../../../../../lua-common/LuaGCScheduler.cpp \
+	../../../../../../lua-common/LuaContextGroup.cpp \
+	../../../../../../lua-common/LuaContextPool.cpp \
 
 LOCAL_C_INCLUDES += $(LOCAL_PATH)
 LOCAL_C_INCLUDES += $(LOCAL_PATH)/../../../../../../lua-core/src
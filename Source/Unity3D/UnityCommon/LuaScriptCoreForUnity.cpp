@@ -73,23 +73,27 @@ extern "C" {
             }
             
             //paramsBuffer的内由C#端进行释放
-            const void *paramsBuffer = encoder -> cloneBuffer();
-            void *returnBuffer = methodPtr(context -> objectId(), methodName.c_str(), paramsBuffer, encoder -> getBufferLength());
+            int paramsLength = encoder -> getBufferLength();
+            const void *paramsBuffer = encoder -> detachBuffer();
+            int returnLength = 0;
+            void *returnBuffer = methodPtr(context -> objectId(), methodName.c_str(), paramsBuffer, paramsLength, &returnLength);
             
             encoder -> release();
             
             LuaValue *retValue = NULL;
             if (returnBuffer != NULL)
             {
-                LuaObjectDecoder *decoder = new LuaObjectDecoder(context, returnBuffer);
+                LuaObjectDecoder *decoder = new LuaObjectDecoder(context, returnBuffer, returnLength);
                 retValue = dynamic_cast<LuaValue *>(decoder -> readObject());
                 decoder -> release();
                 
                 //释放C＃中申请的内存
                 free(returnBuffer);
             }
-            else
+
+            if (retValue == NULL)
             {
+                //返回值为空或数据不完整时返回nil
                 retValue = LuaValue::NilValue();
             }
             
@@ -290,16 +294,19 @@ extern "C" {
         return 0;
     }
     
-    void setGlobal(int nativeContextId, const char *name, const void *value)
+    void setGlobal(int nativeContextId, const char *name, const void *value, int valueSize)
     {
         LuaContext *context = dynamic_cast<LuaContext *>(LuaObjectManager::SharedInstance() -> getObject(nativeContextId));
         if (context != NULL)
         {
-            LuaObjectDecoder *decoder = new LuaObjectDecoder(context, value);
+            LuaObjectDecoder *decoder = new LuaObjectDecoder(context, value, valueSize);
             
-            LuaValue *value =  (LuaValue *)decoder -> readObject();
-            context -> setGlobal(name, value);
-            value -> release();
+            LuaValue *value = dynamic_cast<LuaValue *>(decoder -> readObject());
+            if (value != NULL)
+            {
+                context -> setGlobal(name, value);
+                value -> release();
+            }
             
             decoder -> release();
         }
@@ -323,31 +330,37 @@ extern "C" {
         return 0;
     }
     
-    void retainValue(int nativeContextId, const void *value)
+    void retainValue(int nativeContextId, const void *value, int valueSize)
     {
         LuaContext *context = dynamic_cast<LuaContext *>(LuaObjectManager::SharedInstance() -> getObject(nativeContextId));
         if (context != NULL)
         {
-            LuaObjectDecoder *decoder = new LuaObjectDecoder(context, value);
+            LuaObjectDecoder *decoder = new LuaObjectDecoder(context, value, valueSize);
             
-            LuaValue *value =  (LuaValue *)decoder -> readObject();
-            context -> retainValue(value);
-            value -> release();
+            LuaValue *value = dynamic_cast<LuaValue *>(decoder -> readObject());
+            if (value != NULL)
+            {
+                context -> retainValue(value);
+                value -> release();
+            }
             
             decoder -> release();
         }
     }
     
-    void releaseValue(int nativeContextId, const void *value)
+    void releaseValue(int nativeContextId, const void *value, int valueSize)
     {
         LuaContext *context = dynamic_cast<LuaContext *>(LuaObjectManager::SharedInstance() -> getObject(nativeContextId));
         if (context != NULL)
         {
-            LuaObjectDecoder *decoder = new LuaObjectDecoder(context, value);
+            LuaObjectDecoder *decoder = new LuaObjectDecoder(context, value, valueSize);
             
-            LuaValue *value =  (LuaValue *)decoder -> readObject();
-            context -> releaseValue(value);
-            value -> release();
+            LuaValue *value = dynamic_cast<LuaValue *>(decoder -> readObject());
+            if (value != NULL)
+            {
+                context -> releaseValue(value);
+                value -> release();
+            }
             
             decoder -> release();
         }
@@ -360,11 +373,12 @@ extern "C" {
      @param nativeContextId 本地上下文对象ID
      @param methodName 方法名称
      @param params 参数列表
+     @param paramsSize 参数列表缓存长度
      @param result 返回值（输出参数）
      
      @return 返回值的缓冲区大小
      */
-    int callMethod(int nativeContextId, const char* methodName, const void *params, const void** result)
+    int callMethod(int nativeContextId, const char* methodName, const void *params, int paramsSize, const void** result)
     {
         LuaContext *context = dynamic_cast<LuaContext *>(LuaObjectManager::SharedInstance() -> getObject(nativeContextId));
         if (context != NULL)
@@ -373,7 +387,7 @@ extern "C" {
             
             if (params != NULL)
             {
-                LuaObjectDecoder *decoder = new LuaObjectDecoder(context, params);
+                LuaObjectDecoder *decoder = new LuaObjectDecoder(context, params, paramsSize);
                 int size = decoder -> readInt32();
                 
                 for (int i = 0; i < size; i++)
@@ -413,25 +427,33 @@ extern "C" {
      
      @param nativeContextId 本地上下文对象ID
      @param function 方法
+     @param functionSize 方法缓存长度
      @param params 参数列表
+     @param paramsSize 参数列表缓存长度
      @param result 返回值（输出参数）
      
      @return 返回值的缓冲区大小
      */
-    int invokeLuaFunction(int nativeContextId, const void* function, const void *params, const void **result)
+    int invokeLuaFunction(int nativeContextId, const void* function, int functionSize, const void *params, int paramsSize, const void **result)
     {
         LuaContext *context = dynamic_cast<LuaContext *>(LuaObjectManager::SharedInstance() -> getObject(nativeContextId));
         if (context != NULL && function != NULL)
         {
-            LuaObjectDecoder *decoder = new LuaObjectDecoder(context, function);
+            LuaObjectDecoder *decoder = new LuaObjectDecoder(context, function, functionSize);
             LuaFunction *func = dynamic_cast<LuaFunction *>(decoder -> readObject());
             decoder -> release();
             
+            if (func == NULL)
+            {
+                //方法数据不完整
+                return 0;
+            }
+            
             LuaArgumentList args;
             
             if (params != NULL)
             {
-                LuaObjectDecoder *decoder = new LuaObjectDecoder(context, params);
+                LuaObjectDecoder *decoder = new LuaObjectDecoder(context, params, paramsSize);
                 int size = decoder -> readInt32();
                 
                 for (int i = 0; i < size; i++)
@@ -490,8 +512,11 @@ extern "C" {
                      const char *typeName,
                      const char *parentTypeName,
                      const void *exportsPropertyNames,
+                     int exportsPropertyNamesSize,
                      const void *exportsInstanceMethodNames,
+                     int exportsInstanceMethodNamesSize,
                      const void *exportsClassMethodNames,
+                     int exportsClassMethodNamesSize,
                      LuaInstanceCreateHandlerPtr instanceCreateHandler,
                      LuaInstanceDestoryHandlerPtr instanceDestroyHandler,
                      LuaInstanceDescriptionHandlerPtr instanceDescriptionHandler,
@@ -540,7 +565,7 @@ extern "C" {
             if (exportsClassMethodNames != NULL)
             {
                 //注册类方法
-                LuaObjectDecoder *decoder = new LuaObjectDecoder(context, exportsClassMethodNames);
+                LuaObjectDecoder *decoder = new LuaObjectDecoder(context, exportsClassMethodNames, exportsClassMethodNamesSize);
                 int size = decoder -> readInt32();
                 for (int i = 0; i < size; i++)
                 {
@@ -557,7 +582,7 @@ extern "C" {
             if (exportsInstanceMethodNames != NULL)
             {
                 //注册实例方法
-                LuaObjectDecoder *decoder = new LuaObjectDecoder(context, exportsInstanceMethodNames);
+                LuaObjectDecoder *decoder = new LuaObjectDecoder(context, exportsInstanceMethodNames, exportsInstanceMethodNamesSize);
                 int size = decoder -> readInt32();
                 for (int i = 0; i < size; i++)
                 {
@@ -574,7 +599,7 @@ extern "C" {
             if (exportsPropertyNames != NULL)
             {
                 //注册属性
-                LuaObjectDecoder *decoder = new LuaObjectDecoder(context, exportsPropertyNames);
+                LuaObjectDecoder *decoder = new LuaObjectDecoder(context, exportsPropertyNames, exportsPropertyNamesSize);
                 int size = decoder -> readInt32();
                 for (int i = 0; i < size; i++)
                 {
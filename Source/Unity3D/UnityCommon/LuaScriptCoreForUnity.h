@@ -92,8 +92,9 @@ extern "C" {
      @param nativeContextId 本地上下文对象ID
      @param name 变量名称
      @param value 变量值
+     @param valueSize 变量值缓存长度
      */
-    LuaScriptCoreApi extern void setGlobal(int nativeContextId, const char *name, const void *value);
+    LuaScriptCoreApi extern void setGlobal(int nativeContextId, const char *name, const void *value, int valueSize);
     
     /**
      获取全局变量
@@ -111,8 +112,9 @@ extern "C" {
 
      @param nativeContextId 本地上下文对象ID
      @param value 变量值
+     @param valueSize 变量值缓存长度
      */
-    LuaScriptCoreApi extern void retainValue(int nativeContextId, const void *value);
+    LuaScriptCoreApi extern void retainValue(int nativeContextId, const void *value, int valueSize);
     
     
     /**
@@ -120,8 +122,9 @@ extern "C" {
 
      @param nativeContextId 本地上下文对象ID
      @param value 变量值
+     @param valueSize 变量值缓存长度
      */
-    LuaScriptCoreApi extern void releaseValue(int nativeContextId, const void *value);
+    LuaScriptCoreApi extern void releaseValue(int nativeContextId, const void *value, int valueSize);
     
     /**
      解析Lua脚本
@@ -152,23 +155,26 @@ extern "C" {
      @param nativeContextId 本地上下文对象ID
      @param methodName 方法名称
      @param params 参数列表
+     @param paramsSize 参数列表缓存长度
      @param result 返回值（输出参数）
      
      @return 返回值的缓冲区大小
      */
-	LuaScriptCoreApi extern int callMethod(int nativeContextId, const char* methodName, const void *params, const void **result);
+	LuaScriptCoreApi extern int callMethod(int nativeContextId, const char* methodName, const void *params, int paramsSize, const void **result);
     
     /**
      调用Lua方法
      
      @param nativeContextId 本地上下文对象ID
      @param function 方法
+     @param functionSize 方法缓存长度
      @param params 参数列表
+     @param paramsSize 参数列表缓存长度
      @param result 返回值（输出参数）
      
      @return 返回值的缓冲区大小
      */
-    LuaScriptCoreApi extern int invokeLuaFunction(int nativeContextId, const void* function, const void *params, const void **result);
+    LuaScriptCoreApi extern int invokeLuaFunction(int nativeContextId, const void* function, int functionSize, const void *params, int paramsSize, const void **result);
     
     
     /**
@@ -189,8 +195,11 @@ extern "C" {
      @param typeName 类名称
      @param parentTypeName 父类名称
      @param exportsPropertyNames 导出属性名称列表,元素组成形式:propertyname_[rw|r]
+     @param exportsPropertyNamesSize 导出属性名称列表缓存长度
      @param exportsInstanceMethodNames 导出实例方法名称列表
+     @param exportsInstanceMethodNamesSize 导出实例方法名称列表缓存长度
      @param exportsClassMethodNames 导出类方法名称列表
+     @param exportsClassMethodNamesSize 导出类方法名称列表缓存长度
      @param instanceCreateHandler 实例创建处理回调
      @param instanceDestroyHandler 实例销毁处理回调
      @param instanceDescriptionHandler 类型描述处理器回调
@@ -205,8 +214,11 @@ extern "C" {
                                              const char *typeName,
                                              const char *parentTypeName,
                                              const void *exportsPropertyNames,
+                                             int exportsPropertyNamesSize,
                                              const void *exportsInstanceMethodNames,
+                                             int exportsInstanceMethodNamesSize,
                                              const void *exportsClassMethodNames,
+                                             int exportsClassMethodNamesSize,
                                              LuaInstanceCreateHandlerPtr instanceCreateHandler,
                                              LuaInstanceDestoryHandlerPtr instanceDestroyHandler,
                                              LuaInstanceDescriptionHandlerPtr instanceDescriptionHandler,
@@ -34,9 +34,9 @@ extern "C" {
     typedef char* (*LuaGetClassNameByInstanceHandlerPtr) (const void *object);
 
     /**
-     Lua方法处理器
+     Lua方法处理器，返回值缓存长度通过最后一个参数输出
      */
-    typedef void* (*LuaMethodHandlerPtr)(int, const char *, const void *, int);
+    typedef void* (*LuaMethodHandlerPtr)(int, const char *, const void *, int, int *);
 
     /**
      Lua实例创建处理器
@@ -56,17 +56,17 @@ extern "C" {
     /**
      Lua类方法处理器
      */
-    typedef void* (*LuaModuleMethodHandlerPtr) (int contextId, int moduleId, const char *methodName, const void *argumentsBuffer, int bufferSize);
+    typedef void* (*LuaModuleMethodHandlerPtr) (int contextId, int moduleId, const char *methodName, const void *argumentsBuffer, int bufferSize, int *resultSize);
     
     /**
      Lua实例方法处理器
      */
-    typedef void* (*LuaInstanceMethodHandlerPtr) (int contextId, int classId,  long long instance, const char *methodName, const void *argumentsBuffer, int bufferSize);
+    typedef void* (*LuaInstanceMethodHandlerPtr) (int contextId, int classId,  long long instance, const char *methodName, const void *argumentsBuffer, int bufferSize, int *resultSize);
 
     /**
      Lua实例字段获取器
      */
-    typedef void* (*LuaInstanceFieldGetterHandlerPtr) (int contextId, int classId, long long instance, const char *fieldName);
+    typedef void* (*LuaInstanceFieldGetterHandlerPtr) (int contextId, int classId, long long instance, const char *fieldName, int *resultSize);
 
     /**
      Lua实例字段设置处理器
@@ -58,27 +58,32 @@ LuaValue* LuaUnityExportMethodDescriptor::invokeClassMethod(LuaSession *session,
         
         //paramsBuffer的内容由C#端进行释放
         std::string methodName = StringUtils::format("%s_%s", name().c_str(), methodSignature().c_str());
-        const void *paramsBuffer = encoder -> cloneBuffer();
+        int paramsLength = encoder -> getBufferLength();
+        const void *paramsBuffer = encoder -> detachBuffer();
+        int returnLength = 0;
         void *returnBuffer = _classMethodHandler(session -> getContext() -> objectId(),
                                                  typeDescriptor -> objectId(),
                                                  methodName.c_str(),
                                                  paramsBuffer,
-                                                 encoder -> getBufferLength());
+                                                 paramsLength,
+                                                 &returnLength);
 
         encoder -> release();
 
         LuaValue *retValue = NULL;
         if (returnBuffer != NULL)
         {
-            LuaObjectDecoder *decoder = new LuaObjectDecoder(session -> getContext(), returnBuffer);
+            LuaObjectDecoder *decoder = new LuaObjectDecoder(session -> getContext(), returnBuffer, returnLength);
             retValue = dynamic_cast<LuaValue *>(decoder -> readObject());
             decoder -> release();
 
             //释放C＃中申请的内存
             free(returnBuffer);
         }
-        else
+
+        if (retValue == NULL)
         {
+            //返回值为空或数据不完整时返回nil
             retValue = LuaValue::NilValue();
         }
         
@@ -108,28 +113,33 @@ LuaValue* LuaUnityExportMethodDescriptor::invokeInstanceMethod(LuaSession *sessi
         
         //paramsBuffer的内容由C#端进行释放
         std::string methodName = StringUtils::format("%s_%s", name().c_str(), methodSignature().c_str());
-        const void *paramsBuffer = encoder -> cloneBuffer();
+        int paramsLength = encoder -> getBufferLength();
+        const void *paramsBuffer = encoder -> detachBuffer();
+        int returnLength = 0;
         void *returnBuffer = _instanceMethodHandler(session -> getContext() -> objectId(),
                                                     typeDescriptor -> objectId(),
                                                     (long long) instance -> getObject(),
                                                     methodName.c_str(),
                                                     paramsBuffer,
-                                                    encoder -> getBufferLength());
+                                                    paramsLength,
+                                                    &returnLength);
         
         encoder -> release();
         
         LuaValue *retValue = NULL;
         if (returnBuffer != NULL)
         {
-            LuaObjectDecoder *decoder = new LuaObjectDecoder(session -> getContext(), returnBuffer);
+            LuaObjectDecoder *decoder = new LuaObjectDecoder(session -> getContext(), returnBuffer, returnLength);
             retValue = dynamic_cast<LuaValue *>(decoder -> readObject());
             decoder -> release();
             
             //释放C＃中申请的内存
             free(returnBuffer);
         }
-        else
+
+        if (retValue == NULL)
         {
+            //返回值为空或数据不完整时返回nil
             retValue = LuaValue::NilValue();
         }
         
@@ -33,21 +33,25 @@ LuaValue* LuaUnityExportPropertyDescriptor::invokeGetter(LuaSession *session, Lu
     {
         if (_getterHandler != NULL)
         {
+            int returnLength = 0;
             void *returnBuffer = _getterHandler (session -> getContext() -> objectId(),
                                                  typeDescriptor -> objectId(),
                                                  (long long) instance -> getObject(),
-                                                 name().c_str());
+                                                 name().c_str(),
+                                                 &returnLength);
             if (returnBuffer != NULL)
             {
-                LuaObjectDecoder *decoder = new LuaObjectDecoder(session -> getContext(), returnBuffer);
+                LuaObjectDecoder *decoder = new LuaObjectDecoder(session -> getContext(), returnBuffer, returnLength);
                 retValue = dynamic_cast<LuaValue *>(decoder -> readObject());
                 decoder -> release();
                 
                 //释放C＃中申请的内存
                 free(returnBuffer);
             }
-            else
+
+            if (retValue == NULL)
             {
+                //返回值为空或数据不完整时返回nil
                 retValue = LuaValue::NilValue();
             }
         }
@@ -79,14 +83,15 @@ void LuaUnityExportPropertyDescriptor::invokeSetter(LuaSession *session, LuaObje
             }
             
             //valueBuf的内容由C#端进行释放
-            const void *valueBuf = encoder -> cloneBuffer();
+            int valueLength = encoder -> getBufferLength();
+            const void *valueBuf = encoder -> detachBuffer();
             
             _setterHandler (session -> getContext() -> objectId(),
                             typeDescriptor -> objectId(),
                             (long long) instance -> getObject(),
                             name().c_str(),
                             valueBuf,
-                            encoder -> getBufferLength());
+                            valueLength);
             
             encoder -> release();
         }
@@ -53,8 +53,9 @@ LuaObjectDescriptor* LuaUnityExportTypeDescriptor::createInstance(LuaSession *se
             encoder -> writeObject(value);
         }
         
-        const void *paramsBuffer = encoder -> cloneBuffer();
-        long long instanceId = createInstanceHandler(context -> objectId(), objectId(), paramsBuffer, encoder -> getBufferLength());
+        int paramsLength = encoder -> getBufferLength();
+        const void *paramsBuffer = encoder -> detachBuffer();
+        long long instanceId = createInstanceHandler(context -> objectId(), objectId(), paramsBuffer, paramsLength);
         encoder -> release();
         
         if (instanceId != -1)
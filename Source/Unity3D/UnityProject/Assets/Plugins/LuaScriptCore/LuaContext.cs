@@ -218,17 +218,19 @@ namespace cn.vimfung.luascriptcore
 		public void setGlobal(string name, LuaValue value)
 		{
 			IntPtr valuePtr = IntPtr.Zero;
+			int valueSize = 0;
 			if (value != null)
 			{
 				LuaObjectEncoder encoder = new LuaObjectEncoder (this);
 				encoder.writeObject (value);
 
 				byte[] bytes = encoder.bytes;
+				valueSize = bytes.Length;
 				valuePtr = Marshal.AllocHGlobal (bytes.Length);
 				Marshal.Copy (bytes, 0, valuePtr, bytes.Length);
 			}
 				
-			NativeUtils.setGlobal (_nativeObjectId, name, valuePtr);
+			NativeUtils.setGlobal (_nativeObjectId, name, valuePtr, valueSize);
 
 			if (valuePtr != IntPtr.Zero)
 			{
@@ -273,7 +275,7 @@ namespace cn.vimfung.luascriptcore
 				valuePtr = Marshal.AllocHGlobal (bytes.Length);
 				Marshal.Copy (bytes, 0, valuePtr, bytes.Length);
 
-				NativeUtils.retainValue (_nativeObjectId, valuePtr);
+				NativeUtils.retainValue (_nativeObjectId, valuePtr, bytes.Length);
 
 				if (valuePtr != IntPtr.Zero)
 				{
@@ -300,7 +302,7 @@ namespace cn.vimfung.luascriptcore
 				valuePtr = Marshal.AllocHGlobal (bytes.Length);
 				Marshal.Copy (bytes, 0, valuePtr, bytes.Length);
 
-				NativeUtils.releaseValue (_nativeObjectId, valuePtr);
+				NativeUtils.releaseValue (_nativeObjectId, valuePtr, bytes.Length);
 
 				if (valuePtr != IntPtr.Zero)
 				{
@@ -376,6 +378,7 @@ namespace cn.vimfung.luascriptcore
 		public LuaValue callMethod(string methodName, List<LuaValue> arguments)
 		{
 			IntPtr argsPtr = IntPtr.Zero;
+			int argsSize = 0;
 			IntPtr resultPtr = IntPtr.Zero;
 
 			if (arguments != null)
@@ -388,11 +391,12 @@ namespace cn.vimfung.luascriptcore
 				}
 
 				byte[] bytes = encoder.bytes;
+				argsSize = bytes.Length;
 				argsPtr = Marshal.AllocHGlobal (bytes.Length);
 				Marshal.Copy (bytes, 0, argsPtr, bytes.Length);
 			}
 
-			int size = NativeUtils.callMethod (_nativeObjectId, methodName, argsPtr, out resultPtr);
+			int size = NativeUtils.callMethod (_nativeObjectId, methodName, argsPtr, argsSize, out resultPtr);
 
 			if (argsPtr != IntPtr.Zero)
 			{
@@ -431,8 +435,10 @@ namespace cn.vimfung.luascriptcore
 		/// <returns>返回值</returns>
 		/// <param name="methodName">方法名称</param>
 		/// <param name="arguments">参数列表</param>
-		private IntPtr luaMethodHandler(string methodName, IntPtr args, int size)
+		/// <param name="resultSize">返回值缓冲区大小.</param>
+		private IntPtr luaMethodHandler(string methodName, IntPtr args, int size, out int resultSize)
 		{
+			resultSize = 0;
 			if (_methodHandlers.ContainsKey (methodName))
 			{
 				//反序列化参数列表
@@ -461,6 +467,7 @@ namespace cn.vimfung.luascriptcore
 				IntPtr retPtr;
 				retPtr = Marshal.AllocHGlobal (bytes.Length);
 				Marshal.Copy (bytes, 0, retPtr, bytes.Length);
+				resultSize = bytes.Length;
 
 				return retPtr;
 			}
@@ -602,15 +609,17 @@ namespace cn.vimfung.luascriptcore
 		/// <param name="methodName">方法名称.</param>
 		/// <param name="arguments">参数列表缓冲区.</param>
 		/// <param name="size">参数列表缓冲区大小.</param>
+		/// <param name="resultSize">返回值缓冲区大小.</param>
 		[MonoPInvokeCallback (typeof (LuaMethodHandleDelegate))]
-		private static IntPtr luaMethodRoute (int nativeContextId, string methodName, IntPtr arguments, int size)
+		private static IntPtr luaMethodRoute (int nativeContextId, string methodName, IntPtr arguments, int size, out int resultSize)
 		{
+			resultSize = 0;
 			if (_contexts.ContainsKey (nativeContextId)) 
 			{
 				LuaContext context = _contexts [nativeContextId].Target as LuaContext;
 				if (context != null) 
 				{
-					return context.luaMethodHandler (methodName, arguments, size);
+					return context.luaMethodHandler (methodName, arguments, size, out resultSize);
 				}
 			}
 
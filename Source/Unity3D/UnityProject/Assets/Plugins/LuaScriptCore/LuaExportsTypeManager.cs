@@ -258,6 +258,7 @@ namespace cn.vimfung.luascriptcore
 
 			//创建导出的字段数据
 			IntPtr exportPropertyNamesPtr = IntPtr.Zero;
+			int exportPropertyNamesSize = 0;
 			if (exportPropertyNames.Count > 0)
 			{
 				LuaObjectEncoder fieldEncoder = new LuaObjectEncoder (context);
@@ -268,6 +269,7 @@ namespace cn.vimfung.luascriptcore
 				}
 
 				byte[] fieldNameBytes = fieldEncoder.bytes;
+				exportPropertyNamesSize = fieldNameBytes.Length;
 				exportPropertyNamesPtr = Marshal.AllocHGlobal (fieldNameBytes.Length); 
 				Marshal.Copy (fieldNameBytes, 0, exportPropertyNamesPtr, fieldNameBytes.Length);
 			}
@@ -275,6 +277,7 @@ namespace cn.vimfung.luascriptcore
 
 			//创建导出的实例方法数据
 			IntPtr exportInstanceMethodNamesPtr = IntPtr.Zero;
+			int exportInstanceMethodNamesSize = 0;
 			if (exportInstanceMethodNames.Count > 0)
 			{
 				LuaObjectEncoder instanceMethodEncoder = new LuaObjectEncoder (context);
@@ -285,6 +288,7 @@ namespace cn.vimfung.luascriptcore
 				}
 
 				byte[] instMethodNameBytes = instanceMethodEncoder.bytes;
+				exportInstanceMethodNamesSize = instMethodNameBytes.Length;
 				exportInstanceMethodNamesPtr = Marshal.AllocHGlobal (instMethodNameBytes.Length);
 				Marshal.Copy (instMethodNameBytes, 0, exportInstanceMethodNamesPtr, instMethodNameBytes.Length);
 			}
@@ -292,6 +296,7 @@ namespace cn.vimfung.luascriptcore
 
 			//创建导出类方法数据
 			IntPtr exportClassMethodNamesPtr = IntPtr.Zero;
+			int exportClassMethodNamesSize = 0;
 			if (exportClassMethodNames.Count > 0)
 			{
 				LuaObjectEncoder classMethodEncoder = new LuaObjectEncoder (context);
@@ -302,6 +307,7 @@ namespace cn.vimfung.luascriptcore
 				}
 
 				byte[] classMethodNameBytes = classMethodEncoder.bytes;
+				exportClassMethodNamesSize = classMethodNameBytes.Length;
 				exportClassMethodNamesPtr = Marshal.AllocHGlobal (classMethodNameBytes.Length);
 				Marshal.Copy (classMethodNameBytes, 0, exportClassMethodNamesPtr, classMethodNameBytes.Length);
 			}
@@ -354,8 +360,11 @@ namespace cn.vimfung.luascriptcore
 				t.FullName,
 				t.BaseType.FullName,
 				exportPropertyNamesPtr,
+				exportPropertyNamesSize,
 				exportInstanceMethodNamesPtr,
+				exportInstanceMethodNamesSize,
 				exportClassMethodNamesPtr,
+				exportClassMethodNamesSize,
 				Marshal.GetFunctionPointerForDelegate(_createInstanceDelegate),
 				Marshal.GetFunctionPointerForDelegate(_destroyInstanceDelegate),
 				Marshal.GetFunctionPointerForDelegate(_instanceDescriptionDelegate),
@@ -486,10 +495,12 @@ namespace cn.vimfung.luascriptcore
 		/// <param name="classId">类标识.</param>
 		/// <param name="instance">实例.</param>
 		/// <param name="fieldName">字段名称.</param>
+		/// <param name="resultSize">返回值数据大小.</param>
 		[MonoPInvokeCallback (typeof (LuaInstanceFieldGetterHandleDelegate))]
-		private static IntPtr _fieldGetter (int contextId, int classId, Int64 instancePtr, string fieldName)
+		private static IntPtr _fieldGetter (int contextId, int classId, Int64 instancePtr, string fieldName, out int resultSize)
 		{
 			IntPtr retValuePtr = IntPtr.Zero;
+			resultSize = 0;
 			if (instancePtr != 0)
 			{
 				LuaContext context = LuaContext.getContext (contextId);
@@ -526,6 +537,7 @@ namespace cn.vimfung.luascriptcore
 					byte[] bytes = encoder.bytes;
 					retValuePtr = Marshal.AllocHGlobal (bytes.Length);
 					Marshal.Copy (bytes, 0, retValuePtr, bytes.Length);
+					resultSize = bytes.Length;
 				}
 
 			}
@@ -585,9 +597,11 @@ namespace cn.vimfung.luascriptcore
 		/// <param name="methodName">方法名称</param>
 		/// <param name="argumentsBuffer">参数数据</param>
 		/// <param name="bufferSize">数据大小.</param>
+		/// <param name="resultSize">返回值数据大小.</param>
 		[MonoPInvokeCallback (typeof (LuaInstanceMethodHandleDelegate))]
-		private static IntPtr _instanceMethodHandler (int contextId, int classId, Int64 instancePtr, string methodName, IntPtr argumentsBuffer, int bufferSize)
+		private static IntPtr _instanceMethodHandler (int contextId, int classId, Int64 instancePtr, string methodName, IntPtr argumentsBuffer, int bufferSize, out int resultSize)
 		{
+			resultSize = 0;
 			if (instancePtr != 0
 				&& _exportsInstanceMethods.ContainsKey(classId)
 				&& _exportsInstanceMethods[classId].ContainsKey(methodName))
@@ -610,6 +624,7 @@ namespace cn.vimfung.luascriptcore
 					IntPtr retPtr;
 					retPtr = Marshal.AllocHGlobal (bytes.Length);
 					Marshal.Copy (bytes, 0, retPtr, bytes.Length);
+					resultSize = bytes.Length;
 
 					return retPtr;
 				}
@@ -625,9 +640,11 @@ namespace cn.vimfung.luascriptcore
 		/// <param name="methodName">方法名称.</param>
 		/// <param name="arguments">参数列表缓冲区.</param>
 		/// <param name="size">参数列表缓冲区大小.</param>
+		/// <param name="resultSize">返回值缓冲区大小.</param>
 		[MonoPInvokeCallback (typeof (LuaModuleMethodHandleDelegate))]
-		private static IntPtr _classMethodHandler (int contextId, int classId, string methodName, IntPtr arguments, int size)
+		private static IntPtr _classMethodHandler (int contextId, int classId, string methodName, IntPtr arguments, int size, out int resultSize)
 		{
+			resultSize = 0;
 			if (_exportsClassMethods.ContainsKey (classId) && _exportsClassMethods[classId].ContainsKey(methodName)) 
 			{
 				LuaContext context = LuaContext.getContext (contextId);
@@ -645,6 +662,7 @@ namespace cn.vimfung.luascriptcore
 				IntPtr retPtr;
 				retPtr = Marshal.AllocHGlobal (bytes.Length);
 				Marshal.Copy (bytes, 0, retPtr, bytes.Length);
+				resultSize = bytes.Length;
 
 				return retPtr;
 			}
@@ -42,13 +42,16 @@ namespace cn.vimfung.luascriptcore
 		public LuaValue invoke(List<LuaValue> arguments)
 		{
 			IntPtr funcPtr = IntPtr.Zero;
+			int funcSize = 0;
 			IntPtr argsPtr = IntPtr.Zero;
+			int argsSize = 0;
 			IntPtr resultPtr = IntPtr.Zero;
 
 			LuaObjectEncoder funcEncoder = new LuaObjectEncoder (_context);
 			funcEncoder.writeObject (this);
 
 			byte[] bytes = funcEncoder.bytes;
+			funcSize = bytes.Length;
 			funcPtr = Marshal.AllocHGlobal (bytes.Length);
 			Marshal.Copy (bytes, 0, funcPtr, bytes.Length);
 
@@ -62,11 +65,12 @@ namespace cn.vimfung.luascriptcore
 				}
 
 				bytes = argEncoder.bytes;
+				argsSize = bytes.Length;
 				argsPtr = Marshal.AllocHGlobal (bytes.Length);
 				Marshal.Copy (bytes, 0, argsPtr, bytes.Length);
 			}
 
-			int size = NativeUtils.invokeLuaFunction (_context.objectId, funcPtr, argsPtr, out resultPtr);
+			int size = NativeUtils.invokeLuaFunction (_context.objectId, funcPtr, funcSize, argsPtr, argsSize, out resultPtr);
 
 			if (argsPtr != IntPtr.Zero)
 			{
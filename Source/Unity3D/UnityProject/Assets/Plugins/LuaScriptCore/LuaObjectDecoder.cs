@@ -4,15 +4,29 @@ using System.Runtime.InteropServices;
 using System.Text;
 using UnityEngine;
 using System.Reflection;
+using System.Collections.Generic;
 
 namespace cn.vimfung.luascriptcore
 {
+	/// <summary>
+	/// 对象解码器，可读取v1及v2格式的数据
+	/// </summary>
 	public class LuaObjectDecoder 
 	{
 		private byte[] _buffer;
 		private int _offset;
 		private LuaContext _context;
 
+		/// <summary>
+		/// 数据格式版本
+		/// </summary>
+		private int _version = 1;
+
+		/// <summary>
+		/// 类型字典，v2格式中按出现顺序记录类型名称对应的构造方法，找不到类型时为null
+		/// </summary>
+		private List<ConstructorInfo> _classConstructors;
+
 		/// <summary>
 		/// 初始化对象解码器
 		/// </summary>
@@ -27,6 +41,12 @@ namespace cn.vimfung.luascriptcore
 				_buffer = new byte[size];
 				Marshal.Copy (objectPtr, _buffer, 0, size);
 				Marshal.FreeHGlobal (objectPtr);
+
+				if (size >= 2 && _buffer [0] == LuaObjectEncoder.EncodingMagic)
+				{
+					_version = _buffer [1];
+					_offset = 2;
+				}
 			}
 		}
 
@@ -42,12 +62,43 @@ namespace cn.vimfung.luascriptcore
 			}
 		}
 
+		/// <summary>
+		/// 读取一个无符号变长整数（LEB128）
+		/// </summary>
+		/// <returns>整数值</returns>
+		private UInt64 readVarUInt()
+		{
+			UInt64 value = 0;
+			int shift = 0;
+
+			byte b;
+			do
+			{
+				b = _buffer [_offset];
+				_offset++;
+
+				if (shift < 64)
+				{
+					value |= (UInt64)(b & 0x7f) << shift;
+				}
+				shift += 7;
+			}
+			while ((b & 0x80) != 0);
+
+			return value;
+		}
+
 		/// <summary>
 		/// 读取一个16位的整型值
 		/// </summary>
 		/// <returns>整型值</returns>
 		public Int16 readInt16()
 		{
+			if (_version >= LuaObjectEncoder.EncodingVersion2)
+			{
+				return (Int16)readInt64 ();
+			}
+
 			Int16 value = Convert.ToInt16((_buffer [_offset] << 8) 
 				| _buffer [_offset + 1]);
 			_offset += 2;
@@ -61,6 +112,11 @@ namespace cn.vimfung.luascriptcore
 		/// <returns>整型值</returns>
 		public Int32 readInt32()
 		{
+			if (_version >= LuaObjectEncoder.EncodingVersion2)
+			{
+				return (Int32)readInt64 ();
+			}
+
 			Int32 value = (Convert.ToInt32(_buffer [_offset]) << 24) 
 				| (Convert.ToInt32(_buffer [_offset + 1]) << 16) 
 				| (Convert.ToInt32(_buffer [_offset + 2]) << 8) 
@@ -76,6 +132,13 @@ namespace cn.vimfung.luascriptcore
 		/// <returns>整型值</returns>
 		public Int64 readInt64()
 		{
+			if (_version >= LuaObjectEncoder.EncodingVersion2)
+			{
+				//zigzag解码
+				UInt64 zigzag = readVarUInt ();
+				return (Int64)(zigzag >> 1) ^ -(Int64)(zigzag & 1);
+			}
+
 			Int64 value = (Convert.ToInt64(_buffer [_offset]) << 56) 
 				| (Convert.ToInt64(_buffer [_offset + 1]) << 48) 
 				| (Convert.ToInt64(_buffer [_offset + 2]) << 40) 
@@ -154,6 +217,11 @@ namespace cn.vimfung.luascriptcore
 		/// <returns>对象</returns>
 		public object readObject()
 		{
+			if (_version >= LuaObjectEncoder.EncodingVersion2)
+			{
+				return readObjectV2 ();
+			}
+
 			if (_buffer [_offset] == 'L')
 			{
 				_offset++;
@@ -181,6 +249,64 @@ namespace cn.vimfung.luascriptcore
 			return null;
 		}
 
+		/// <summary>
+		/// 读取v2格式的对象
+		/// </summary>
+		/// <returns>对象</returns>
+		private object readObjectV2()
+		{
+			byte tag = readByte ();
+
+			ConstructorInfo ci = null;
+			if ((tag & LuaObjectEncoder.ObjectTagClassInlineIndex) != 0)
+			{
+				int index = tag & ~LuaObjectEncoder.ObjectTagClassInlineIndex;
+				if (_classConstructors != null && index < _classConstructors.Count)
+				{
+					ci = _classConstructors [index];
+				}
+			}
+			else if (tag == LuaObjectEncoder.ObjectTagClassName)
+			{
+				//每种类型只在首次出现时反射一次
+				string className = readString ();
+				Type t = className != null ? Type.GetType (className) : null;
+				if (t != null)
+				{
+					ci = t.GetConstructor (new Type[] { typeof(LuaObjectDecoder) });
+				}
+
+				if (_classConstructors == null)
+				{
+					_classConstructors = new List<ConstructorInfo> ();
+				}
+				_classConstructors.Add (ci);
+			}
+			else if (tag == LuaObjectEncoder.ObjectTagClassIndex)
+			{
+				UInt64 index = readVarUInt ();
+				if (_classConstructors != null && index < (UInt64)_classConstructors.Count)
+				{
+					ci = _classConstructors [(int)index];
+				}
+			}
+			else if (tag == LuaObjectEncoder.ObjectTagReference)
+			{
+				Int64 refId = readInt64 ();
+				return LuaObjectReference.findObject (refId);
+			}
+
+			if (ci != null)
+			{
+				object[] parameters = new object[1];
+				parameters [0] = this;
+
+				return ci.Invoke (parameters);
+			}
+
+			return null;
+		}
+
 		/// <summary>
 		/// 解码对象
 		/// </summary>
@@ -6,11 +6,54 @@ using System.Runtime.InteropServices;
 
 namespace cn.vimfung.luascriptcore
 {
+	/// <summary>
+	/// 对象编码器，以v2格式写入数据，与原生层LuaObjectSerializationTypes.h中的格式说明一致
+	/// </summary>
 	public class LuaObjectEncoder 
 	{
+		/// <summary>
+		/// v2格式的头部标识
+		/// </summary>
+		internal const byte EncodingMagic = 0xFF;
+
+		/// <summary>
+		/// v2格式版本号
+		/// </summary>
+		internal const byte EncodingVersion2 = 2;
+
+		/// <summary>
+		/// v2对象标记：新类型名称，后跟类型名称字符串
+		/// </summary>
+		internal const byte ObjectTagClassName = 0x01;
+
+		/// <summary>
+		/// v2对象标记：类型名称索引，后跟变长整数索引
+		/// </summary>
+		internal const byte ObjectTagClassIndex = 0x02;
+
+		/// <summary>
+		/// v2对象标记：非导出对象引用，后跟64位整数引用标识
+		/// </summary>
+		internal const byte ObjectTagReference = 0x03;
+
+		/// <summary>
+		/// v2对象标记：内联类型名称索引，标记的低7位为索引
+		/// </summary>
+		internal const byte ObjectTagClassInlineIndex = 0x80;
+
+		/// <summary>
+		/// 可内联在标记中的类型名称索引数量
+		/// </summary>
+		internal const int ObjectTagClassInlineIndexCount = 0x80;
+
 		private List<byte> _buffer;
 		private LuaContext _context;
 
+		/// <summary>
+		/// 类型名称字典，记录已写入的类型名称及其索引
+		/// </summary>
+		private Dictionary<string, int> _classIndexes;
+
 		/// <summary>
 		/// 初始化
 		/// </summary>
@@ -19,6 +62,10 @@ namespace cn.vimfung.luascriptcore
 		{
 			_buffer = new List<byte> ();
 			_context = context;
+			_classIndexes = new Dictionary<string, int> ();
+
+			_buffer.Add (EncodingMagic);
+			_buffer.Add (EncodingVersion2);
 		}
 
 		/// <summary>
@@ -34,45 +81,49 @@ namespace cn.vimfung.luascriptcore
 		}
 
 		/// <summary>
-		/// 写入一个16位整型
+		/// 写入一个无符号变长整数（LEB128）
 		/// </summary>
-		/// <param name="value">16位整型值</param>
-		public void writeInt16(Int16 value)
+		/// <param name="value">整数值</param>
+		private void writeVarUInt(UInt64 value)
 		{
-			byte[] bytes = BitConverter.GetBytes (value);
-			if (BitConverter.IsLittleEndian)
+			do
 			{
-				Array.Reverse (bytes);
+				byte b = (byte)(value & 0x7f);
+				value >>= 7;
+				if (value != 0)
+				{
+					b |= 0x80;
+				}
+				_buffer.Add (b);
 			}
-			_buffer.AddRange (bytes);
+			while (value != 0);
 		}
 
 		/// <summary>
-		/// 写入一个32位整型
+		/// 写入一个16位整型，以zigzag变长整数写入
+		/// </summary>
+		/// <param name="value">16位整型值</param>
+		public void writeInt16(Int16 value)
+		{
+			writeInt64 (value);
+		}
+
+		/// <summary>
+		/// 写入一个32位整型，以zigzag变长整数写入
 		/// </summary>
 		/// <param name="value">32位整型值</param>
 		public void writeInt32(Int32 value)
 		{
-			byte[] bytes = BitConverter.GetBytes ((int)value);
-			if (BitConverter.IsLittleEndian)
-			{
-				Array.Reverse (bytes);
-			}
-			_buffer.AddRange (bytes);
+			writeInt64 (value);
 		}
 
 		/// <summary>
-		/// 写入一个64位的整型值
+		/// 写入一个64位的整型值，以zigzag变长整数写入
 		/// </summary>
 		/// <param name="value">64位整型值</param>
 		public void writeInt64(Int64 value)
 		{
-			byte[] bytes = BitConverter.GetBytes (value);
-			if (BitConverter.IsLittleEndian)
-			{
-				Array.Reverse (bytes);
-			}
-			_buffer.AddRange (bytes);
+			writeVarUInt ((UInt64)((value << 1) ^ (value >> 63)));
 		}
 
 		/// <summary>
@@ -137,15 +188,33 @@ namespace cn.vimfung.luascriptcore
 			{
 				if (value is LuaBaseObject)
 				{
-					this.writeByte ((byte)'L');
-					this.writeString (value.GetType ().Name);
-					this.writeByte ((byte)';');
+					string className = value.GetType ().Name;
+
+					int index;
+					if (!_classIndexes.TryGetValue (className, out index))
+					{
+						//首次出现的类型写入名称，之后以索引引用
+						_classIndexes.Add (className, _classIndexes.Count);
+
+						this.writeByte (ObjectTagClassName);
+						this.writeString (className);
+					}
+					else if (index < ObjectTagClassInlineIndexCount)
+					{
+						this.writeByte ((byte)(ObjectTagClassInlineIndex | index));
+					}
+					else
+					{
+						this.writeByte (ObjectTagClassIndex);
+						this.writeVarUInt ((UInt64)index);
+					}
 
 					(value as LuaBaseObject).serialization (this);
 				}
 				else
 				{
 					LuaObjectReference objRef = new LuaObjectReference (value);
+					this.writeByte (ObjectTagReference);
 					writeInt64 (objRef.referenceId);
 				}
 			}
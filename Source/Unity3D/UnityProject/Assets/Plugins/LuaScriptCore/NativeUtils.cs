@@ -7,7 +7,7 @@ using AOT;
 namespace cn.vimfung.luascriptcore
 {
 	[UnmanagedFunctionPointer(CallingConvention.Cdecl)]
-	public delegate IntPtr LuaMethodHandleDelegate(int nativeContextId, string methodName, IntPtr arguments, int size);
+	public delegate IntPtr LuaMethodHandleDelegate(int nativeContextId, string methodName, IntPtr arguments, int size, out int resultSize);
 
 	[UnmanagedFunctionPointer(CallingConvention.Cdecl)]
 	public delegate void LuaSetNativeObjectIdHandleDelegate(Int64 obj, int nativeObjectId, string luaObjectId);
@@ -28,13 +28,13 @@ namespace cn.vimfung.luascriptcore
 	public delegate string LuaInstanceDescriptionHandleDelegate(Int64 instancePtr);
 
 	[UnmanagedFunctionPointer(CallingConvention.Cdecl)]
-	public delegate IntPtr LuaModuleMethodHandleDelegate (int contextId, int nativeModuleId, string methodName, IntPtr arguments, int size);
+	public delegate IntPtr LuaModuleMethodHandleDelegate (int contextId, int nativeModuleId, string methodName, IntPtr arguments, int size, out int resultSize);
 
 	[UnmanagedFunctionPointer(CallingConvention.Cdecl)]
-	public delegate IntPtr LuaInstanceMethodHandleDelegate (int contextId, int classId, Int64 instance, string methodName, IntPtr argumentsBuffer, int bufferSize);
+	public delegate IntPtr LuaInstanceMethodHandleDelegate (int contextId, int classId, Int64 instance, string methodName, IntPtr argumentsBuffer, int bufferSize, out int resultSize);
 
 	[UnmanagedFunctionPointer(CallingConvention.Cdecl)]
-	public delegate IntPtr LuaInstanceFieldGetterHandleDelegate (int contextId, int classId, Int64 instance, string fieldName);
+	public delegate IntPtr LuaInstanceFieldGetterHandleDelegate (int contextId, int classId, Int64 instance, string fieldName, out int resultSize);
 
 	[UnmanagedFunctionPointer(CallingConvention.Cdecl)]
 	public delegate void LuaInstanceFieldSetterHandleDelegate (int contextId,int classId, Int64 instance, string fieldName, IntPtr valueBuffer, int bufferSize);
@@ -141,8 +141,9 @@ namespace cn.vimfung.luascriptcore
 		/// <param name="contextId">Lua上下文对象的本地标识.</param>
 		/// <param name="name">变量名称.</param>
 		/// <param name="value">变量值.</param>
+		/// <param name="valueSize">值缓存长度.</param>
 		[DllImport("LuaScriptCore-Unity-OSX")]
-		internal extern static void setGlobal (int contextId, string name, IntPtr value);
+		internal extern static void setGlobal (int contextId, string name, IntPtr value, int valueSize);
 
 		/// <summary>
 		/// 获取全局变量
@@ -181,9 +182,10 @@ namespace cn.vimfung.luascriptcore
 		/// <param name="nativeContextId">Lua上下文对象的本地标识</param>
 		/// <param name="methodName">方法名称</param>
 		/// <param name="arguments">参数列表</param>
+		/// <param name="argumentsSize">参数列表缓存长度.</param>
 		/// <param name="resultBuffer">返回值缓冲区.</param>
 		[DllImport("LuaScriptCore-Unity-OSX")]
-		internal extern static int callMethod(int nativeContextId, string methodName, IntPtr arguments, out IntPtr resultBuffer);
+		internal extern static int callMethod(int nativeContextId, string methodName, IntPtr arguments, int argumentsSize, out IntPtr resultBuffer);
 
 		/// <summary>
 		/// 注册lua方法
@@ -200,10 +202,12 @@ namespace cn.vimfung.luascriptcore
 		/// <returns>返回值的缓冲区大小</returns>
 		/// <param name="nativeContextId">Lua上下文对象的本地标识.</param>
 		/// <param name="function">方法.</param>
+		/// <param name="functionSize">方法缓存长度.</param>
 		/// <param name="arguments">参数列表.</param>
+		/// <param name="argumentsSize">参数列表缓存长度.</param>
 		/// <param name="resultBuffer">返回值缓冲区.</param>
 		[DllImport("LuaScriptCore-Unity-OSX")]
-		internal extern static int invokeLuaFunction (int nativeContextId, IntPtr function, IntPtr arguments, out IntPtr resultBuffer);  
+		internal extern static int invokeLuaFunction (int nativeContextId, IntPtr function, int functionSize, IntPtr arguments, int argumentsSize, out IntPtr resultBuffer);  
 
 		/// <summary>
 		/// 释放本地对象
@@ -221,8 +225,11 @@ namespace cn.vimfung.luascriptcore
 		/// <param name="typeName">类型名称.</param>
 		/// <param name="parentTypeName">父类名称.</param>
 		/// <param name="exportsPropertyNames">导出属性名称列表</param>
+		/// <param name="exportsPropertyNamesSize">导出属性名称列表缓存长度.</param>
 		/// <param name="exportsInstanceMethodNames">导出实例方法名称列表.</param>
+		/// <param name="exportsInstanceMethodNamesSize">导出实例方法名称列表缓存长度.</param>
 		/// <param name="xportsClassMethodNames">导出类方法名称列表.</param>
+		/// <param name="exportsClassMethodNamesSize">导出类方法名称列表缓存长度.</param>
 		/// <param name="instanceCreateHandler">创建实例处理器.</param>
 		/// <param name="instanceDestroyHandler">销毁实例处理器.</param>
 		/// <param name="instanceDescriptionHandler">实例描述处理器.</param>
@@ -237,8 +244,11 @@ namespace cn.vimfung.luascriptcore
 			string typeName,
 			string parentTypeName,
 			IntPtr exportsPropertyNames,
+			int exportsPropertyNamesSize,
 			IntPtr exportsInstanceMethodNames,
+			int exportsInstanceMethodNamesSize,
 			IntPtr exportsClassMethodNames,
+			int exportsClassMethodNamesSize,
 			IntPtr instanceCreateHandler,
 			IntPtr instanceDestroyHandler,
 			IntPtr instanceDescriptionHandler,
@@ -252,16 +262,18 @@ namespace cn.vimfung.luascriptcore
 		/// </summary>
 		/// <param name="nativeContextId">原生上下文对象标识.</param>
 		/// <param name="value">值对象.</param>
+		/// <param name="valueSize">值缓存长度.</param>
 		[DllImport("LuaScriptCore-Unity-OSX")]
-		internal extern static void retainValue (int nativeContextId, IntPtr value);
+		internal extern static void retainValue (int nativeContextId, IntPtr value, int valueSize);
 
 		/// <summary>
 		/// 释放LuaValue的对象
 		/// </summary>
 		/// <param name="nativeContextId">原生上下文对象标识.</param>
 		/// <param name="value">值对象.</param>
+		/// <param name="valueSize">值缓存长度.</param>
 		[DllImport("LuaScriptCore-Unity-OSX")]
-		internal extern static void releaseValue (int nativeContextId, IntPtr value);
+		internal extern static void releaseValue (int nativeContextId, IntPtr value, int valueSize);
 
 		/// <summary>
 		/// 设置Unity调试日志接口，用于Lua中输出日志到Unity的编辑器控制台, Editor特有。
@@ -332,8 +344,9 @@ namespace cn.vimfung.luascriptcore
 		/// <param name="contextId">Lua上下文对象的本地标识.</param>
 		/// <param name="name">变量名称.</param>
 		/// <param name="value">变量值.</param>
+		/// <param name="valueSize">值缓存长度.</param>
 		[DllImport("LuaScriptCore-Unity-Win64")]
-        internal extern static void setGlobal(int contextId, string name, IntPtr value);
+        internal extern static void setGlobal(int contextId, string name, IntPtr value, int valueSize);
 
         /// <summary>
         /// 获取全局变量
@@ -372,9 +385,10 @@ namespace cn.vimfung.luascriptcore
 		/// <param name="nativeContextId">Lua上下文对象的本地标识</param>
 		/// <param name="methodName">方法名称</param>
 		/// <param name="arguments">参数列表</param>
+		/// <param name="argumentsSize">参数列表缓存长度.</param>
 		/// <param name="resultBuffer">返回值缓冲区.</param>
 		[DllImport("LuaScriptCore-Unity-Win64")]
-		internal extern static int callMethod(int nativeContextId, string methodName, IntPtr arguments, out IntPtr resultBuffer);
+		internal extern static int callMethod(int nativeContextId, string methodName, IntPtr arguments, int argumentsSize, out IntPtr resultBuffer);
 
 		/// <summary>
 		/// 注册lua方法
@@ -391,10 +405,12 @@ namespace cn.vimfung.luascriptcore
 		/// <returns>返回值的缓冲区大小</returns>
 		/// <param name="nativeContextId">Lua上下文对象的本地标识.</param>
 		/// <param name="function">方法.</param>
+		/// <param name="functionSize">方法缓存长度.</param>
 		/// <param name="arguments">参数列表.</param>
+		/// <param name="argumentsSize">参数列表缓存长度.</param>
 		/// <param name="resultBuffer">返回值缓冲区.</param>
 		[DllImport("LuaScriptCore-Unity-Win64")]
-        internal extern static int invokeLuaFunction(int nativeContextId, IntPtr function, IntPtr arguments, out IntPtr resultBuffer);
+        internal extern static int invokeLuaFunction(int nativeContextId, IntPtr function, int functionSize, IntPtr arguments, int argumentsSize, out IntPtr resultBuffer);
 
         /// <summary>
         /// 释放本地对象
@@ -412,8 +428,11 @@ namespace cn.vimfung.luascriptcore
 		/// <param name="typeName">类型名称.</param>
 		/// <param name="parentTypeName">父类名称.</param>
 		/// <param name="exportsPropertyNames">导出属性名称列表</param>
+		/// <param name="exportsPropertyNamesSize">导出属性名称列表缓存长度.</param>
 		/// <param name="exportsInstanceMethodNames">导出实例方法名称列表.</param>
+		/// <param name="exportsInstanceMethodNamesSize">导出实例方法名称列表缓存长度.</param>
 		/// <param name="xportsClassMethodNames">导出类方法名称列表.</param>
+		/// <param name="exportsClassMethodNamesSize">导出类方法名称列表缓存长度.</param>
 		/// <param name="instanceCreateHandler">创建实例处理器.</param>
 		/// <param name="instanceDestroyHandler">销毁实例处理器.</param>
 		/// <param name="instanceDescriptionHandler">实例描述处理器.</param>
@@ -428,8 +447,11 @@ namespace cn.vimfung.luascriptcore
 			string typeName,
 			string parentTypeName,
 			IntPtr exportsPropertyNames,
+			int exportsPropertyNamesSize,
 			IntPtr exportsInstanceMethodNames,
+			int exportsInstanceMethodNamesSize,
 			IntPtr exportsClassMethodNames,
+			int exportsClassMethodNamesSize,
 			IntPtr instanceCreateHandler,
 			IntPtr instanceDestroyHandler,
 			IntPtr instanceDescriptionHandler,
@@ -443,16 +465,18 @@ namespace cn.vimfung.luascriptcore
         /// </summary>
         /// <param name="nativeContextId">原生上下文对象标识.</param>
         /// <param name="value">值对象.</param>
+        /// <param name="valueSize">值缓存长度.</param>
         [DllImport("LuaScriptCore-Unity-Win64")]
-        internal extern static void retainValue(int nativeContextId, IntPtr value);
+        internal extern static void retainValue(int nativeContextId, IntPtr value, int valueSize);
 
         /// <summary>
         /// 释放LuaValue的对象
         /// </summary>
         /// <param name="nativeContextId">原生上下文对象标识.</param>
         /// <param name="value">值对象.</param>
+        /// <param name="valueSize">值缓存长度.</param>
         [DllImport("LuaScriptCore-Unity-Win64")]
-        internal extern static void releaseValue(int nativeContextId, IntPtr value);
+        internal extern static void releaseValue(int nativeContextId, IntPtr value, int valueSize);
 
         /// <summary>
         /// 设置Unity调试日志接口，用于Lua中输出日志到Unity的编辑器控制台, Editor特有。
@@ -490,8 +514,9 @@ namespace cn.vimfung.luascriptcore
 		/// <param name="contextId">Lua上下文对象的本地标识.</param>
 		/// <param name="name">变量名称.</param>
 		/// <param name="value">变量值.</param>
+		/// <param name="valueSize">值缓存长度.</param>
 		[DllImport("__Internal")]
-		internal extern static void setGlobal (int contextId, string name, IntPtr value);
+		internal extern static void setGlobal (int contextId, string name, IntPtr value, int valueSize);
 
 		/// <summary>
 		/// 获取全局变量
@@ -562,9 +587,10 @@ namespace cn.vimfung.luascriptcore
 		/// <param name="nativeContextId">Lua上下文对象的本地标识</param>
 		/// <param name="methodName">方法名称</param>
 		/// <param name="arguments">参数列表</param>
+		/// <param name="argumentsSize">参数列表缓存长度.</param>
 		/// <param name="resultBuffer">返回值缓冲区.</param>
 		[DllImport("__Internal")]
-		internal extern static int callMethod(int nativeContextId, string methodName, IntPtr arguments, out IntPtr resultBuffer);
+		internal extern static int callMethod(int nativeContextId, string methodName, IntPtr arguments, int argumentsSize, out IntPtr resultBuffer);
 
 		/// <summary>
 		/// 注册lua方法
@@ -581,10 +607,12 @@ namespace cn.vimfung.luascriptcore
 		/// <returns>返回值的缓冲区大小</returns>
 		/// <param name="nativeContextId">Lua上下文对象的本地标识.</param>
 		/// <param name="function">方法.</param>
+		/// <param name="functionSize">方法缓存长度.</param>
 		/// <param name="arguments">参数列表.</param>
+		/// <param name="argumentsSize">参数列表缓存长度.</param>
 		/// <param name="resultBuffer">返回值缓冲区.</param>
 		[DllImport("__Internal")]
-		internal extern static int invokeLuaFunction (int nativeContextId, IntPtr function, IntPtr arguments, out IntPtr resultBuffer);
+		internal extern static int invokeLuaFunction (int nativeContextId, IntPtr function, int functionSize, IntPtr arguments, int argumentsSize, out IntPtr resultBuffer);
 
 		/// <summary>
 		/// 释放本地对象
@@ -602,8 +630,11 @@ namespace cn.vimfung.luascriptcore
 		/// <param name="typeName">类型名称.</param>
 		/// <param name="parentTypeName">父类名称.</param>
 		/// <param name="exportsPropertyNames">导出属性名称列表</param>
+		/// <param name="exportsPropertyNamesSize">导出属性名称列表缓存长度.</param>
 		/// <param name="exportsInstanceMethodNames">导出实例方法名称列表.</param>
+		/// <param name="exportsInstanceMethodNamesSize">导出实例方法名称列表缓存长度.</param>
 		/// <param name="xportsClassMethodNames">导出类方法名称列表.</param>
+		/// <param name="exportsClassMethodNamesSize">导出类方法名称列表缓存长度.</param>
 		/// <param name="instanceCreateHandler">创建实例处理器.</param>
 		/// <param name="instanceDestroyHandler">销毁实例处理器.</param>
 		/// <param name="instanceDescriptionHandler">实例描述处理器.</param>
@@ -618,8 +649,11 @@ namespace cn.vimfung.luascriptcore
 			string typeName,
 			string parentTypeName,
 			IntPtr exportsPropertyNames,
+			int exportsPropertyNamesSize,
 			IntPtr exportsInstanceMethodNames,
+			int exportsInstanceMethodNamesSize,
 			IntPtr exportsClassMethodNames,
+			int exportsClassMethodNamesSize,
 			IntPtr instanceCreateHandler,
 			IntPtr instanceDestroyHandler,
 			IntPtr instanceDescriptionHandler,
@@ -633,16 +667,18 @@ namespace cn.vimfung.luascriptcore
 		/// </summary>
 		/// <param name="nativeContextId">原生上下文对象标识.</param>
 		/// <param name="value">值对象.</param>
+		/// <param name="valueSize">值缓存长度.</param>
 		[DllImport("__Internal")]
-		internal extern static void retainValue (int nativeContextId, IntPtr value);
+		internal extern static void retainValue (int nativeContextId, IntPtr value, int valueSize);
 
 		/// <summary>
 		/// 释放LuaValue的对象
 		/// </summary>
 		/// <param name="nativeContextId">原生上下文对象标识.</param>
 		/// <param name="value">值对象.</param>
+		/// <param name="valueSize">值缓存长度.</param>
 		[DllImport("__Internal")]
-		internal extern static void releaseValue (int nativeContextId, IntPtr value);
+		internal extern static void releaseValue (int nativeContextId, IntPtr value, int valueSize);
 
 #elif UNITY_ANDROID
 
@@ -673,8 +709,9 @@ namespace cn.vimfung.luascriptcore
 		/// <param name="contextId">Lua上下文对象的本地标识.</param>
 		/// <param name="name">变量名称.</param>
 		/// <param name="value">变量值.</param>
+		/// <param name="valueSize">值缓存长度.</param>
 		[DllImport("LuaScriptCore-Unity-Android")]
-		internal extern static void setGlobal (int contextId, string name, IntPtr value);
+		internal extern static void setGlobal (int contextId, string name, IntPtr value, int valueSize);
 
 		/// <summary>
 		/// 获取全局变量
@@ -745,9 +782,10 @@ namespace cn.vimfung.luascriptcore
 		/// <param name="nativeContextId">Lua上下文对象的本地标识</param>
 		/// <param name="methodName">方法名称</param>
 		/// <param name="arguments">参数列表</param>
+		/// <param name="argumentsSize">参数列表缓存长度.</param>
 		/// <param name="resultBuffer">返回值缓冲区.</param>
 		[DllImport("LuaScriptCore-Unity-Android")]
-		internal extern static int callMethod(int nativeContextId, string methodName, IntPtr arguments, out IntPtr resultBuffer);
+		internal extern static int callMethod(int nativeContextId, string methodName, IntPtr arguments, int argumentsSize, out IntPtr resultBuffer);
 
 		/// <summary>
 		/// 注册lua方法
@@ -764,10 +802,12 @@ namespace cn.vimfung.luascriptcore
 		/// <returns>返回值的缓冲区大小</returns>
 		/// <param name="nativeContextId">Lua上下文对象的本地标识.</param>
 		/// <param name="function">方法.</param>
+		/// <param name="functionSize">方法缓存长度.</param>
 		/// <param name="arguments">参数列表.</param>
+		/// <param name="argumentsSize">参数列表缓存长度.</param>
 		/// <param name="resultBuffer">返回值缓冲区.</param>
 		[DllImport("LuaScriptCore-Unity-Android")]
-		internal extern static int invokeLuaFunction (int nativeContextId, IntPtr function, IntPtr arguments, out IntPtr resultBuffer);
+		internal extern static int invokeLuaFunction (int nativeContextId, IntPtr function, int functionSize, IntPtr arguments, int argumentsSize, out IntPtr resultBuffer);
 
 		/// <summary>
 		/// 释放本地对象
@@ -785,8 +825,11 @@ namespace cn.vimfung.luascriptcore
 		/// <param name="typeName">类型名称.</param>
 		/// <param name="parentTypeName">父类名称.</param>
 		/// <param name="exportsPropertyNames">导出属性名称列表</param>
+		/// <param name="exportsPropertyNamesSize">导出属性名称列表缓存长度.</param>
 		/// <param name="exportsInstanceMethodNames">导出实例方法名称列表.</param>
+		/// <param name="exportsInstanceMethodNamesSize">导出实例方法名称列表缓存长度.</param>
 		/// <param name="xportsClassMethodNames">导出类方法名称列表.</param>
+		/// <param name="exportsClassMethodNamesSize">导出类方法名称列表缓存长度.</param>
 		/// <param name="instanceCreateHandler">创建实例处理器.</param>
 		/// <param name="instanceDestroyHandler">销毁实例处理器.</param>
 		/// <param name="instanceDescriptionHandler">实例描述处理器.</param>
@@ -801,8 +844,11 @@ namespace cn.vimfung.luascriptcore
 			string typeName,
 			string parentTypeName,
 			IntPtr exportsPropertyNames,
+			int exportsPropertyNamesSize,
 			IntPtr exportsInstanceMethodNames,
+			int exportsInstanceMethodNamesSize,
 			IntPtr exportsClassMethodNames,
+			int exportsClassMethodNamesSize,
 			IntPtr instanceCreateHandler,
 			IntPtr instanceDestroyHandler,
 			IntPtr instanceDescriptionHandler,
@@ -816,16 +862,18 @@ namespace cn.vimfung.luascriptcore
 		/// </summary>
 		/// <param name="nativeContextId">原生上下文对象标识.</param>
 		/// <param name="value">值对象.</param>
+		/// <param name="valueSize">值缓存长度.</param>
 		[DllImport("LuaScriptCore-Unity-Android")]
-		internal extern static void retainValue (int nativeContextId, IntPtr value);
+		internal extern static void retainValue (int nativeContextId, IntPtr value, int valueSize);
 
 		/// <summary>
 		/// 释放LuaValue的对象
 		/// </summary>
 		/// <param name="nativeContextId">原生上下文对象标识.</param>
 		/// <param name="value">值对象.</param>
+		/// <param name="valueSize">值缓存长度.</param>
 		[DllImport("LuaScriptCore-Unity-Android")]
-		internal extern static void releaseValue (int nativeContextId, IntPtr value);
+		internal extern static void releaseValue (int nativeContextId, IntPtr value, int valueSize);
 #endif
 	}
 }
\ No newline at end of file
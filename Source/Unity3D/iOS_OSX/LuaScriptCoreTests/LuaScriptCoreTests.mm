@@ -49,6 +49,68 @@ void* testModuleMethodHandler (int moduleId, const char *name, const void *args,
     return NULL;
 }
 
+/**
+ 使用原生类名进行编码，使编码后的数据可以由原生层解码。setUp中创建上下文时会恢复Unity的映射类名
+ */
+static void useNativeClassNames()
+{
+    LuaObjectEncoder::setMappingClassType(typeid(LuaValue).name(), "LuaValue");
+    LuaObjectEncoder::setMappingClassType(typeid(LuaTuple).name(), "LuaTuple");
+}
+
+/**
+ 使用带长度的解码器解码值对象
+
+ @param context 上下文对象
+ @param bytes 数据
+ @param length 数据长度
+ @param truncated 返回数据是否被截断
+ @return 值对象，解码失败时返回NULL
+ */
+static LuaValue* decodeValue(LuaContext *context, const void *bytes, int length, bool *truncated)
+{
+    LuaObjectDecoder *decoder = new LuaObjectDecoder(context, bytes, length);
+    LuaValue *value = dynamic_cast<LuaValue *>(decoder -> readObject());
+    *truncated = decoder -> isTruncated();
+    decoder -> release();
+
+    return value;
+}
+
+/**
+ 检测数据的每个截断前缀均无法解码，前缀复制到等长的内存块中以便检测越界读取
+
+ @param context 上下文对象
+ @param bytes 数据
+ @param length 数据长度
+ @return 全部前缀均被判定为截断时返回true
+ */
+static bool allPrefixesTruncated(LuaContext *context, const void *bytes, int length)
+{
+    for (int n = 0; n < length; n++)
+    {
+        void *prefix = malloc(n > 0 ? n : 1);
+        memcpy(prefix, bytes, n);
+
+        bool truncated = false;
+        LuaValue *value = decodeValue(context, prefix, n, &truncated);
+        free(prefix);
+
+        if (value != NULL)
+        {
+            value -> release();
+            return false;
+        }
+
+        if (!truncated)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 - (void)setUp
 {
     [super setUp];
@@ -149,7 +211,7 @@ void* testModuleMethodHandler (int moduleId, const char *name, const void *args,
     evalScriptFromFile(self.contextId, path.UTF8String, NULL);
     
     void *result = NULL;
-    int size = callMethod(self.contextId, "testTuple", NULL, (const void **)&result);
+    int size = callMethod(self.contextId, "testTuple", NULL, 0, (const void **)&result);
     char chr = *((char *)result+87);
     NSLog(@"size = %d, buf[88] = %d", size, chr);
     
@@ -200,6 +262,104 @@ void* testModuleMethodHandler (int moduleId, const char *name, const void *args,
     value -> release();
 }
 
+- (void)testObjectCodingV1
+{
+    LuaContext *context = (LuaContext *)LuaObject::findObject(self.contextId);
+    useNativeClassNames();
+
+    //v1格式：数组[7, "v1"]，整数按大端定长写入，类名以L开头、分号结尾
+    Byte bytes[] = {
+        'L',0,0,0,8,'L','u','a','V','a','l','u','e',';', 0,0,0,0, 0,4, 0,0,0,2,
+        'L',0,0,0,8,'L','u','a','V','a','l','u','e',';', 0,0,0,0, 0,8, 0,0,0,7,
+        'L',0,0,0,8,'L','u','a','V','a','l','u','e',';', 0,0,0,0, 0,3, 0,0,0,2, 'v','1'
+    };
+
+    bool truncated = false;
+    LuaValue *value = decodeValue(context, bytes, sizeof(bytes), &truncated);
+    XCTAssertFalse(truncated);
+    XCTAssert(value != NULL && value -> getType() == LuaValueTypeArray);
+    XCTAssert(value -> toArray() -> size() == 2);
+    XCTAssert(value -> toArray() -> at(0) -> toInteger() == 7);
+    XCTAssert(value -> toArray() -> at(1) -> toString() == "v1");
+
+    //重新编码为v2格式后再解码
+    const void *buf = NULL;
+    int length = LuaObjectEncoder::encodeObject(context, value, &buf);
+    value -> release();
+
+    XCTAssert(length > 2 && length < (int)sizeof(bytes));
+    XCTAssert(((const Byte *)buf)[0] == 0xFF);
+    XCTAssert(((const Byte *)buf)[1] == 2);
+
+    value = decodeValue(context, buf, length, &truncated);
+    XCTAssertFalse(truncated);
+    XCTAssert(value != NULL && value -> getType() == LuaValueTypeArray);
+    XCTAssert(value -> toArray() -> size() == 2);
+    XCTAssert(value -> toArray() -> at(0) -> toInteger() == 7);
+    XCTAssert(value -> toArray() -> at(1) -> toString() == "v1");
+    value -> release();
+
+    free((void *)buf);
+
+    XCTAssert(allPrefixesTruncated(context, bytes, sizeof(bytes)));
+}
+
+- (void)testObjectCodingV2
+{
+    LuaContext *context = (LuaContext *)LuaObject::findObject(self.contextId);
+    useNativeClassNames();
+
+    LuaValueList list;
+    list.push_back(LuaValue::IntegerValue(-5));
+    list.push_back(LuaValue::StringValue("hello"));
+    list.push_back(LuaValue::NumberValue(2.5));
+    list.push_back(LuaValue::BooleanValue(true));
+
+    LuaValueMap map;
+    map["list"] = LuaValue::ArrayValue(list);
+    map["name"] = LuaValue::StringValue("lsc");
+
+    LuaValue *value = LuaValue::DictonaryValue(map);
+    const void *buf = NULL;
+    int length = LuaObjectEncoder::encodeObject(context, value, &buf);
+    value -> release();
+
+    //源对象释放后再解码，确保对象从数据中重建
+    bool truncated = false;
+    value = decodeValue(context, buf, length, &truncated);
+    XCTAssertFalse(truncated);
+    XCTAssert(value != NULL && value -> getType() == LuaValueTypeMap);
+
+    LuaValueMap *result = value -> toMap();
+    XCTAssert((*result)["name"] -> toString() == "lsc");
+
+    LuaValueList *resultList = (*result)["list"] -> toArray();
+    XCTAssert(resultList -> size() == 4);
+    XCTAssert(resultList -> at(0) -> toInteger() == -5);
+    XCTAssert(resultList -> at(1) -> toString() == "hello");
+    XCTAssert(resultList -> at(2) -> toNumber() == 2.5);
+    XCTAssertTrue(resultList -> at(3) -> toBoolean());
+    value -> release();
+
+    XCTAssert(allPrefixesTruncated(context, buf, length));
+
+    free((void *)buf);
+}
+
+- (void)testObjectCodingUnknownVersion
+{
+    LuaContext *context = (LuaContext *)LuaObject::findObject(self.contextId);
+    useNativeClassNames();
+
+    Byte bytes[] = {0xFF, 3, 0x01, 8, 'L','u','a','V','a','l','u','e', 0, 0x10, 14};
+
+    LuaObjectDecoder *decoder = new LuaObjectDecoder(context, bytes, sizeof(bytes));
+    XCTAssertTrue(decoder -> isTruncated());
+    XCTAssert(decoder -> readObject() == NULL);
+    XCTAssert(decoder -> readInt32() == 0);
+    decoder -> release();
+}
+
 - (void)testStringFormat
 {
     XCTestExpectation *ex = [self expectationWithDescription:@"xxxx"];
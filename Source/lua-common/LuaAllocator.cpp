@@ -0,0 +1,221 @@
+#include "LuaAllocator.h"
+#include <stdlib.h>
+#include <string.h>
+
+using namespace cn::vimfung::luascriptcore;
+
+/**
+ * 内存大块头部大小，保证切分出的内存块按16字节对齐
+ */
+static const size_t ChunkHeaderSize = 16;
+
+LuaAllocator::LuaAllocator(LuaAllocatorPolicy policy)
+    : LuaObject(),
+      _policy(policy),
+      _chunks(NULL),
+      _chunkCursor(NULL),
+      _chunkEnd(NULL),
+      _liveBytes(0),
+      _peakBytes(0),
+      _allocCount(0),
+      _freeCount(0),
+      _limit(0)
+{
+    for (size_t i = 0; i < SizeClassCount; i++)
+    {
+        _freeLists[i] = NULL;
+    }
+}
+
+LuaAllocator::~LuaAllocator()
+{
+    while (_chunks != NULL)
+    {
+        Chunk *next = _chunks -> next;
+        free(_chunks);
+        _chunks = next;
+    }
+}
+
+void* LuaAllocator::alloc(void *userdata, void *ptr, size_t osize, size_t nsize)
+{
+    LuaAllocator *allocator = (LuaAllocator *)userdata;
+    return allocator -> reallocate(ptr, osize, nsize);
+}
+
+LuaAllocatorPolicy LuaAllocator::getPolicy()
+{
+    return _policy;
+}
+
+void LuaAllocator::setLimit(size_t limit)
+{
+    _limit.store(limit, std::memory_order_relaxed);
+}
+
+LuaMemoryStatistics LuaAllocator::getStatistics()
+{
+    LuaMemoryStatistics statistics;
+    statistics.liveBytes = _liveBytes.load(std::memory_order_relaxed);
+    statistics.peakBytes = _peakBytes.load(std::memory_order_relaxed);
+    statistics.allocCount = _allocCount.load(std::memory_order_relaxed);
+    statistics.freeCount = _freeCount.load(std::memory_order_relaxed);
+    statistics.limitBytes = _limit.load(std::memory_order_relaxed);
+
+    return statistics;
+}
+
+void* LuaAllocator::reallocate(void *ptr, size_t osize, size_t nsize)
+{
+    //ptr为NULL时osize表示对象类型（Lua 5.2+），不代表内存大小
+    if (ptr == NULL)
+    {
+        osize = 0;
+    }
+
+    size_t liveBytes = _liveBytes.load(std::memory_order_relaxed);
+
+    if (nsize == 0)
+    {
+        //释放内存
+        if (ptr != NULL)
+        {
+            if (_policy == LuaAllocatorPolicyPool && osize <= SizeClassGranularity * SizeClassCount)
+            {
+                poolFree(ptr, (osize - 1) / SizeClassGranularity);
+            }
+            else
+            {
+                free(ptr);
+            }
+
+            _liveBytes.store(liveBytes - osize, std::memory_order_relaxed);
+            _freeCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        return NULL;
+    }
+
+    //检测内存上限，缩小内存不受限制，避免Lua在回收过程中失败
+    size_t limit = _limit.load(std::memory_order_relaxed);
+    if (limit > 0 && nsize > osize && liveBytes - osize + nsize > limit)
+    {
+        return NULL;
+    }
+
+    void *newPtr = NULL;
+    if (_policy == LuaAllocatorPolicyPool)
+    {
+        size_t maxPoolSize = SizeClassGranularity * SizeClassCount;
+        size_t oldClass = osize > 0 ? (osize - 1) / SizeClassGranularity : SizeClassCount;
+        size_t newClass = (nsize - 1) / SizeClassGranularity;
+
+        if (ptr != NULL && osize <= maxPoolSize && nsize <= maxPoolSize && oldClass == newClass)
+        {
+            //同一尺寸级别，直接复用原内存块
+            newPtr = ptr;
+        }
+        else if (ptr != NULL && osize > maxPoolSize && nsize > maxPoolSize)
+        {
+            newPtr = realloc(ptr, nsize);
+        }
+        else
+        {
+            newPtr = nsize <= maxPoolSize ? poolAlloc(newClass) : malloc(nsize);
+            if (newPtr != NULL && ptr != NULL)
+            {
+                memcpy(newPtr, ptr, osize < nsize ? osize : nsize);
+
+                if (osize <= maxPoolSize)
+                {
+                    poolFree(ptr, oldClass);
+                }
+                else
+                {
+                    free(ptr);
+                }
+            }
+        }
+    }
+    else
+    {
+        newPtr = realloc(ptr, nsize);
+    }
+
+    if (newPtr == NULL)
+    {
+        if (ptr == NULL || nsize >= osize)
+        {
+            return NULL;
+        }
+
+        //Lua假定缩小内存不会失败，无法获取新内存块时继续使用原内存块。
+        //原内存块不小于新尺寸，之后按新尺寸释放或放入较小的尺寸级别均是安全的
+        newPtr = ptr;
+    }
+
+    liveBytes = liveBytes - osize + nsize;
+    _liveBytes.store(liveBytes, std::memory_order_relaxed);
+    if (liveBytes > _peakBytes.load(std::memory_order_relaxed))
+    {
+        _peakBytes.store(liveBytes, std::memory_order_relaxed);
+    }
+
+    if (ptr == NULL)
+    {
+        _allocCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return newPtr;
+}
+
+void* LuaAllocator::poolAlloc(size_t sizeClass)
+{
+    FreeBlock *block = _freeLists[sizeClass];
+    if (block != NULL)
+    {
+        _freeLists[sizeClass] = block -> next;
+        return block;
+    }
+
+    size_t blockSize = (sizeClass + 1) * SizeClassGranularity;
+    if (_chunkCursor == NULL || (size_t)(_chunkEnd - _chunkCursor) < blockSize)
+    {
+        //当前内存大块剩余空间不足，将剩余空间归还到对应的空闲链表后申请新的内存大块
+        while (_chunkCursor != NULL && (size_t)(_chunkEnd - _chunkCursor) >= SizeClassGranularity)
+        {
+            size_t remainClass = (size_t)(_chunkEnd - _chunkCursor) / SizeClassGranularity - 1;
+            if (remainClass >= SizeClassCount)
+            {
+                remainClass = SizeClassCount - 1;
+            }
+
+            poolFree(_chunkCursor, remainClass);
+            _chunkCursor += (remainClass + 1) * SizeClassGranularity;
+        }
+
+        Chunk *chunk = (Chunk *)malloc(ChunkSize);
+        if (chunk == NULL)
+        {
+            return NULL;
+        }
+
+        chunk -> next = _chunks;
+        _chunks = chunk;
+
+        _chunkCursor = (char *)chunk + ChunkHeaderSize;
+        _chunkEnd = (char *)chunk + ChunkSize;
+    }
+
+    void *ptr = _chunkCursor;
+    _chunkCursor += blockSize;
+
+    return ptr;
+}
+
+void LuaAllocator::poolFree(void *ptr, size_t sizeClass)
+{
+    FreeBlock *block = (FreeBlock *)ptr;
+    block -> next = _freeLists[sizeClass];
+    _freeLists[sizeClass] = block;
+}
@@ -0,0 +1,162 @@
+#ifndef ANDROID_LUAALLOCATOR_H
+#define ANDROID_LUAALLOCATOR_H
+
+#include "LuaObject.h"
+#include "LuaDefined.h"
+#include <atomic>
+#include <stddef.h>
+
+namespace cn {
+    namespace vimfung {
+        namespace luascriptcore {
+
+            /**
+             * 内存分配器，为Lua状态对象提供内存分配并统计内存使用情况。
+             * 一个分配器只能服务于一个Lua状态对象，Lua状态对象的访问已由操作队列串行化，因此分配过程不加锁。
+             */
+            class LuaAllocator : public LuaObject
+            {
+            public:
+
+                /**
+                 * 初始化
+                 *
+                 * @param policy 分配策略
+                 */
+                LuaAllocator(LuaAllocatorPolicy policy);
+
+                /**
+                 * 销毁，释放内存池中的所有内存块
+                 */
+                ~LuaAllocator();
+
+            public:
+
+                /**
+                 * Lua内存分配函数，userdata为分配器对象
+                 *
+                 * @param userdata 分配器对象
+                 * @param ptr 原内存块
+                 * @param osize 原内存块大小
+                 * @param nsize 新内存块大小
+                 *
+                 * @return 新内存块
+                 */
+                static void* alloc(void *userdata, void *ptr, size_t osize, size_t nsize);
+
+            public:
+
+                /**
+                 * 获取分配策略
+                 *
+                 * @return 分配策略
+                 */
+                LuaAllocatorPolicy getPolicy();
+
+                /**
+                 * 设置内存上限，超出上限的分配请求将失败，Lua层会抛出内存不足错误
+                 *
+                 * @param limit 上限字节数，0表示不限制
+                 */
+                void setLimit(size_t limit);
+
+                /**
+                 * 获取内存统计信息
+                 *
+                 * @return 统计信息
+                 */
+                LuaMemoryStatistics getStatistics();
+
+            private:
+
+                /**
+                 * 分配内存
+                 *
+                 * @param ptr 原内存块
+                 * @param osize 原内存块大小
+                 * @param nsize 新内存块大小
+                 *
+                 * @return 新内存块
+                 */
+                void* reallocate(void *ptr, size_t osize, size_t nsize);
+
+                /**
+                 * 从内存池中分配内存块
+                 *
+                 * @param sizeClass 尺寸级别
+                 *
+                 * @return 内存块
+                 */
+                void* poolAlloc(size_t sizeClass);
+
+                /**
+                 * 将内存块归还内存池
+                 *
+                 * @param ptr 内存块
+                 * @param sizeClass 尺寸级别
+                 */
+                void poolFree(void *ptr, size_t sizeClass);
+
+            private:
+
+                /**
+                 * 尺寸级别粒度
+                 */
+                static const size_t SizeClassGranularity = 16;
+
+                /**
+                 * 尺寸级别数量，内存池处理的最大内存块为 SizeClassGranularity * SizeClassCount 字节
+                 */
+                static const size_t SizeClassCount = 16;
+
+                /**
+                 * 内存池每次向系统申请的内存大小
+                 */
+                static const size_t ChunkSize = 16 * 1024;
+
+                /**
+                 * 空闲内存块
+                 */
+                struct FreeBlock
+                {
+                    FreeBlock *next;
+                };
+
+                /**
+                 * 向系统申请的内存大块
+                 */
+                struct Chunk
+                {
+                    Chunk *next;
+                };
+
+                LuaAllocatorPolicy _policy;
+
+                /**
+                 * 各尺寸级别的空闲内存块链表
+                 */
+                FreeBlock *_freeLists[SizeClassCount];
+
+                /**
+                 * 已申请的内存大块链表
+                 */
+                Chunk *_chunks;
+
+                /**
+                 * 当前内存大块中尚未切分的内存
+                 */
+                char *_chunkCursor;
+                char *_chunkEnd;
+
+                std::atomic<size_t> _liveBytes;
+                std::atomic<size_t> _peakBytes;
+                std::atomic<size_t> _allocCount;
+                std::atomic<size_t> _freeCount;
+                std::atomic<size_t> _limit;
+            };
+        }
+    }
+}
+
+
+#endif //ANDROID_LUAALLOCATOR_H
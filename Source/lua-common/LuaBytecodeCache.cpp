@@ -0,0 +1,354 @@
+#include "LuaBytecodeCache.h"
+#include "LuaEngineAdapter.hpp"
+#include "StringUtils.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <thread>
+#include <functional>
+
+using namespace cn::vimfung::luascriptcore;
+
+/**
+ * 磁盘缓存文件标识
+ */
+static const char CacheFileMagic[4] = {'L', 'S', 'C', 'B'};
+
+/**
+ * 磁盘缓存文件头部
+ */
+typedef struct
+{
+    char magic[4];                      //文件标识
+    int version;                        //Lua版本号
+    long long modifyTime;               //修改时间
+    long long fileSize;                 //文件大小
+    unsigned long long contentHash;     //内容哈希
+    unsigned int pathLength;            //文件路径长度，路径紧随头部存储，用于排除缓存文件名冲突
+} CacheFileHeader;
+
+/**
+ * 临时缓存文件序号
+ */
+static std::atomic<unsigned int> _tmpFileSequence(0);
+
+/**
+ * 计算数据哈希值（FNV-1a）
+ *
+ * @param data 数据
+ * @param size 数据大小
+ *
+ * @return 哈希值
+ */
+static unsigned long long hashData(const char *data, size_t size)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+/**
+ * 读取文件全部内容
+ *
+ * @param path 文件路径
+ * @param content 文件内容
+ *
+ * @return true 表示读取成功，否则读取失败
+ */
+static bool readFileContent(std::string const& path, std::string &content)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    content.clear();
+
+    char buffer[4096];
+    size_t size = 0;
+    while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        content.append(buffer, size);
+    }
+
+    bool success = ferror(file) == 0;
+    fclose(file);
+
+    return success;
+}
+
+/**
+ * 字节码写入函数，供lua_dump使用
+ */
+static int bytecodeWriter(lua_State *, const void *p, size_t size, void *ud)
+{
+    std::string *bytecode = (std::string *)ud;
+    bytecode -> append((const char *)p, size);
+
+    return 0;
+}
+
+LuaBytecodeCache::LuaBytecodeCache()
+    : LuaBytecodeCache("")
+{
+
+}
+
+LuaBytecodeCache::LuaBytecodeCache(std::string const& cacheDir)
+    : LuaObject(),
+      _cacheDir(cacheDir),
+      _verifyContent(false)
+{
+
+}
+
+void LuaBytecodeCache::setVerifyContent(bool verifyContent)
+{
+    _verifyContent = verifyContent;
+}
+
+void LuaBytecodeCache::clear()
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    _entries.clear();
+}
+
+int LuaBytecodeCache::loadFile(lua_State *state, std::string const& path)
+{
+    struct stat fileStat;
+    if (stat(path.c_str(), &fileStat) != 0)
+    {
+        //文件不存在，交由Lua生成错误信息
+        return LuaEngineAdapter::loadFile(state, path.c_str());
+    }
+
+    std::string chunkName = "@" + path;
+    std::string content;
+    bool hasContent = false;
+
+    Entry entry;
+    if (findEntry(path, entry)
+        && entry.modifyTime == (long long)fileStat.st_mtime
+        && entry.fileSize == (long long)fileStat.st_size)
+    {
+        bool matched = true;
+        if (_verifyContent)
+        {
+            hasContent = readFileContent(path, content);
+            matched = hasContent && hashData(content.c_str(), content.size()) == entry.contentHash;
+        }
+
+        if (matched)
+        {
+            if (LuaEngineAdapter::loadBuffer(state, entry.bytecode.c_str(), entry.bytecode.size(), chunkName.c_str()) == 0)
+            {
+                return 0;
+            }
+
+            //缓存的字节码无法加载（如磁盘缓存损坏），移除错误信息后重新编译
+            LuaEngineAdapter::pop(state, 1);
+        }
+    }
+
+    if (!hasContent && !readFileContent(path, content))
+    {
+        return LuaEngineAdapter::loadFile(state, path.c_str());
+    }
+
+    entry.modifyTime = (long long)fileStat.st_mtime;
+    entry.fileSize = (long long)fileStat.st_size;
+    entry.contentHash = hashData(content.c_str(), content.size());
+    entry.bytecode.clear();
+
+    //与luaL_loadfile一致，跳过UTF-8 BOM及首行注释（保留换行以维持行号）
+    size_t offset = 0;
+    if (content.compare(0, 3, "\xEF\xBB\xBF") == 0)
+    {
+        offset = 3;
+    }
+
+    if (offset < content.size() && content[offset] == '#')
+    {
+        size_t lineEnd = content.find('\n', offset);
+        offset = lineEnd == std::string::npos ? content.size() : lineEnd;
+    }
+
+    const char *source = content.c_str() + offset;
+    size_t sourceSize = content.size() - offset;
+
+    if (sourceSize > 0 && source[0] == LUA_SIGNATURE[0])
+    {
+        //文件本身为字节码，无需缓存
+        return LuaEngineAdapter::loadBuffer(state, source, sourceSize, chunkName.c_str());
+    }
+
+    int status = LuaEngineAdapter::loadBuffer(state, source, sourceSize, chunkName.c_str());
+    if (status != 0)
+    {
+        return status;
+    }
+
+    if (LuaEngineAdapter::dump(state, bytecodeWriter, &entry.bytecode) == 0)
+    {
+        saveEntry(path, entry);
+    }
+
+    return 0;
+}
+
+std::string LuaBytecodeCache::searchPath(std::string const& name, std::string const& searchPath)
+{
+    std::string fileName = name;
+    for (std::string::iterator it = fileName.begin(); it != fileName.end(); ++it)
+    {
+        if (*it == '.')
+        {
+            *it = LUA_DIRSEP[0];
+        }
+    }
+
+    size_t start = 0;
+    while (start <= searchPath.size())
+    {
+        size_t end = searchPath.find(';', start);
+        if (end == std::string::npos)
+        {
+            end = searchPath.size();
+        }
+
+        std::string filePath = searchPath.substr(start, end - start);
+        start = end + 1;
+
+        if (filePath.empty())
+        {
+            continue;
+        }
+
+        size_t pos = 0;
+        while ((pos = filePath.find('?', pos)) != std::string::npos)
+        {
+            filePath.replace(pos, 1, fileName);
+            pos += fileName.size();
+        }
+
+        FILE *file = fopen(filePath.c_str(), "r");
+        if (file != NULL)
+        {
+            fclose(file);
+            return filePath;
+        }
+    }
+
+    return "";
+}
+
+bool LuaBytecodeCache::findEntry(std::string const& path, Entry &entry)
+{
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+
+        EntryMap::iterator it = _entries.find(path);
+        if (it != _entries.end())
+        {
+            entry = it -> second;
+            return true;
+        }
+    }
+
+    if (_cacheDir.empty())
+    {
+        return false;
+    }
+
+    std::string content;
+    if (!readFileContent(cacheFilePath(path), content) || content.size() < sizeof(CacheFileHeader))
+    {
+        return false;
+    }
+
+    CacheFileHeader header;
+    memcpy(&header, content.c_str(), sizeof(CacheFileHeader));
+
+    if (memcmp(header.magic, CacheFileMagic, sizeof(CacheFileMagic)) != 0
+        || header.version != LUA_VERSION_NUM
+        || header.pathLength != path.size()
+        || content.size() < sizeof(CacheFileHeader) + header.pathLength
+        || content.compare(sizeof(CacheFileHeader), header.pathLength, path) != 0)
+    {
+        return false;
+    }
+
+    entry.modifyTime = header.modifyTime;
+    entry.fileSize = header.fileSize;
+    entry.contentHash = header.contentHash;
+    entry.bytecode = content.substr(sizeof(CacheFileHeader) + header.pathLength);
+
+    std::lock_guard<std::mutex> lock(_lock);
+    _entries[path] = entry;
+
+    return true;
+}
+
+void LuaBytecodeCache::saveEntry(std::string const& path, Entry const& entry)
+{
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _entries[path] = entry;
+    }
+
+    if (_cacheDir.empty())
+    {
+        return;
+    }
+
+    CacheFileHeader header;
+    memset(&header, 0, sizeof(CacheFileHeader));
+    memcpy(header.magic, CacheFileMagic, sizeof(CacheFileMagic));
+    header.version = LUA_VERSION_NUM;
+    header.modifyTime = entry.modifyTime;
+    header.fileSize = entry.fileSize;
+    header.contentHash = entry.contentHash;
+    header.pathLength = (unsigned int)path.size();
+
+    //先写入临时文件再重命名，避免其他进程读取到不完整的缓存文件
+    std::string filePath = cacheFilePath(path);
+    //临时文件名包含线程标识及递增序号，同一进程中多个线程同时保存同一文件时不会相互覆盖
+    std::string tmpFilePath = StringUtils::format("%s.%llx.%x.tmp",
+                                                  filePath.c_str(),
+                                                  (unsigned long long)std::hash<std::thread::id>()(std::this_thread::get_id()),
+                                                  _tmpFileSequence.fetch_add(1));
+
+    FILE *file = fopen(tmpFilePath.c_str(), "wb");
+    if (file == NULL)
+    {
+        return;
+    }
+
+    bool success = fwrite(&header, sizeof(CacheFileHeader), 1, file) == 1
+                   && fwrite(path.c_str(), 1, path.size(), file) == path.size()
+                   && fwrite(entry.bytecode.c_str(), 1, entry.bytecode.size(), file) == entry.bytecode.size();
+    success = fclose(file) == 0 && success;
+
+    if (!success || rename(tmpFilePath.c_str(), filePath.c_str()) != 0)
+    {
+        remove(tmpFilePath.c_str());
+    }
+}
+
+std::string LuaBytecodeCache::cacheFilePath(std::string const& path)
+{
+    std::string dir = _cacheDir;
+    if (dir[dir.size() - 1] != '/' && dir[dir.size() - 1] != '\\')
+    {
+        dir += "/";
+    }
+
+    return StringUtils::format("%s%016llx.luac", dir.c_str(), hashData(path.c_str(), path.size()));
+}
@@ -0,0 +1,124 @@
+#ifndef ANDROID_LUABYTECODECACHE_H
+#define ANDROID_LUABYTECODECACHE_H
+
+#include "lua.hpp"
+#include "LuaObject.h"
+#include "LuaDefined.h"
+#include <map>
+#include <string>
+#include <mutex>
+
+namespace cn {
+    namespace vimfung {
+        namespace luascriptcore {
+
+            /**
+             * 字节码缓存，缓存lua文件编译后的字节码，避免重复解析编译。
+             * 缓存以文件路径、修改时间及文件大小作为键，可选校验文件内容哈希。可在多个上下文间共享。
+             */
+            class LuaBytecodeCache : public LuaObject
+            {
+            public:
+
+                /**
+                 * 初始化，仅使用内存缓存
+                 */
+                LuaBytecodeCache();
+
+                /**
+                 * 初始化
+                 *
+                 * @param cacheDir 磁盘缓存目录，目录需要已存在，为空字符串时仅使用内存缓存
+                 */
+                LuaBytecodeCache(std::string const& cacheDir);
+
+            public:
+
+                /**
+                 * 设置是否校验文件内容，开启后命中缓存时会读取文件并比对内容哈希，默认不校验
+                 *
+                 * @param verifyContent true 表示校验，否则不校验
+                 */
+                void setVerifyContent(bool verifyContent);
+
+                /**
+                 * 加载lua文件，与luaL_loadfile行为一致，成功时将代码块入栈，失败时将错误信息入栈
+                 *
+                 * @param state 状态对象
+                 * @param path 文件路径
+                 *
+                 * @return 执行结果，0表示成功
+                 */
+                int loadFile(lua_State *state, std::string const& path);
+
+                /**
+                 * 清空缓存，磁盘缓存文件不会被删除，但会在下次加载时因内容不匹配而被覆盖
+                 */
+                void clear();
+
+                /**
+                 * 根据模块名称在搜索路径中查找文件，与package.searchpath行为一致
+                 *
+                 * @param name 模块名称
+                 * @param searchPath 搜索路径，以';'分隔，'?'为模块名称占位符
+                 *
+                 * @return 文件路径，找不到时返回空字符串
+                 */
+                static std::string searchPath(std::string const& name, std::string const& searchPath);
+
+            private:
+
+                /**
+                 * 缓存项
+                 */
+                struct Entry
+                {
+                    long long modifyTime;               //修改时间
+                    long long fileSize;                 //文件大小
+                    unsigned long long contentHash;     //内容哈希
+                    std::string bytecode;               //字节码
+                };
+
+                typedef std::map<std::string, Entry> EntryMap;
+
+                /**
+                 * 查找缓存项，内存中不存在时从磁盘缓存读取
+                 *
+                 * @param path 文件路径
+                 * @param entry 缓存项
+                 *
+                 * @return true 表示找到，否则没有缓存
+                 */
+                bool findEntry(std::string const& path, Entry &entry);
+
+                /**
+                 * 保存缓存项
+                 *
+                 * @param path 文件路径
+                 * @param entry 缓存项
+                 */
+                void saveEntry(std::string const& path, Entry const& entry);
+
+                /**
+                 * 获取磁盘缓存文件路径
+                 *
+                 * @param path lua文件路径
+                 *
+                 * @return 缓存文件路径
+                 */
+                std::string cacheFilePath(std::string const& path);
+
+            private:
+
+                std::string _cacheDir;
+                bool _verifyContent;
+
+                EntryMap _entries;
+                std::mutex _lock;
+            };
+        }
+    }
+}
+
+
+#endif //ANDROID_LUABYTECODECACHE_H
@@ -12,69 +12,58 @@
 #include "LuaEngineAdapter.hpp"
 #include "LuaExportsTypeManager.hpp"
 #include "LuaOperationQueue.h"
+#include "LuaGCScheduler.h"
+#include "LuaAllocator.h"
+#include "LuaBytecodeCache.h"
+#include "StringUtils.h"
 #include <map>
 #include <list>
 #include <iostream>
 #include <sstream>
 #include <thread>
-#include <signal.h>
-
-#if _WINDOWS
-
-#include <windows.h>
-#pragma comment(lib,"Winmm.lib")
-
-#else
-
-#include <sys/time.h>
-#include <unistd.h>
-
-#endif
 
 using namespace cn::vimfung::luascriptcore;
 
 /**
- * 捕获异常处理器名称
+ * 会话缓存池的最大容量
  */
-static const char * CatchLuaExceptionHandlerName = "__catchExcepitonHandler";
+static const size_t SessionPoolMaxSize = 16;
 
 /**
- 需要回收内存上下文列表
+ * 离开会话时请求内存回收的最小间隔（毫秒），间隔内的请求会被合并
  */
-static std::deque<LuaContext *> _needsGCContextList;
+static const int SessionGCRequestInterval = 5;
 
 /**
- * 方法路由处理器
+ * 执行方法
  *
  * @param state lua状态
+ * @param hasError 是否产生异常，产生异常时异常信息位于栈顶
  *
  * @return 参数返回数量
  */
-static int methodRouteHandler(lua_State *state) {
-
+static int invokeMethod(lua_State *state, bool &hasError)
+{
     int returnCount = 0;
 
     LuaContext *context = (LuaContext *)LuaEngineAdapter::toUserdata(state, LuaEngineAdapter::upValueIndex(1));
     const char *methodName = LuaEngineAdapter::toString(state, LuaEngineAdapter::upValueIndex(2));
 
-    LuaMethodHandler handler = context-> getMethodHandler(methodName);
+    //处理器在注册时保存在闭包中，无需查找方法表
+    LuaMethodHandler handler = *(LuaMethodHandler *)LuaEngineAdapter::toUserdata(state, LuaEngineAdapter::upValueIndex(3));
     if (handler != NULL)
     {
-        LuaSession *session = context -> makeSession(state, false);
+        LuaSessionScope scope(state, context, false);
+        LuaSession *session = scope.getSession();
 
         LuaArgumentList args;
         session -> parseArguments(args);
 
         LuaValue *retValue = handler (context, methodName, args);
 
-        //检测异常
-        session -> checkException();
-
         if (retValue != NULL)
         {
             returnCount = session -> setReturnValue(retValue);
-
-            retValue -> push(context);
             retValue -> release();
         }
 
@@ -85,138 +74,264 @@ static int methodRouteHandler(lua_State *state) {
             item -> release();
         }
 
-        context -> destorySession(session);
+        std::string errMessage;
+        if (session -> takeException(errMessage))
+        {
+            hasError = true;
+            LuaEngineAdapter::pushString(state, errMessage.c_str());
+        }
     }
 
     return returnCount;
 }
 
 /**
- * 捕获Lua异常处理器
+ * 方法路由处理器
+ *
+ * @param state lua状态
  *
- * @param context 上下文对象
- * @param methodName 方法名称
- * @param arguments 参数列表
+ * @return 参数返回数量
  */
-static LuaValue* catchLuaExceptionHandler (LuaContext *context, std::string const& methodName, LuaArgumentList arguments)
-{
-    if (arguments.size() > 0)
+static int methodRouteHandler(lua_State *state) {
+
+    bool hasError = false;
+    int returnCount = invokeMethod(state, hasError);
+
+    if (hasError)
     {
-        context -> outputExceptionMessage(arguments[0] -> toString());
+        //会话已在invokeMethod返回时离开，抛出异常中断执行不会导致泄露
+        LuaEngineAdapter::error(state, LuaEngineAdapter::toString(state, -1));
     }
 
-    return NULL;
+    return returnCount;
 }
 
-static void executeGC()
+/**
+ * 快速方法参数视图的栈上容量，超出时使用堆内存
+ */
+static const int FastMethodStackArgumentCount = 8;
+
+/**
+ * 执行快速方法
+ *
+ * @param state lua状态
+ * @param hasError 是否产生异常，产生异常时异常信息位于栈顶
+ *
+ * @return 参数返回数量
+ */
+static int invokeFastMethod(lua_State *state, bool &hasError)
 {
-    //进行内存回收
-    for (std::deque<LuaContext *>::iterator it = _needsGCContextList.begin(); it != _needsGCContextList.end(); it++)
+    int returnCount = 0;
+
+    LuaContext *context = (LuaContext *)LuaEngineAdapter::toUserdata(state, LuaEngineAdapter::upValueIndex(1));
+    LuaFastMethodHandler handler = *(LuaFastMethodHandler *)LuaEngineAdapter::toUserdata(state, LuaEngineAdapter::upValueIndex(2));
+
+    LuaSessionScope scope(state, context, false);
+    LuaSession *session = scope.getSession();
+
+    //参数较少时使用栈上数组，避免分配参数列表
+    LuaValue *stackValues[FastMethodStackArgumentCount];
+    std::vector<LuaValue *> heapValues;
+
+    LuaArgumentView arguments;
+    arguments.count = LuaEngineAdapter::getTop(state);
+    arguments.values = stackValues;
+    if (arguments.count > FastMethodStackArgumentCount)
     {
-        LuaContext *context = *it;
-        context->gcHandler();
-        context->release();       // 回收后释放
+        heapValues.resize(arguments.count);
+        arguments.values = heapValues.data();
     }
-    //清空
-    _needsGCContextList.clear();
-}
 
-#if _WINDOWS
+    for (int i = 0; i < arguments.count; i++)
+    {
+        arguments.values[i] = LuaValue::ValueByIndex(context, i + 1);
+    }
 
-void WINAPI contextGCHandler(UINT wTimerID, UINT msg, DWORD dwUser, DWORD dwl, DWORD dw2)
-{
-	unityDebug("gc handler...");
+    LuaValue *retValue = handler (context, arguments);
+
+    if (retValue != NULL)
+    {
+        returnCount = session -> setReturnValue(retValue);
+        retValue -> release();
+    }
+
+    //释放参数内存
+    for (int i = 0; i < arguments.count; i++)
+    {
+        arguments.values[i] -> release();
+    }
 
-	//重置计时器
-	timeKillEvent(wTimerID);
+    std::string errMessage;
+    if (session -> takeException(errMessage))
+    {
+        hasError = true;
+        LuaEngineAdapter::pushString(state, errMessage.c_str());
+    }
 
-    //进行内存回收
-    std::thread gcThread(executeGC);
-    gcThread.detach();
+    return returnCount;
 }
 
-#else
 /**
- 上下文内存回收处理
-
- @param signo 信号
+ * 快速方法路由处理器
+ *
+ * @param state lua状态
+ *
+ * @return 参数返回数量
  */
-static void contextGCHandler(int signo)
+static int fastMethodRouteHandler(lua_State *state)
 {
-    //重置计时器
-    struct itimerval itv;
-    itv.it_value.tv_sec = 0;
-    itv.it_value.tv_usec = 0;
-    itv.it_interval = itv.it_value;
-    setitimer(ITIMER_REAL, &itv, NULL);
+    bool hasError = false;
+    int returnCount = invokeFastMethod(state, hasError);
 
-    //进行内存回收
-    std::thread gcThread(executeGC);
-    gcThread.detach();
-}
+    if (hasError)
+    {
+        //原生对象已在invokeFastMethod中全部销毁，会话也已离开，抛出异常中断执行不会导致泄露
+        LuaEngineAdapter::error(state, LuaEngineAdapter::toString(state, -1));
+    }
 
-#endif
+    return returnCount;
+}
 
 /**
- 上下文开始回收
- 
- @param context 上下文对象
+ * 通过字节码缓存查找并加载模块
+ *
+ * @param state lua状态
+ * @param hasError 是否产生异常，产生异常时异常信息位于栈顶
+ *
+ * @return 参数返回数量
  */
-static void contextStartGC(LuaContext *context)
+static int searchBytecodeCacheModule(lua_State *state, bool &hasError)
 {
-    //加入列表
-    bool hasExists = false;
-    for (std::deque<LuaContext *>::iterator it = _needsGCContextList.begin(); it != _needsGCContextList.end(); it++)
+    LuaContext *context = (LuaContext *)LuaEngineAdapter::toUserdata(state, LuaEngineAdapter::upValueIndex(1));
+    const char *name = LuaEngineAdapter::checkString(state, 1);
+
+    LuaBytecodeCache *bytecodeCache = context -> getBytecodeCache();
+    if (bytecodeCache == NULL)
     {
-        if (*it == context)
-        {
-            hasExists = true;
-            break;
-        }
+        LuaEngineAdapter::pushString(state, "");
+        return 1;
     }
 
-    if (!hasExists)
+    LuaEngineAdapter::getGlobal(state, "package");
+    LuaEngineAdapter::getField(state, -1, "path");
+    const char *searchPath = LuaEngineAdapter::toString(state, -1);
+    std::string path = LuaBytecodeCache::searchPath(name, searchPath != NULL ? searchPath : "");
+    LuaEngineAdapter::pop(state, 2);
+
+    if (path.empty())
     {
-        context -> retain();
-        _needsGCContextList.push_back(context);
+        //交由后续的搜索器处理并输出未找到的信息
+        LuaEngineAdapter::pushString(state, "");
+        return 1;
+    }
 
-#if _WINDOWS
+    if (bytecodeCache -> loadFile(state, path) != 0)
+    {
+        std::string message = StringUtils::format("error loading module '%s' from file '%s':\n\t%s",
+                                                  name,
+                                                  path.c_str(),
+                                                  LuaEngineAdapter::toString(state, -1));
+        LuaEngineAdapter::pop(state, 1);
+        LuaEngineAdapter::pushString(state, message.c_str());
 
-		MMRESULT gcTimerId = timeSetEvent(100, 1, (LPTIMECALLBACK)contextGCHandler, NULL, TIME_ONESHOT);
-		if (NULL == gcTimerId)
-		{
-			unityDebug("gc timer create error!");
-		}
+        hasError = true;
+        return 0;
+    }
 
-#else
+    LuaEngineAdapter::pushString(state, path.c_str());
+    return 2;
+}
 
-        //监听定时器信号
-        signal(SIGALRM, contextGCHandler);
+/**
+ * 字节码缓存模块搜索器，按package.path查找lua文件并通过字节码缓存加载
+ *
+ * @param state lua状态
+ *
+ * @return 参数返回数量
+ */
+static int bytecodeCacheSearcher(lua_State *state)
+{
+    bool hasError = false;
+    int returnCount = searchBytecodeCacheModule(state, hasError);
 
-        //开始倒计时进行回收
-        struct itimerval itv;
-        itv.it_value.tv_sec = 0;
-        itv.it_value.tv_usec = 100000;
-        itv.it_interval = itv.it_value;
-        setitimer(ITIMER_REAL, &itv, NULL);
+    if (hasError)
+    {
+        //路径及错误信息字符串已在searchBytecodeCacheModule返回时销毁，抛出异常中断执行不会导致泄露
+        return LuaEngineAdapter::error(state, LuaEngineAdapter::toString(state, -1));
+    }
 
-#endif
+    return returnCount;
+}
+
+/**
+ * 异常处理器，作为pcall的消息处理函数，在产生异常时输出异常信息
+ *
+ * @param state lua状态
+ *
+ * @return 参数返回数量
+ */
+static int errorHandler(lua_State *state)
+{
+    LuaContext *context = (LuaContext *)LuaEngineAdapter::toPointer(state, LuaEngineAdapter::upValueIndex(1));
 
+    std::string message;
+    int type = LuaEngineAdapter::type(state, 1);
+    if (type == LUA_TSTRING || type == LUA_TNUMBER)
+    {
+        message = LuaEngineAdapter::toString(state, 1);
     }
+    else
+    {
+        message = StringUtils::format("(error object is a %s value)", LuaEngineAdapter::typeName(state, 1));
+    }
+
+    if (context -> isTracebackEnabled())
+    {
+        //仅在产生异常时生成调用栈信息
+        LuaEngineAdapter::traceback(state, message.empty() ? NULL : message.c_str(), 1);
+        message = LuaEngineAdapter::toString(state, -1);
+    }
+    else
+    {
+        LuaEngineAdapter::pushValue(state, 1);
+    }
+
+    context -> outputExceptionMessage(message);
+
+    return 1;
 }
 
 LuaContext::LuaContext(std::string const& platform)
+        : LuaContext(platform, LuaOperationQueueModeLock)
+{
+
+}
+
+LuaContext::LuaContext(std::string const& platform, LuaOperationQueueMode queueMode)
+        : LuaContext(platform, queueMode, LuaAllocatorPolicyDefault)
+{
+
+}
+
+LuaContext::LuaContext(std::string const& platform, LuaOperationQueueMode queueMode, LuaAllocatorPolicy allocatorPolicy)
         : LuaObject()
 {
-    _operationQueue = new LuaOperationQueue();
+    _allocator = new LuaAllocator(allocatorPolicy);
+    _operationQueue = new LuaOperationQueue(queueMode, LuaOperationQueue::DefaultCapacity);
 
     _isActive = true;
+    _gcPolicy = LuaGCPolicyFullOnIdle;
+    _gcStepSize = 0;
+    _bytecodeCache = NULL;
+    _bytecodeSearcherInstalled = false;
+    _asyncErrorMessage = NULL;
     _exceptionHandler = NULL;
+    _tracebackEnabled = false;
     _dataExchanger = new LuaDataExchanger(this);
 
     _operationQueue -> performAction([this]() {
 
-        lua_State *state = LuaEngineAdapter::newState();
+        lua_State *state = LuaEngineAdapter::newState(LuaAllocator::alloc, _allocator);
 
         LuaEngineAdapter::GC(state, LUA_GCSTOP, 0);
         //加载标准库
@@ -225,15 +340,17 @@ LuaContext::LuaContext(std::string const& platform)
 
         _mainSession = new LuaSession(state, this, false);
 
+        //异常处理器保存在注册表中，调用时直接入栈
+        LuaEngineAdapter::pushLightUserdata(state, this);
+        LuaEngineAdapter::pushCClosure(state, errorHandler, 1);
+        _errorHandlerRef = LuaEngineAdapter::ref(state, LUA_REGISTRYINDEX);
+
     });
 
     _currentSession = NULL;
     
     //初始化类型导出管理器
     _exportsTypeManager = new LuaExportsTypeManager(this, platform);
-
-    //注册错误捕获方法
-    registerMethod(CatchLuaExceptionHandlerName, catchLuaExceptionHandler);
 }
 
 LuaContext::~LuaContext()
@@ -243,6 +360,13 @@ LuaContext::~LuaContext()
     lua_State *state = _mainSession -> getState();
     
     _mainSession -> release();
+
+    for (std::vector<LuaSession *>::iterator it = _sessionPool.begin(); it != _sessionPool.end(); ++it)
+    {
+        (*it) -> release();
+    }
+    _sessionPool.clear();
+
     _exportsTypeManager -> release();
     _dataExchanger -> release();
 
@@ -251,6 +375,12 @@ LuaContext::~LuaContext()
     });
 
     _operationQueue -> release();
+    _allocator -> release();
+
+    if (_bytecodeCache != NULL)
+    {
+        _bytecodeCache -> release();
+    }
 }
 
 LuaSession* LuaContext::getMainSession()
@@ -270,26 +400,80 @@ LuaSession* LuaContext::getCurrentSession()
 
 LuaSession* LuaContext::makeSession(lua_State *state, bool lightweight)
 {
-    LuaSession *session = new LuaSession(state, this, lightweight);
-    session -> prevSession = _currentSession;
-    _currentSession = session;
+    LuaSession *session = NULL;
+    if (!_sessionPool.empty())
+    {
+        //复用缓存的会话
+        session = _sessionPool.back();
+        _sessionPool.pop_back();
+        session -> reset(state, lightweight);
+    }
+    else
+    {
+        session = new LuaSession(state, this, lightweight);
+    }
+
+    enterSession(session);
 
     return getCurrentSession();
 }
 
 void LuaContext::destorySession(LuaSession *session)
+{
+    leaveSession(session);
+
+    if (_mainSession != session)
+    {
+        if (_sessionPool.size() < SessionPoolMaxSize)
+        {
+            _sessionPool.push_back(session);
+        }
+        else
+        {
+            session -> release();
+        }
+    }
+}
+
+void LuaContext::enterSession(LuaSession *session)
+{
+    session -> prevSession = _currentSession;
+    _currentSession = session;
+
+    //清除已释放对象的引用
+    _dataExchanger -> flushPendingClear();
+}
+
+void LuaContext::leaveSession(LuaSession *session)
 {
     if (_currentSession == session)
     {
         _currentSession = _currentSession -> prevSession;
     }
 
-    if (_mainSession != session)
+    if (!session -> isLightweight())
     {
-        session -> release();
+        _requestSessionGC();
     }
 }
 
+void LuaContext::_requestSessionGC()
+{
+    if (_gcPolicy == LuaGCPolicyOff)
+    {
+        return;
+    }
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (now - _lastSessionGCTime < std::chrono::milliseconds(SessionGCRequestInterval))
+    {
+        return;
+    }
+
+    _lastSessionGCTime = now;
+    gc();
+}
+
 void LuaContext::onExportsNativeType(LuaExportsNativeTypeHandler handler)
 {
     _exportNativeTypeHandler = handler;
@@ -322,26 +506,48 @@ void LuaContext::outputExceptionMessage(std::string const& message)
     }
 }
 
-int LuaContext::catchException()
+void LuaContext::setAsyncCallResult(bool success)
 {
-    int index = 0;
-    _operationQueue -> performAction([this, &index]() {
+    if (_asyncErrorMessage == NULL)
+    {
+        return;
+    }
 
-        lua_State *state = getCurrentSession() -> getState();
+    if (success)
+    {
+        _asyncErrorMessage -> clear();
+        return;
+    }
 
-        LuaEngineAdapter::getGlobal(state, CatchLuaExceptionHandlerName);
-        if (LuaEngineAdapter::isFunction(state, -1))
-        {
-            index = LuaEngineAdapter::getTop(state);
-        }
-        else
-        {
-            LuaEngineAdapter::pop(state, 1);
-        }
+    //调用失败时栈顶为异常处理器返回的错误信息
+    lua_State *state = getCurrentSession() -> getState();
+    int type = LuaEngineAdapter::type(state, -1);
+    if (type == LUA_TSTRING || type == LUA_TNUMBER)
+    {
+        *_asyncErrorMessage = LuaEngineAdapter::toString(state, -1);
+    }
+    else
+    {
+        *_asyncErrorMessage = StringUtils::format("(error object is a %s value)", LuaEngineAdapter::typeName(state, -1));
+    }
+}
 
-    });
+int LuaContext::catchException()
+{
+    lua_State *state = getCurrentSession() -> getState();
+    LuaEngineAdapter::rawGetI(state, LUA_REGISTRYINDEX, _errorHandlerRef);
+
+    return LuaEngineAdapter::getTop(state);
+}
+
+void LuaContext::setTracebackEnabled(bool enabled)
+{
+    _tracebackEnabled = enabled;
+}
 
-    return index;
+bool LuaContext::isTracebackEnabled()
+{
+    return _tracebackEnabled;
 }
 
 void LuaContext::addSearchPath(std::string const& path)
@@ -397,6 +603,9 @@ LuaValue* LuaContext::evalScript(std::string const& script)
 
         lua_State *state = getCurrentSession() -> getState();
 
+        //清除已释放对象的引用
+        _dataExchanger -> flushPendingClear();
+
         int errFuncIndex = catchException();
         int curTop = LuaEngineAdapter::getTop(state);
         int returnCount = 0;
@@ -405,6 +614,7 @@ LuaValue* LuaContext::evalScript(std::string const& script)
         if (LuaEngineAdapter::pCall(state, 0, LUA_MULTRET, errFuncIndex) == 0)
         {
             //调用成功
+            setAsyncCallResult(true);
             returnCount = LuaEngineAdapter::getTop(state) - curTop;
 
             if (returnCount > 1)
@@ -429,6 +639,7 @@ LuaValue* LuaContext::evalScript(std::string const& script)
         else
         {
             //调用失败
+            setAsyncCallResult(false);
             returnCount = LuaEngineAdapter::getTop(state) - curTop;
         }
 
@@ -459,14 +670,26 @@ LuaValue* LuaContext::evalScriptFromFile(std::string const& path)
 
         lua_State *state = getCurrentSession() -> getState();
 
+        //清除已释放对象的引用
+        _dataExchanger -> flushPendingClear();
+
         int errFuncIndex = catchException();
         int curTop = LuaEngineAdapter::getTop(state);
         int returnCount = 0;
 
-        LuaEngineAdapter::loadFile(state, path.c_str());
+        if (_bytecodeCache != NULL)
+        {
+            _bytecodeCache -> loadFile(state, path);
+        }
+        else
+        {
+            LuaEngineAdapter::loadFile(state, path.c_str());
+        }
+
         if (LuaEngineAdapter::pCall(state, 0, LUA_MULTRET, errFuncIndex) == 0)
         {
             //调用成功
+            setAsyncCallResult(true);
             returnCount = LuaEngineAdapter::getTop(state) - curTop;
 
             if (returnCount > 1)
@@ -491,6 +714,7 @@ LuaValue* LuaContext::evalScriptFromFile(std::string const& path)
         else
         {
             //调用失败
+            setAsyncCallResult(false);
             returnCount = LuaEngineAdapter::getTop(state) - curTop;
         }
 
@@ -520,6 +744,9 @@ LuaValue* LuaContext::callMethod(std::string const& methodName, LuaArgumentList
 
         lua_State *state = getCurrentSession() -> getState();
 
+        //清除已释放对象的引用
+        _dataExchanger -> flushPendingClear();
+
         int errFuncIndex = catchException();
         int curTop = LuaEngineAdapter::getTop(state);
 
@@ -539,6 +766,7 @@ LuaValue* LuaContext::callMethod(std::string const& methodName, LuaArgumentList
             if (LuaEngineAdapter::pCall(state, (int)arguments -> size(), LUA_MULTRET, errFuncIndex) == 0)
             {
                 //调用成功
+                setAsyncCallResult(true);
                 returnCount = LuaEngineAdapter::getTop(state) - curTop;
                 if (returnCount > 1)
                 {
@@ -562,6 +790,7 @@ LuaValue* LuaContext::callMethod(std::string const& methodName, LuaArgumentList
             else
             {
                 //调用失败
+                setAsyncCallResult(false);
                 returnCount = LuaEngineAdapter::getTop(state) - curTop;
             }
 
@@ -592,8 +821,7 @@ LuaValue* LuaContext::callMethod(std::string const& methodName, LuaArgumentList
 void LuaContext::registerMethod(std::string const& methodName, LuaMethodHandler handler)
 {
 
-    LuaMethodMap::iterator it =  _methodMap.find(methodName);
-    if (it == _methodMap.end())
+    if (_methodMap.find(methodName) == _methodMap.end() && _fastMethodMap.find(methodName) == _fastMethodMap.end())
     {
         _methodMap[methodName] = handler;
         _operationQueue -> performAction([this, &methodName, &handler](){
@@ -601,13 +829,189 @@ void LuaContext::registerMethod(std::string const& methodName, LuaMethodHandler
             lua_State *state = getCurrentSession() -> getState();
             LuaEngineAdapter::pushLightUserdata(state, this);
             LuaEngineAdapter::pushString(state, methodName.c_str());
-            LuaEngineAdapter::pushCClosure(state, methodRouteHandler, 2);
+
+            LuaMethodHandler *handlerRef = (LuaMethodHandler *)LuaEngineAdapter::newUserdata(state, sizeof(LuaMethodHandler));
+            *handlerRef = handler;
+
+            LuaEngineAdapter::pushCClosure(state, methodRouteHandler, 3);
             LuaEngineAdapter::setGlobal(state, methodName.c_str());
 
         });
     }
 }
 
+void LuaContext::registerMethod(std::string const& methodName, LuaFastMethodHandler handler)
+{
+    if (_methodMap.find(methodName) == _methodMap.end() && _fastMethodMap.find(methodName) == _fastMethodMap.end())
+    {
+        _fastMethodMap[methodName] = handler;
+        _operationQueue -> performAction([this, &methodName, &handler](){
+
+            lua_State *state = getCurrentSession() -> getState();
+            LuaEngineAdapter::pushLightUserdata(state, this);
+
+            LuaFastMethodHandler *handlerRef = (LuaFastMethodHandler *)LuaEngineAdapter::newUserdata(state, sizeof(LuaFastMethodHandler));
+            *handlerRef = handler;
+
+            LuaEngineAdapter::pushCClosure(state, fastMethodRouteHandler, 2);
+            LuaEngineAdapter::setGlobal(state, methodName.c_str());
+
+        });
+    }
+}
+
+void LuaContext::evalScriptAsync(std::string const& script, LuaAsyncCompletionHandler handler)
+{
+    performAsyncAction([this, script]() {
+        return evalScript(script);
+    }, handler);
+}
+
+std::future<LuaValue*> LuaContext::evalScriptAsync(std::string const& script)
+{
+    return performAsyncAction([this, script]() {
+        return evalScript(script);
+    });
+}
+
+void LuaContext::evalScriptFromFileAsync(std::string const& path, LuaAsyncCompletionHandler handler)
+{
+    performAsyncAction([this, path]() {
+        return evalScriptFromFile(path);
+    }, handler);
+}
+
+std::future<LuaValue*> LuaContext::evalScriptFromFileAsync(std::string const& path)
+{
+    return performAsyncAction([this, path]() {
+        return evalScriptFromFile(path);
+    });
+}
+
+void LuaContext::callMethodAsync(std::string const& methodName, LuaArgumentList *arguments, LuaAsyncCompletionHandler handler)
+{
+    //复制并持有参数，调用完成后释放
+    LuaArgumentList args = *arguments;
+    for (LuaArgumentList::iterator it = args.begin(); it != args.end(); ++it)
+    {
+        (*it) -> retain();
+    }
+
+    performAsyncAction([this, methodName, args]() mutable {
+
+        //调用抛出异常时同样需要释放参数，释放后再重新抛出
+        LuaValue *retValue = NULL;
+        std::exception_ptr error;
+        try
+        {
+            retValue = callMethod(methodName, &args);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        for (LuaArgumentList::iterator it = args.begin(); it != args.end(); ++it)
+        {
+            (*it) -> release();
+        }
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+
+        return retValue;
+
+    }, handler);
+}
+
+std::future<LuaValue*> LuaContext::callMethodAsync(std::string const& methodName, LuaArgumentList *arguments)
+{
+    std::shared_ptr<std::promise<LuaValue*> > promise = std::make_shared<std::promise<LuaValue*> >();
+    std::future<LuaValue*> future = promise -> get_future();
+
+    callMethodAsync(methodName, arguments, [promise](LuaValue *result, std::string const& error) {
+        LuaContext::fulfillPromise(promise, result, error);
+    });
+
+    return future;
+}
+
+void LuaContext::performAsyncAction(std::function<LuaValue* (void)> const& action, LuaAsyncCompletionHandler handler)
+{
+    //持有上下文直到操作完成
+    retain();
+
+    _operationQueue -> post([this, action, handler]() {
+
+        LuaValue *result = NULL;
+        std::string errorMessage;
+
+        std::string *prevErrorMessage = _asyncErrorMessage;
+        _asyncErrorMessage = &errorMessage;
+
+        try
+        {
+            result = action();
+        }
+        catch (std::exception &e)
+        {
+            errorMessage = e.what();
+            if (errorMessage.empty())
+            {
+                errorMessage = "unknown exception";
+            }
+        }
+        catch (...)
+        {
+            errorMessage = "unknown exception";
+        }
+
+        _asyncErrorMessage = prevErrorMessage;
+
+        if (result == NULL)
+        {
+            result = LuaValue::NilValue();
+        }
+
+        if (handler != NULL)
+        {
+            handler(result, errorMessage);
+        }
+
+        result -> release();
+        release();
+
+    });
+}
+
+std::future<LuaValue*> LuaContext::performAsyncAction(std::function<LuaValue* (void)> const& action)
+{
+    std::shared_ptr<std::promise<LuaValue*> > promise = std::make_shared<std::promise<LuaValue*> >();
+    std::future<LuaValue*> future = promise -> get_future();
+
+    performAsyncAction(action, [promise](LuaValue *result, std::string const& error) {
+        LuaContext::fulfillPromise(promise, result, error);
+    });
+
+    return future;
+}
+
+void LuaContext::fulfillPromise(std::shared_ptr<std::promise<LuaValue*> > const& promise, LuaValue *result, std::string const& error)
+{
+    if (error.empty())
+    {
+        //返回值所有权转交给调用者
+        result -> retain();
+        promise -> set_value(result);
+    }
+    else
+    {
+        promise -> set_exception(std::make_exception_ptr(std::runtime_error(error)));
+    }
+}
+
 LuaMethodHandler LuaContext::getMethodHandler(std::string const& methodName)
 {
     LuaMethodMap::iterator it =  _methodMap.find(methodName);
@@ -644,18 +1048,124 @@ void LuaContext::releaseValue(LuaValue *value)
     _dataExchanger -> releaseLuaObject(value);
 }
 
+void LuaContext::retainValues(LuaValueList const& values)
+{
+    _dataExchanger -> retainLuaObjects(values);
+}
+
+void LuaContext::releaseValues(LuaValueList const& values)
+{
+    _dataExchanger -> releaseLuaObjects(values);
+}
+
 bool LuaContext::isActive()
 {
     return _isActive;
 }
 
+void LuaContext::setGCPolicy(LuaGCPolicy policy)
+{
+    _gcPolicy = policy;
+}
+
+LuaGCPolicy LuaContext::getGCPolicy()
+{
+    return _gcPolicy;
+}
+
+void LuaContext::setGCStepSize(int stepSize)
+{
+    _gcStepSize = stepSize;
+}
+
+void LuaContext::setGCPause(int pause)
+{
+    _operationQueue -> performAction([this, pause](){
+        LuaEngineAdapter::GC(getMainSession() -> getState(), LUA_GCSETPAUSE, pause);
+    });
+}
+
+void LuaContext::setGCStepMul(int stepMul)
+{
+    _operationQueue -> performAction([this, stepMul](){
+        LuaEngineAdapter::GC(getMainSession() -> getState(), LUA_GCSETSTEPMUL, stepMul);
+    });
+}
+
+void LuaContext::setMemoryLimit(size_t limit)
+{
+    _allocator -> setLimit(limit);
+}
+
+LuaMemoryStatistics LuaContext::getMemoryStatistics()
+{
+    return _allocator -> getStatistics();
+}
+
+void LuaContext::setBytecodeCache(LuaBytecodeCache *bytecodeCache)
+{
+    _operationQueue -> performAction([this, bytecodeCache](){
+
+        if (bytecodeCache != NULL)
+        {
+            bytecodeCache -> retain();
+        }
+        if (_bytecodeCache != NULL)
+        {
+            _bytecodeCache -> release();
+        }
+        _bytecodeCache = bytecodeCache;
+
+        if (_bytecodeSearcherInstalled || _bytecodeCache == NULL)
+        {
+            //搜索器已安装，搜索器运行时再获取当前的字节码缓存
+            return;
+        }
+
+        lua_State *state = getMainSession() -> getState();
+
+        //在package.searchers（Lua 5.1为package.loaders）中preload搜索器之后插入字节码缓存搜索器
+        LuaEngineAdapter::getGlobal(state, "package");
+        if (LuaEngineAdapter::isTable(state, -1))
+        {
+#if LUA_VERSION_NUM == 501
+            LuaEngineAdapter::getField(state, -1, "loaders");
+#else
+            LuaEngineAdapter::getField(state, -1, "searchers");
+#endif
+            if (LuaEngineAdapter::isTable(state, -1))
+            {
+                int count = (int)LuaEngineAdapter::rawLen(state, -1);
+                for (int i = count; i >= 2; i--)
+                {
+                    LuaEngineAdapter::rawGetI(state, -1, i);
+                    LuaEngineAdapter::rawSetI(state, -2, i + 1);
+                }
+
+                LuaEngineAdapter::pushLightUserdata(state, this);
+                LuaEngineAdapter::pushCClosure(state, bytecodeCacheSearcher, 1);
+                LuaEngineAdapter::rawSetI(state, -2, 2);
+
+                _bytecodeSearcherInstalled = true;
+            }
+            LuaEngineAdapter::pop(state, 1);
+        }
+        LuaEngineAdapter::pop(state, 1);
+
+    });
+}
+
+LuaBytecodeCache* LuaContext::getBytecodeCache()
+{
+    return _bytecodeCache;
+}
+
 void LuaContext::gc()
 {
-    if (_isActive && !_needGC)
+    if (_isActive && _gcPolicy != LuaGCPolicyOff)
     {
-        //进行定时内存回收检测
-        _needGC = true;
-        contextStartGC(this);
+        //交由回收调度器按策略进行回收
+        LuaGCScheduler::SharedInstance() -> schedule(this);
     }
 }
 
@@ -664,9 +1174,22 @@ void LuaContext::gcHandler()
     if (_isActive)
     {
         _operationQueue -> performAction([this](){
+            _dataExchanger -> flushPendingClear();
             LuaEngineAdapter::GC(getMainSession() -> getState(), LUA_GCCOLLECT, 0);
         });
+    }
+}
 
-        _needGC = false;
+bool LuaContext::gcStep()
+{
+    bool finished = true;
+    if (_isActive)
+    {
+        _operationQueue -> performAction([this, &finished](){
+            _dataExchanger -> flushPendingClear();
+            finished = LuaEngineAdapter::GC(getMainSession() -> getState(), LUA_GCSTEP, _gcStepSize) != 0;
+        });
     }
+
+    return finished;
 }
@@ -8,6 +8,9 @@
 #include "lua.hpp"
 #include "LuaObject.h"
 #include "LuaDefined.h"
+#include <future>
+#include <memory>
+#include <chrono>
 
 namespace cn
 {
@@ -22,6 +25,8 @@ namespace cn
             class LuaExportsTypeManager;
             class LuaExportTypeDescriptor;
             class LuaOperationQueue;
+            class LuaAllocator;
+            class LuaBytecodeCache;
 
             /**
              * Lua上下文环境, 维护原生代码与Lua之间交互的核心类型。
@@ -45,6 +50,11 @@ namespace cn
                  */
                 LuaMethodMap _methodMap;
 
+                /**
+                 * 快速方法映射表
+                 */
+                LuaFastMethodMap _fastMethodMap;
+
                 /**
                  * 数据交换器
                  */
@@ -59,6 +69,22 @@ namespace cn
                  * 当前会话对象
                  */
                 LuaSession *_currentSession;
+
+                /**
+                 * 会话缓存池，销毁的会话放入池中供后续创建会话时复用
+                 */
+                std::vector<LuaSession *> _sessionPool;
+
+                /**
+                 * 最近一次因离开会话而请求内存回收的时间
+                 */
+                std::chrono::steady_clock::time_point _lastSessionGCTime;
+
+                /**
+                 * 离开非轻量级会话时请求内存回收，回收策略为LuaGCPolicyOff时不请求，
+                 * 短时间内的多次请求会被合并，避免每次调用原生方法都访问回收调度器
+                 */
+                void _requestSessionGC();
                 
                 /**
                  导出类型管理器
@@ -69,17 +95,53 @@ namespace cn
                  * 操作队列
                  */
                 LuaOperationQueue *_operationQueue;
+
+                /**
+                 * 内存分配器
+                 */
+                LuaAllocator *_allocator;
+
+                /**
+                 * 字节码缓存
+                 */
+                LuaBytecodeCache *_bytecodeCache;
+
+                /**
+                 * 是否已安装字节码缓存搜索器，搜索器安装后不会移除，缓存置空时搜索器直接跳过
+                 */
+                bool _bytecodeSearcherInstalled;
                 
                 /**
-                 是否需要进行内存回收
+                 内存回收策略
                  */
-                bool _needGC;
+                LuaGCPolicy _gcPolicy;
+
+                /**
+                 增量回收每步的回收量（KB），0表示执行最小的一步
+                 */
+                int _gcStepSize;
                 
                 /**
                  是否激活
                  */
                 bool _isActive;
 
+                /**
+                 * 异常处理器在注册表中的引用
+                 */
+                int _errorHandlerRef;
+
+                /**
+                 * 是否在异常信息中附加调用栈信息
+                 */
+                bool _tracebackEnabled;
+
+                /**
+                 * 当前异步调用的错误信息接收对象，非异步调用时为NULL。
+                 * 由顶层调用根据pcall的结果写入，嵌套调用先于外层调用完成，其结果会被外层调用覆盖
+                 */
+                std::string *_asyncErrorMessage;
+
             public:
 
                 /**
@@ -89,6 +151,23 @@ namespace cn
                  */
                 LuaContext(std::string const& platform);
 
+                /**
+                 * 初始化上下文对象
+                 *
+                 * @param platform 平台类型：ios,android,unity3d
+                 * @param queueMode 操作队列模式，为LuaOperationQueueModeExecutor时上下文拥有独立的虚拟机线程，所有Lua操作均在该线程中执行
+                 */
+                LuaContext(std::string const& platform, LuaOperationQueueMode queueMode);
+
+                /**
+                 * 初始化上下文对象
+                 *
+                 * @param platform 平台类型：ios,android,unity3d
+                 * @param queueMode 操作队列模式
+                 * @param allocatorPolicy 内存分配策略
+                 */
+                LuaContext(std::string const& platform, LuaOperationQueueMode queueMode, LuaAllocatorPolicy allocatorPolicy);
+
                 /**
                  * 销毁上下文对象
                  */
@@ -131,12 +210,34 @@ namespace cn
                 void outputExceptionMessage(std::string const& message);
 
                 /**
-                 * 捕获异常信息
+                 * 捕获异常信息，将注册表中的异常处理器入栈，作为pcall的消息处理函数使用。
+                 * 需要在操作队列中调用，调用结束后需要将异常处理器出栈
                  *
                  * @return 异常捕获方法所在堆栈位置
                  */
                 int catchException();
 
+                /**
+                 * 记录异步调用的结果，供顶层调用在pcall完成后调用，调用失败时从栈顶读取错误信息
+                 *
+                 * @param success 调用是否成功
+                 */
+                void setAsyncCallResult(bool success);
+
+                /**
+                 * 设置是否在异常信息中附加调用栈信息，调用栈信息仅在产生异常时生成，默认不附加
+                 *
+                 * @param enabled true 表示附加，否则不附加
+                 */
+                void setTracebackEnabled(bool enabled);
+
+                /**
+                 * 是否在异常信息中附加调用栈信息
+                 *
+                 * @return true 表示附加，否则不附加
+                 */
+                bool isTracebackEnabled();
+
             public:
 
                 /**
@@ -181,6 +282,20 @@ namespace cn
                  */
                 void releaseValue(LuaValue *value);
 
+                /**
+                 * 批量保留Lua层的变量引用，在一次操作中完成所有变量的保留，效果与逐个调用retainValue相同。
+                 *
+                 * @param values 对应Lua层变量的原生对象Value列表
+                 */
+                void retainValues(LuaValueList const& values);
+
+                /**
+                 * 批量释放Lua层的变量引用，在一次操作中完成所有变量的释放，效果与逐个调用releaseValue相同。
+                 *
+                 * @param values 对应Lua层变量的原生对象Value列表
+                 */
+                void releaseValues(LuaValueList const& values);
+
                 /**
                  * 解析脚本
                  *
@@ -211,6 +326,97 @@ namespace cn
                  */
                 void registerMethod(std::string const& methodName, LuaMethodHandler handler);
 
+                /**
+                 * 注册快速方法，适用于被Lua频繁调用的方法。
+                 * 处理器保存在方法闭包中，调用时使用栈上的会话及参数视图，不进行方法查找及参数列表复制。
+                 *
+                 * @param methodName 方法名称
+                 * @param handler 方法处理
+                 */
+                void registerMethod(std::string const& methodName, LuaFastMethodHandler handler);
+
+            public:
+
+                /**
+                 * 异步解析脚本，完成处理器在操作队列中回调（加锁模式下在调用线程中同步完成）
+                 *
+                 * @param script 脚本内容
+                 * @param handler 完成处理器
+                 */
+                void evalScriptAsync(std::string const& script, LuaAsyncCompletionHandler handler);
+
+                /**
+                 * 异步解析脚本
+                 *
+                 * @param script 脚本内容
+                 *
+                 * @return 返回值的future，返回值需要调用者释放，执行出错时get会抛出std::runtime_error
+                 */
+                std::future<LuaValue*> evalScriptAsync(std::string const& script);
+
+                /**
+                 * 异步从lua文件中解析脚本
+                 *
+                 * @param path lua文件路径
+                 * @param handler 完成处理器
+                 */
+                void evalScriptFromFileAsync(std::string const& path, LuaAsyncCompletionHandler handler);
+
+                /**
+                 * 异步从lua文件中解析脚本
+                 *
+                 * @param path lua文件路径
+                 *
+                 * @return 返回值的future，返回值需要调用者释放，执行出错时get会抛出std::runtime_error
+                 */
+                std::future<LuaValue*> evalScriptFromFileAsync(std::string const& path);
+
+                /**
+                 * 异步调用方法，参数列表会被复制并持有至调用完成
+                 *
+                 * @param methodName 方法名称
+                 * @param arguments 参数列表
+                 * @param handler 完成处理器
+                 */
+                void callMethodAsync(std::string const& methodName, LuaArgumentList *arguments, LuaAsyncCompletionHandler handler);
+
+                /**
+                 * 异步调用方法，参数列表会被复制并持有至调用完成
+                 *
+                 * @param methodName 方法名称
+                 * @param arguments 参数列表
+                 *
+                 * @return 返回值的future，返回值需要调用者释放，执行出错时get会抛出std::runtime_error
+                 */
+                std::future<LuaValue*> callMethodAsync(std::string const& methodName, LuaArgumentList *arguments);
+
+                /**
+                 * 将操作投递到操作队列中异步执行。调用是否成功以最后完成的evalScript、evalScriptFromFile、callMethod或LuaFunction::invoke的结果为准，
+                 * 执行期间被处理的嵌套调用异常不会导致失败；操作抛出异常时以异常信息作为错误信息
+                 *
+                 * @param action 操作内容，返回操作结果
+                 * @param handler 完成处理器
+                 */
+                void performAsyncAction(std::function<LuaValue* (void)> const& action, LuaAsyncCompletionHandler handler);
+
+                /**
+                 * 将操作投递到操作队列中异步执行
+                 *
+                 * @param action 操作内容，返回操作结果
+                 *
+                 * @return 返回值的future，返回值需要调用者释放，执行出错时get会抛出std::runtime_error
+                 */
+                std::future<LuaValue*> performAsyncAction(std::function<LuaValue* (void)> const& action);
+
+                /**
+                 * 使用异步调用结果完成future
+                 *
+                 * @param promise 调用结果的promise
+                 * @param result 调用结果
+                 * @param error 错误信息，不为空时promise以std::runtime_error结束
+                 */
+                static void fulfillPromise(std::shared_ptr<std::promise<LuaValue*> > const& promise, LuaValue *result, std::string const& error);
+
             public:
                 
                 /**
@@ -248,7 +454,7 @@ namespace cn
                 LuaOperationQueue* getOperationQueue();
 
                 /**
-                 * 创建会话
+                 * 创建会话，优先从会话缓存池中取出会话进行复用
                  *
                  * @param state 状态
                  * @param lightweight 轻量级
@@ -257,12 +463,26 @@ namespace cn
                 LuaSession* makeSession(lua_State *state, bool lightweight);
 
                 /**
-                 * 销毁会话
+                 * 销毁会话，会话会被放回会话缓存池，调用后不能再使用该会话
                  *
                  * @param session 会话对象
                  */
                 void destorySession(LuaSession *session);
 
+                /**
+                 * 进入会话，会话对象由调用方创建及销毁（如在栈上创建），需要与leaveSession配对调用
+                 *
+                 * @param session 会话对象
+                 */
+                void enterSession(LuaSession *session);
+
+                /**
+                 * 离开会话，不会释放会话对象。离开非轻量级会话时会请求内存回收
+                 *
+                 * @param session 会话对象
+                 */
+                void leaveSession(LuaSession *session);
+
                 /**
                  * 获取主会话对象
                  *
@@ -278,14 +498,84 @@ namespace cn
                 LuaSession* getCurrentSession();
                 
                 /**
-                 内存回收
+                 设置内存回收策略，默认为LuaGCPolicyFullOnIdle
+
+                 @param policy 回收策略
+                 */
+                void setGCPolicy(LuaGCPolicy policy);
+
+                /**
+                 获取内存回收策略
+
+                 @return 回收策略
+                 */
+                LuaGCPolicy getGCPolicy();
+
+                /**
+                 设置增量回收每步的回收量，仅在LuaGCPolicyIncremental策略下有效
+
+                 @param stepSize 回收量（KB），0表示执行最小的一步
+                 */
+                void setGCStepSize(int stepSize);
+
+                /**
+                 设置Lua回收器的间歇率（对应LUA_GCSETPAUSE）
+
+                 @param pause 间歇率
+                 */
+                void setGCPause(int pause);
+
+                /**
+                 设置Lua回收器的步进倍率（对应LUA_GCSETSTEPMUL）
+
+                 @param stepMul 步进倍率
+                 */
+                void setGCStepMul(int stepMul);
+
+                /**
+                 设置内存上限，超出上限时Lua层会抛出内存不足错误
+
+                 @param limit 上限字节数，0表示不限制
+                 */
+                void setMemoryLimit(size_t limit);
+
+                /**
+                 获取内存统计信息
+
+                 @return 统计信息
+                 */
+                LuaMemoryStatistics getMemoryStatistics();
+
+                /**
+                 设置字节码缓存，设置后evalScriptFromFile及require加载的lua文件将使用缓存的字节码
+
+                 @param bytecodeCache 字节码缓存，可在多个上下文间共享
+                 */
+                void setBytecodeCache(LuaBytecodeCache *bytecodeCache);
+
+                /**
+                 获取字节码缓存
+
+                 @return 字节码缓存，未设置时返回NULL
+                 */
+                LuaBytecodeCache* getBytecodeCache();
+
+                /**
+                 内存回收，请求回收调度器按回收策略进行回收
                  */
                 void gc();
                 
                 /**
-                 进行内存回收，由定时器进行调用
+                 进行完整内存回收，由回收调度器进行调用
                  */
                 void gcHandler();
+
+                /**
+                 进行一步增量内存回收，由回收调度器进行调用
+
+                 @return true 表示已完成一轮回收，否则尚未完成
+                 */
+                bool gcStep();
             };
 
         }
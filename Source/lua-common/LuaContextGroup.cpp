@@ -0,0 +1,411 @@
+#include "LuaContextGroup.h"
+#include "LuaContext.h"
+#include "LuaValue.h"
+#include "LuaExportsTypeManager.hpp"
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+namespace cn {
+    namespace vimfung {
+        namespace luascriptcore {
+
+            /**
+             * 工作线程
+             */
+            struct LuaContextGroupWorker
+            {
+                /**
+                 * 所属上下文，仅在该工作线程中使用
+                 */
+                LuaContext *context;
+
+                /**
+                 * 线程
+                 */
+                std::thread thread;
+
+                /**
+                 * 可被其他工作线程窃取的任务队列，自身从队首取，窃取者从队尾取
+                 */
+                std::deque<LuaContextJob> jobs;
+                std::mutex jobsLock;
+
+                /**
+                 * 专属任务队列（亲和任务），同时保护空闲状态
+                 */
+                std::deque<LuaContextJob> pinnedJobs;
+                std::mutex lock;
+                std::condition_variable cond;
+                bool idle;
+
+                LuaContextGroupWorker()
+                    : context(NULL), idle(false)
+                {
+
+                }
+            };
+        }
+    }
+}
+
+using namespace cn::vimfung::luascriptcore;
+
+/**
+ * 当前线程所属的上下文组
+ */
+static thread_local LuaContextGroup *_currentGroup = NULL;
+
+/**
+ * 当前线程在上下文组中的工作线程索引
+ */
+static thread_local int _currentWorkerIndex = -1;
+
+LuaContextGroup::LuaContextGroup(std::string const& platform, int workerCount)
+    : LuaObject(), _pendingCount(0), _nextWorker(0), _stopping(false)
+{
+    _platform = platform;
+    _setupHandler = NULL;
+
+    if (workerCount <= 0)
+    {
+        workerCount = (int)std::thread::hardware_concurrency();
+        if (workerCount <= 0)
+        {
+            workerCount = 1;
+        }
+    }
+
+    for (int i = 0; i < workerCount; i++)
+    {
+        _workers.push_back(std::make_shared<LuaContextGroupWorker>());
+    }
+}
+
+LuaContextGroup::~LuaContextGroup()
+{
+    _stopping.store(true);
+
+    for (int i = 0; i < (int)_workers.size(); i++)
+    {
+        wakeup(i);
+    }
+
+    for (std::vector<std::shared_ptr<LuaContextGroupWorker> >::iterator it = _workers.begin(); it != _workers.end(); ++it)
+    {
+        LuaContextGroupWorker *worker = it -> get();
+        if (worker -> thread.joinable())
+        {
+            worker -> thread.join();
+        }
+
+        if (worker -> context != NULL)
+        {
+            worker -> context -> release();
+        }
+    }
+}
+
+void LuaContextGroup::onSetupContext(LuaContextHandler handler)
+{
+    _setupHandler = handler;
+}
+
+void LuaContextGroup::addExportsType(std::string const& typeName)
+{
+    _exportsTypes.push_back(typeName);
+}
+
+void LuaContextGroup::addPreloadScript(std::string const& script)
+{
+    _preloadScripts.push_back(script);
+}
+
+void LuaContextGroup::start()
+{
+    LuaContext *firstContext = NULL;
+
+    for (int i = 0; i < (int)_workers.size(); i++)
+    {
+        LuaContext *context = new LuaContext(_platform);
+        _workers[i] -> context = context;
+
+        if (_setupHandler != NULL)
+        {
+            _setupHandler(context);
+        }
+
+        if (firstContext == NULL)
+        {
+            firstContext = context;
+        }
+        else
+        {
+            //共享首个上下文中的类型描述。类型描述在注册完成后只读（重载决策表在添加方法时已编译，Lua中通过原型定义的属性由各上下文的类型管理器保存），可被多个工作线程同时使用
+            context -> getExportsTypeManager() -> importTypes(firstContext -> getExportsTypeManager());
+        }
+
+        //导出类型，getGlobal可以使类型自动导入
+        for (std::vector<std::string>::iterator it = _exportsTypes.begin(); it != _exportsTypes.end(); ++it)
+        {
+            LuaValue *value = context -> getGlobal(*it);
+            value -> release();
+        }
+
+        for (std::vector<std::string>::iterator it = _preloadScripts.begin(); it != _preloadScripts.end(); ++it)
+        {
+            LuaValue *value = context -> evalScript(*it);
+            value -> release();
+        }
+    }
+
+    for (int i = 0; i < (int)_workers.size(); i++)
+    {
+        _workers[i] -> thread = std::thread(&LuaContextGroup::run, this, i);
+    }
+}
+
+int LuaContextGroup::getWorkerCount()
+{
+    return (int)_workers.size();
+}
+
+LuaContext* LuaContextGroup::getContext(int index)
+{
+    if (index >= 0 && index < (int)_workers.size())
+    {
+        return _workers[index] -> context;
+    }
+
+    return NULL;
+}
+
+void LuaContextGroup::dispatch(LuaContextJob const& job)
+{
+    int index = 0;
+    if (_currentGroup == this)
+    {
+        //工作线程中提交的任务优先放入自身队列
+        index = _currentWorkerIndex;
+    }
+    else
+    {
+        index = (int)(_nextWorker.fetch_add(1) % _workers.size());
+    }
+
+    pushJob(index, job);
+}
+
+void LuaContextGroup::dispatch(std::string const& affinityKey, LuaContextJob const& job)
+{
+    int index = (int)(std::hash<std::string>()(affinityKey) % _workers.size());
+    pushPinnedJob(index, job);
+}
+
+void LuaContextGroup::callMethodAsync(std::string const& methodName, LuaArgumentList *arguments, LuaAsyncCompletionHandler handler)
+{
+    dispatch(makeCallMethodJob(methodName, arguments, handler));
+}
+
+std::future<LuaValue*> LuaContextGroup::callMethodAsync(std::string const& methodName, LuaArgumentList *arguments)
+{
+    std::shared_ptr<std::promise<LuaValue*> > promise = std::make_shared<std::promise<LuaValue*> >();
+    std::future<LuaValue*> future = promise -> get_future();
+
+    callMethodAsync(methodName, arguments, [promise](LuaValue *result, std::string const& error) {
+        LuaContext::fulfillPromise(promise, result, error);
+    });
+
+    return future;
+}
+
+void LuaContextGroup::callMethodAsync(std::string const& affinityKey, std::string const& methodName, LuaArgumentList *arguments, LuaAsyncCompletionHandler handler)
+{
+    dispatch(affinityKey, makeCallMethodJob(methodName, arguments, handler));
+}
+
+std::future<LuaValue*> LuaContextGroup::callMethodAsync(std::string const& affinityKey, std::string const& methodName, LuaArgumentList *arguments)
+{
+    std::shared_ptr<std::promise<LuaValue*> > promise = std::make_shared<std::promise<LuaValue*> >();
+    std::future<LuaValue*> future = promise -> get_future();
+
+    callMethodAsync(affinityKey, methodName, arguments, [promise](LuaValue *result, std::string const& error) {
+        LuaContext::fulfillPromise(promise, result, error);
+    });
+
+    return future;
+}
+
+LuaContextJob LuaContextGroup::makeCallMethodJob(std::string const& methodName, LuaArgumentList *arguments, LuaAsyncCompletionHandler handler)
+{
+    //复制并持有参数，调用完成后释放
+    LuaArgumentList args = *arguments;
+    for (LuaArgumentList::iterator it = args.begin(); it != args.end(); ++it)
+    {
+        (*it) -> retain();
+    }
+
+    return [methodName, args, handler](LuaContext *context) mutable {
+
+        //上下文为加锁模式，异步调用会在当前线程中同步完成
+        std::exception_ptr error;
+        try
+        {
+            context -> callMethodAsync(methodName, &args, handler);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        for (LuaArgumentList::iterator it = args.begin(); it != args.end(); ++it)
+        {
+            (*it) -> release();
+        }
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+
+    };
+}
+
+void LuaContextGroup::pushJob(int index, LuaContextJob const& job)
+{
+    LuaContextGroupWorker *worker = _workers[index].get();
+
+    {
+        std::lock_guard<std::mutex> lock(worker -> jobsLock);
+        worker -> jobs.push_back(job);
+    }
+    _pendingCount.fetch_add(1);
+
+    wakeup(index);
+
+    //目标工作线程忙碌时唤醒一个空闲的工作线程来窃取任务
+    for (int i = 0; i < (int)_workers.size(); i++)
+    {
+        if (i == index)
+        {
+            continue;
+        }
+
+        LuaContextGroupWorker *other = _workers[i].get();
+        std::lock_guard<std::mutex> lock(other -> lock);
+        if (other -> idle)
+        {
+            other -> cond.notify_one();
+            break;
+        }
+    }
+}
+
+void LuaContextGroup::pushPinnedJob(int index, LuaContextJob const& job)
+{
+    LuaContextGroupWorker *worker = _workers[index].get();
+
+    std::lock_guard<std::mutex> lock(worker -> lock);
+    worker -> pinnedJobs.push_back(job);
+    worker -> cond.notify_one();
+}
+
+bool LuaContextGroup::takeJob(int index, LuaContextJob &job)
+{
+    LuaContextGroupWorker *worker = _workers[index].get();
+
+    {
+        std::lock_guard<std::mutex> lock(worker -> lock);
+        if (!worker -> pinnedJobs.empty())
+        {
+            job.swap(worker -> pinnedJobs.front());
+            worker -> pinnedJobs.pop_front();
+            return true;
+        }
+    }
+
+    if (_pendingCount.load() <= 0)
+    {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(worker -> jobsLock);
+        if (!worker -> jobs.empty())
+        {
+            job.swap(worker -> jobs.front());
+            worker -> jobs.pop_front();
+            _pendingCount.fetch_sub(1);
+            return true;
+        }
+    }
+
+    //窃取其他工作线程的任务
+    int count = (int)_workers.size();
+    for (int i = 1; i < count; i++)
+    {
+        LuaContextGroupWorker *victim = _workers[(index + i) % count].get();
+
+        std::lock_guard<std::mutex> lock(victim -> jobsLock);
+        if (!victim -> jobs.empty())
+        {
+            job.swap(victim -> jobs.back());
+            victim -> jobs.pop_back();
+            _pendingCount.fetch_sub(1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void LuaContextGroup::wakeup(int index)
+{
+    LuaContextGroupWorker *worker = _workers[index].get();
+
+    std::lock_guard<std::mutex> lock(worker -> lock);
+    worker -> cond.notify_one();
+}
+
+void LuaContextGroup::run(int index)
+{
+    _currentGroup = this;
+    _currentWorkerIndex = index;
+
+    LuaContextGroupWorker *worker = _workers[index].get();
+    LuaContextJob job;
+
+    for (;;)
+    {
+        if (takeJob(index, job))
+        {
+            try
+            {
+                job(worker -> context);
+            }
+            catch (...)
+            {
+                //任务没有等待者，异常在此处丢弃
+            }
+
+            job = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(worker -> lock);
+        if (_stopping.load() && worker -> pinnedJobs.empty() && _pendingCount.load() <= 0)
+        {
+            break;
+        }
+
+        worker -> idle = true;
+        worker -> cond.wait(lock, [this, worker]() {
+            return _stopping.load() || !worker -> pinnedJobs.empty() || _pendingCount.load() > 0;
+        });
+        worker -> idle = false;
+    }
+
+    _currentGroup = NULL;
+    _currentWorkerIndex = -1;
+}
@@ -0,0 +1,246 @@
+#ifndef ANDROID_LUACONTEXTGROUP_H
+#define ANDROID_LUACONTEXTGROUP_H
+
+#include "LuaObject.h"
+#include "LuaDefined.h"
+#include <functional>
+#include <future>
+#include <memory>
+#include <atomic>
+
+namespace cn {
+    namespace vimfung {
+        namespace luascriptcore {
+
+            class LuaContext;
+            struct LuaContextGroupWorker;
+
+            /**
+             * 上下文任务
+             */
+            typedef std::function<void (LuaContext *context)> LuaContextJob;
+
+            /**
+             * 上下文组，维护N个上下文并分别绑定到N个工作线程中执行任务。
+             * 未指定亲和键的任务可被空闲的工作线程窃取执行；指定亲和键的任务始终在同一个工作线程（上下文）中执行。
+             * 组内上下文共享同一套导出类型描述。
+             */
+            class LuaContextGroup : public LuaObject
+            {
+            public:
+
+                /**
+                 * 初始化上下文组
+                 *
+                 * @param platform 平台类型：ios,android,unity3d
+                 * @param workerCount 工作线程数量，小于等于0时使用硬件并发数
+                 */
+                LuaContextGroup(std::string const& platform, int workerCount);
+
+                /**
+                 * 销毁上下文组，等待已提交的任务执行完毕后结束工作线程
+                 */
+                ~LuaContextGroup();
+
+            public:
+
+                /**
+                 * 上下文创建时触发，可在此注册方法、设置异常处理器及导出类型处理器等，需要在start之前设置。
+                 *
+                 * @param handler 事件处理器
+                 */
+                void onSetupContext(LuaContextHandler handler);
+
+                /**
+                 * 添加预导出类型，类型只在首个上下文中创建，其余上下文共享其类型描述
+                 *
+                 * @param typeName 类型名称
+                 */
+                void addExportsType(std::string const& typeName);
+
+                /**
+                 * 添加预加载脚本，每个上下文创建时执行
+                 *
+                 * @param script 脚本内容
+                 */
+                void addPreloadScript(std::string const& script);
+
+                /**
+                 * 创建上下文并启动工作线程
+                 */
+                void start();
+
+                /**
+                 * 获取工作线程数量
+                 *
+                 * @return 工作线程数量
+                 */
+                int getWorkerCount();
+
+                /**
+                 * 获取指定工作线程所属的上下文，只能在该工作线程的任务中访问
+                 *
+                 * @param index 工作线程索引
+                 *
+                 * @return 上下文对象
+                 */
+                LuaContext* getContext(int index);
+
+            public:
+
+                /**
+                 * 提交任务，任务可能在任意工作线程中执行
+                 *
+                 * @param job 任务
+                 */
+                void dispatch(LuaContextJob const& job);
+
+                /**
+                 * 提交任务，相同亲和键的任务始终在同一工作线程中执行
+                 *
+                 * @param affinityKey 亲和键
+                 * @param job 任务
+                 */
+                void dispatch(std::string const& affinityKey, LuaContextJob const& job);
+
+                /**
+                 * 调用方法，参数列表会被复制并持有至调用完成
+                 *
+                 * @param methodName 方法名称
+                 * @param arguments 参数列表
+                 * @param handler 完成处理器，在工作线程中回调
+                 */
+                void callMethodAsync(std::string const& methodName, LuaArgumentList *arguments, LuaAsyncCompletionHandler handler);
+
+                /**
+                 * 调用方法，参数列表会被复制并持有至调用完成
+                 *
+                 * @param methodName 方法名称
+                 * @param arguments 参数列表
+                 *
+                 * @return 返回值的future，返回值需要调用者释放，执行出错时get会抛出std::runtime_error
+                 */
+                std::future<LuaValue*> callMethodAsync(std::string const& methodName, LuaArgumentList *arguments);
+
+                /**
+                 * 在亲和键对应的上下文中调用方法，参数列表会被复制并持有至调用完成
+                 *
+                 * @param affinityKey 亲和键
+                 * @param methodName 方法名称
+                 * @param arguments 参数列表
+                 * @param handler 完成处理器，在工作线程中回调
+                 */
+                void callMethodAsync(std::string const& affinityKey, std::string const& methodName, LuaArgumentList *arguments, LuaAsyncCompletionHandler handler);
+
+                /**
+                 * 在亲和键对应的上下文中调用方法，参数列表会被复制并持有至调用完成
+                 *
+                 * @param affinityKey 亲和键
+                 * @param methodName 方法名称
+                 * @param arguments 参数列表
+                 *
+                 * @return 返回值的future，返回值需要调用者释放，执行出错时get会抛出std::runtime_error
+                 */
+                std::future<LuaValue*> callMethodAsync(std::string const& affinityKey, std::string const& methodName, LuaArgumentList *arguments);
+
+            private:
+
+                /**
+                 * 将任务放入工作线程的可窃取队列
+                 *
+                 * @param index 工作线程索引
+                 * @param job 任务
+                 */
+                void pushJob(int index, LuaContextJob const& job);
+
+                /**
+                 * 将任务放入工作线程的专属队列
+                 *
+                 * @param index 工作线程索引
+                 * @param job 任务
+                 */
+                void pushPinnedJob(int index, LuaContextJob const& job);
+
+                /**
+                 * 获取任务，优先级：专属队列、自身队列、窃取其他工作线程队列
+                 *
+                 * @param index 工作线程索引
+                 * @param job 任务
+                 *
+                 * @return true 表示获取到任务，否则没有可执行任务
+                 */
+                bool takeJob(int index, LuaContextJob &job);
+
+                /**
+                 * 唤醒工作线程
+                 *
+                 * @param index 工作线程索引
+                 */
+                void wakeup(int index);
+
+                /**
+                 * 创建方法调用任务
+                 *
+                 * @param methodName 方法名称
+                 * @param arguments 参数列表
+                 * @param handler 完成处理器
+                 *
+                 * @return 任务
+                 */
+                static LuaContextJob makeCallMethodJob(std::string const& methodName, LuaArgumentList *arguments, LuaAsyncCompletionHandler handler);
+
+                /**
+                 * 工作线程入口
+                 *
+                 * @param index 工作线程索引
+                 */
+                void run(int index);
+
+            private:
+
+                /**
+                 * 平台类型
+                 */
+                std::string _platform;
+
+                /**
+                 * 初始化处理器
+                 */
+                LuaContextHandler _setupHandler;
+
+                /**
+                 * 预导出类型列表
+                 */
+                std::vector<std::string> _exportsTypes;
+
+                /**
+                 * 预加载脚本列表
+                 */
+                std::vector<std::string> _preloadScripts;
+
+                /**
+                 * 工作线程列表
+                 */
+                std::vector<std::shared_ptr<LuaContextGroupWorker> > _workers;
+
+                /**
+                 * 可窃取的待执行任务数量
+                 */
+                std::atomic<int> _pendingCount;
+
+                /**
+                 * 下一个接收任务的工作线程，用于轮询分配
+                 */
+                std::atomic<unsigned int> _nextWorker;
+
+                /**
+                 * 是否正在停止
+                 */
+                std::atomic<bool> _stopping;
+            };
+        }
+    }
+}
+
+
+#endif //ANDROID_LUACONTEXTGROUP_H
@@ -0,0 +1,244 @@
+#include "LuaContextPool.h"
+#include "LuaContext.h"
+#include "LuaValue.h"
+#include "LuaSession.h"
+#include "LuaDataExchanger.h"
+#include "LuaEngineAdapter.hpp"
+#include "LuaOperationQueue.h"
+
+using namespace cn::vimfung::luascriptcore;
+
+/**
+ * 导出类型关联本地类型的字段名称
+ */
+static const char * NativeTypeFieldName = "_nativeType";
+
+LuaContextPool::LuaContextPool(std::string const& platform, int size)
+    : LuaContextPool(platform, LuaOperationQueueModeLock, size)
+{
+
+}
+
+LuaContextPool::LuaContextPool(std::string const& platform, LuaOperationQueueMode queueMode, int size)
+    : LuaObject()
+{
+    _platform = platform;
+    _queueMode = queueMode;
+    _size = size;
+    _setupHandler = NULL;
+    _resetHandler = NULL;
+}
+
+LuaContextPool::~LuaContextPool()
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    for (std::deque<LuaContext *>::iterator it = _idleContexts.begin(); it != _idleContexts.end(); ++it)
+    {
+        (*it) -> release();
+    }
+    _idleContexts.clear();
+}
+
+void LuaContextPool::onSetupContext(LuaContextHandler handler)
+{
+    _setupHandler = handler;
+}
+
+void LuaContextPool::onResetContext(LuaContextHandler handler)
+{
+    _resetHandler = handler;
+}
+
+void LuaContextPool::addExportsType(std::string const& typeName)
+{
+    _exportsTypes.push_back(typeName);
+}
+
+void LuaContextPool::addPreloadScript(std::string const& script)
+{
+    _preloadScripts.push_back(script);
+}
+
+void LuaContextPool::addPreloadScriptFile(std::string const& path)
+{
+    _preloadScriptFiles.push_back(path);
+}
+
+void LuaContextPool::prepare()
+{
+    while (idleCount() < _size)
+    {
+        LuaContext *context = createContext();
+
+        std::lock_guard<std::mutex> lock(_lock);
+        _idleContexts.push_back(context);
+    }
+}
+
+LuaContext* LuaContextPool::acquire()
+{
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (!_idleContexts.empty())
+        {
+            LuaContext *context = _idleContexts.front();
+            _idleContexts.pop_front();
+
+            return context;
+        }
+    }
+
+    return createContext();
+}
+
+void LuaContextPool::recycle(LuaContext *context)
+{
+    if (context == NULL)
+    {
+        return;
+    }
+
+    resetContext(context);
+
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if ((int)_idleContexts.size() < _size)
+        {
+            _idleContexts.push_back(context);
+            return;
+        }
+    }
+
+    //池已满，释放上下文
+    context -> release();
+}
+
+int LuaContextPool::idleCount()
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    return (int)_idleContexts.size();
+}
+
+LuaContext* LuaContextPool::createContext()
+{
+    LuaContext *context = new LuaContext(_platform, _queueMode);
+
+    if (_setupHandler != NULL)
+    {
+        _setupHandler(context);
+    }
+
+    //导出类型，getGlobal可以使类型自动导入
+    for (std::vector<std::string>::iterator it = _exportsTypes.begin(); it != _exportsTypes.end(); ++it)
+    {
+        LuaValue *value = context -> getGlobal(*it);
+        value -> release();
+    }
+
+    //执行预加载脚本
+    for (std::vector<std::string>::iterator it = _preloadScripts.begin(); it != _preloadScripts.end(); ++it)
+    {
+        LuaValue *value = context -> evalScript(*it);
+        value -> release();
+    }
+
+    for (std::vector<std::string>::iterator it = _preloadScriptFiles.begin(); it != _preloadScriptFiles.end(); ++it)
+    {
+        LuaValue *value = context -> evalScriptFromFile(*it);
+        value -> release();
+    }
+
+    //记录初始化后的全局变量，所有上下文初始化过程相同，因此只需记录一次
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_baselineGlobals.empty())
+    {
+        getGlobalNames(context, _baselineGlobals);
+    }
+
+    return context;
+}
+
+void LuaContextPool::resetContext(LuaContext *context)
+{
+    if (_resetHandler != NULL)
+    {
+        _resetHandler(context);
+    }
+
+    context -> getOperationQueue() -> performAction([this, context](){
+
+        lua_State *state = context -> getCurrentSession() -> getState();
+
+        //查找初始化后新增的全局变量，导出类型需要保留
+        std::vector<std::string> removeNames;
+
+        LuaEngineAdapter::getGlobal(state, "_G");
+        LuaEngineAdapter::pushNil(state);
+        while (LuaEngineAdapter::next(state, -2))
+        {
+            if (LuaEngineAdapter::type(state, -2) == LUA_TSTRING)
+            {
+                std::string name = LuaEngineAdapter::toString(state, -2);
+                if (_baselineGlobals.find(name) == _baselineGlobals.end())
+                {
+                    bool isExportType = false;
+                    if (LuaEngineAdapter::isTable(state, -1))
+                    {
+                        LuaEngineAdapter::pushString(state, NativeTypeFieldName);
+                        LuaEngineAdapter::rawGet(state, -2);
+                        isExportType = LuaEngineAdapter::type(state, -1) == LUA_TLIGHTUSERDATA;
+                        LuaEngineAdapter::pop(state, 1);
+                    }
+
+                    if (!isExportType)
+                    {
+                        removeNames.push_back(name);
+                    }
+                }
+            }
+
+            //弹出值，保留key用于下次遍历
+            LuaEngineAdapter::pop(state, 1);
+        }
+
+        for (std::vector<std::string>::iterator it = removeNames.begin(); it != removeNames.end(); ++it)
+        {
+            LuaEngineAdapter::pushString(state, it -> c_str());
+            LuaEngineAdapter::pushNil(state);
+            LuaEngineAdapter::rawSet(state, -3);
+        }
+
+        //弹出_G
+        LuaEngineAdapter::pop(state, 1);
+
+        context -> getDataExchanger() -> reset();
+
+        LuaEngineAdapter::GC(state, LUA_GCCOLLECT, 0);
+
+    });
+}
+
+void LuaContextPool::getGlobalNames(LuaContext *context, std::set<std::string> &names)
+{
+    context -> getOperationQueue() -> performAction([context, &names](){
+
+        lua_State *state = context -> getCurrentSession() -> getState();
+
+        LuaEngineAdapter::getGlobal(state, "_G");
+        LuaEngineAdapter::pushNil(state);
+        while (LuaEngineAdapter::next(state, -2))
+        {
+            if (LuaEngineAdapter::type(state, -2) == LUA_TSTRING)
+            {
+                names.insert(LuaEngineAdapter::toString(state, -2));
+            }
+
+            LuaEngineAdapter::pop(state, 1);
+        }
+
+        //弹出_G
+        LuaEngineAdapter::pop(state, 1);
+
+    });
+}
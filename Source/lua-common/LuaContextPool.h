@@ -0,0 +1,195 @@
+#ifndef ANDROID_LUACONTEXTPOOL_H
+#define ANDROID_LUACONTEXTPOOL_H
+
+#include "LuaObject.h"
+#include "LuaDefined.h"
+#include <mutex>
+#include <set>
+
+namespace cn {
+    namespace vimfung {
+        namespace luascriptcore {
+
+            class LuaContext;
+
+            /**
+             * 上下文池，维护一组已完成初始化（导出类型、预加载脚本）的上下文对象，
+             * 用于短时任务中复用上下文，避免每次创建上下文的开销。
+             */
+            class LuaContextPool : public LuaObject
+            {
+            public:
+
+                /**
+                 * 初始化上下文池
+                 *
+                 * @param platform 平台类型：ios,android,unity3d
+                 * @param size 池中保持的空闲上下文数量
+                 */
+                LuaContextPool(std::string const& platform, int size);
+
+                /**
+                 * 初始化上下文池
+                 *
+                 * @param platform 平台类型：ios,android,unity3d
+                 * @param queueMode 池中上下文的操作队列模式
+                 * @param size 池中保持的空闲上下文数量
+                 */
+                LuaContextPool(std::string const& platform, LuaOperationQueueMode queueMode, int size);
+
+                /**
+                 * 销毁上下文池，释放所有空闲上下文
+                 */
+                ~LuaContextPool();
+
+            public:
+
+                /**
+                 * 上下文创建时触发，可在此注册方法、设置异常处理器及导出类型处理器等，在导出类型与预加载脚本之前调用。
+                 *
+                 * @param handler 事件处理器
+                 */
+                void onSetupContext(LuaContextHandler handler);
+
+                /**
+                 * 上下文回收时触发，可在此清理业务相关状态，在池内置的重置操作之前调用。
+                 *
+                 * @param handler 事件处理器
+                 */
+                void onResetContext(LuaContextHandler handler);
+
+                /**
+                 * 添加预导出类型，上下文创建时即导出该类型
+                 *
+                 * @param typeName 类型名称
+                 */
+                void addExportsType(std::string const& typeName);
+
+                /**
+                 * 添加预加载脚本，上下文创建时执行
+                 *
+                 * @param script 脚本内容
+                 */
+                void addPreloadScript(std::string const& script);
+
+                /**
+                 * 添加预加载脚本文件，上下文创建时执行
+                 *
+                 * @param path lua文件路径
+                 */
+                void addPreloadScriptFile(std::string const& path);
+
+                /**
+                 * 预热上下文池，创建上下文直至空闲数量达到池大小
+                 */
+                void prepare();
+
+                /**
+                 * 获取上下文，池为空时将创建新的上下文。使用完毕后需要调用recycle归还。
+                 *
+                 * @return 上下文对象
+                 */
+                LuaContext* acquire();
+
+                /**
+                 * 归还上下文，上下文会被重置后放回池中，池已满时释放该上下文。
+                 * 注：归还前应释放所有从该上下文中获取的Lua对象（如LuaFunction），重置后这些对象将失效。
+                 *
+                 * @param context 上下文对象
+                 */
+                void recycle(LuaContext *context);
+
+                /**
+                 * 获取空闲上下文数量
+                 *
+                 * @return 空闲数量
+                 */
+                int idleCount();
+
+            private:
+
+                /**
+                 * 创建并初始化上下文
+                 *
+                 * @return 上下文对象
+                 */
+                LuaContext* createContext();
+
+                /**
+                 * 重置上下文，移除初始化后新增的全局变量并清空数据交换层
+                 *
+                 * @param context 上下文对象
+                 */
+                void resetContext(LuaContext *context);
+
+                /**
+                 * 获取全局变量名称集合
+                 *
+                 * @param context 上下文对象
+                 * @param names 名称集合
+                 */
+                void getGlobalNames(LuaContext *context, std::set<std::string> &names);
+
+            private:
+
+                /**
+                 * 平台类型
+                 */
+                std::string _platform;
+
+                /**
+                 * 操作队列模式
+                 */
+                LuaOperationQueueMode _queueMode;
+
+                /**
+                 * 池大小
+                 */
+                int _size;
+
+                /**
+                 * 初始化处理器
+                 */
+                LuaContextHandler _setupHandler;
+
+                /**
+                 * 重置处理器
+                 */
+                LuaContextHandler _resetHandler;
+
+                /**
+                 * 预导出类型列表
+                 */
+                std::vector<std::string> _exportsTypes;
+
+                /**
+                 * 预加载脚本列表
+                 */
+                std::vector<std::string> _preloadScripts;
+
+                /**
+                 * 预加载脚本文件列表
+                 */
+                std::vector<std::string> _preloadScriptFiles;
+
+                /**
+                 * 初始化完成后的全局变量名称，重置时保留
+                 */
+                std::set<std::string> _baselineGlobals;
+
+                /**
+                 * 空闲上下文
+                 */
+                std::deque<LuaContext *> _idleContexts;
+
+                /**
+                 * 锁
+                 */
+                std::mutex _lock;
+            };
+        }
+    }
+}
+
+
+#endif //ANDROID_LUACONTEXTPOOL_H
@@ -16,26 +16,18 @@
 #include "LuaEngineAdapter.hpp"
 #include "LuaExportTypeDescriptor.hpp"
 #include "LuaOperationQueue.h"
+#include "LuaTableValue.hpp"
 #include <iostream>
-#include <sstream>
 #include <cstring>
 
 using namespace cn::vimfung::luascriptcore;
 
-/**
- 记录导入原生层的Lua引用变量表名称
- */
-static const char * VarsTableName = "_vars_";
-
-/**
- 记录保留的Lua对象变量表名称
- */
-static const char * RetainVarsTableName = "_retainVars_";
-
-
 LuaDataExchanger::LuaDataExchanger(LuaContext *context)
 {
     _context = context;
+    _varsTableRef = LUA_NOREF;
+    _retainVarsTableRef = LUA_NOREF;
+    _hasPendingClear = false;
 }
 
 LuaValue* LuaDataExchanger::getValue(int stackIndex)
@@ -47,7 +39,7 @@ LuaValue* LuaDataExchanger::getValue(int stackIndex)
         lua_State *state = _context -> getCurrentSession() -> getState();
         stackIndex = LuaEngineAdapter::absIndex(state, stackIndex);
 
-        std::string objectId;
+        int linkId = 0;
 
         int type = LuaEngineAdapter::type(state, stackIndex);
 
@@ -81,7 +73,7 @@ LuaValue* LuaDataExchanger::getValue(int stackIndex)
                 else
                 {
                     //为字符串
-                    value = LuaValue::StringValue(bytes);
+                    value = LuaValue::StringValue(bytes, len);
                 }
 
                 break;
@@ -103,77 +95,8 @@ LuaValue* LuaDataExchanger::getValue(int stackIndex)
                     //出栈前一结果
                     LuaEngineAdapter::pop(state, 1);
 
-                    LuaValueMap dictValue;
-                    LuaValueList arrayValue;
-                    bool isArray = true;
-
-                    LuaEngineAdapter::pushNil(state);
-                    while (LuaEngineAdapter::next(state, stackIndex))
-                    {
-                        LuaValue *item = getValue(-1);
-                        LuaValue *key = getValue(-2);
-
-                        if (isArray)
-                        {
-                            if (key -> getType() != LuaValueTypeNumber)
-                            {
-                                //非数组对象，释放数组
-                                isArray = false;
-                            }
-                            else if (key -> getType() == LuaValueTypeNumber)
-                            {
-                                int arrayIndex = (int)key->toNumber();
-                                if (arrayIndex <= 0)
-                                {
-                                    //非数组对象，释放数组
-                                    isArray = false;
-                                }
-                                else if (arrayIndex - 1 != arrayValue.size())
-                                {
-                                    //非数组对象，释放数组
-                                    isArray = false;
-                                }
-                                else
-                                {
-                                    arrayValue.push_back(item);
-                                }
-                            }
-                        }
-
-                        switch (key -> getType())
-                        {
-                            case LuaValueTypeNumber:
-                            {
-                                std::ostringstream out;
-                                out << key->toNumber();
-                                dictValue[out.str()] = item;
-                                break;
-                            }
-                            case LuaValueTypeString:
-                                dictValue[key->toString()] = item;
-                                break;
-                            default:
-                                if (!isArray)
-                                {
-                                    //如果并非是数组而且key也不是指定类型，则对item进行释放，避免造成内存泄露
-                                    item -> release();
-                                }
-                                break;
-                        }
-
-                        key->release();
-
-                        LuaEngineAdapter::pop(state, 1);
-                    }
-
-                    if (isArray)
-                    {
-                        value = LuaValue::ArrayValue(arrayValue);
-                    }
-                    else
-                    {
-                        value = LuaValue::DictonaryValue(dictValue);
-                    }
+                    //表数据在访问时才进行转换
+                    value = new LuaTableValue(_context, stackIndex);
                 }
 
                 break;
@@ -185,24 +108,27 @@ LuaValue* LuaDataExchanger::getValue(int stackIndex)
                 value = LuaValue::PointerValue(pointer);
                 pointer -> release();
 
-                objectId = pointer -> getExchangeId();
+                linkId = pointer -> getLinkId();
                 break;
             }
             case LUA_TUSERDATA:
             {
                 LuaUserdataRef userdataRef = (LuaUserdataRef)LuaEngineAdapter::toUserdata(state, stackIndex);
                 void *obj = userdataRef -> value;
-                value = LuaValue::ObjectValue((LuaObjectDescriptor *)obj);
+                LuaObjectDescriptor *objectDescriptor = (LuaObjectDescriptor *)obj;
+                value = LuaValue::ObjectValue(objectDescriptor);
 
-                objectId = ((LuaObjectDescriptor *)obj) -> getExchangeId();
+                if (objectDescriptor -> getContext() == _context)
+                {
+                    linkId = objectDescriptor -> getLinkId();
+                }
                 break;
             }
             case LUA_TFUNCTION:
             {
+                //方法对象在创建时已放入_vars_表中
                 LuaFunction *func = new LuaFunction(_context, stackIndex);
                 value = LuaValue::FunctionValue(func);
-
-                objectId = func -> getExchangeId();
                 break;
             }
             default:
@@ -213,15 +139,15 @@ LuaValue* LuaDataExchanger::getValue(int stackIndex)
             }
         }
 
-        if (!objectId.empty() && (type == LUA_TTABLE || type == LUA_TUSERDATA || type == LUA_TLIGHTUSERDATA || type == LUA_TFUNCTION))
+        if (linkId != 0)
         {
             //将引用对象放入表中
-            beginGetVarsTable();
+            pushVarsTable();
 
             LuaEngineAdapter::pushValue(state, stackIndex);
-            LuaEngineAdapter::setField(state, -2, objectId.c_str());
+            LuaEngineAdapter::rawSetI(state, -2, linkId);
 
-            endGetVarsTable();
+            LuaEngineAdapter::pop(state, 1);
         }
 
     });
@@ -263,6 +189,38 @@ void LuaDataExchanger::pushStack(LuaValue *value)
                 pushStackByTable(value -> toMap());
                 break;
             }
+            case LuaValueTypeNumberArray:
+            {
+                LuaNumberArray *list = value -> toNumberArray();
+
+                LuaEngineAdapter::createTable(state, (int)list -> size(), 0);
+
+                int index = 1;
+                for (LuaNumberArray::iterator it = list -> begin(); it != list -> end(); ++it)
+                {
+                    LuaEngineAdapter::pushNumber(state, *it);
+                    LuaEngineAdapter::rawSetI(state, -2, index);
+
+                    index ++;
+                }
+                break;
+            }
+            case LuaValueTypeIntegerArray:
+            {
+                LuaIntegerArray *list = value -> toIntegerArray();
+
+                LuaEngineAdapter::createTable(state, (int)list -> size(), 0);
+
+                int index = 1;
+                for (LuaIntegerArray::iterator it = list -> begin(); it != list -> end(); ++it)
+                {
+                    LuaEngineAdapter::pushInteger(state, *it);
+                    LuaEngineAdapter::rawSetI(state, -2, index);
+
+                    index ++;
+                }
+                break;
+            }
             case LuaValueTypeData:
             {
                 const char *data = value -> toData();
@@ -301,73 +259,48 @@ void LuaDataExchanger::getLuaObject(LuaObject *object)
 {
     if (object)
     {
-        std::string linkId;
+        LuaManagedObject *managedObject = getManagedObject(object);
 
-        LuaValue *value = dynamic_cast<LuaValue *>(object);
-        LuaManagedObject *managedObject = dynamic_cast<LuaManagedObject *>(object);
-        if (value != NULL)
-        {
-            switch (value -> getType())
-            {
-                case LuaValueTypeObject:
-                    getLuaObject(value -> toObject());
-                    break;
-                case LuaValueTypePtr:
-                    getLuaObject(value -> toPointer());
-                    break;
-                case LuaValueTypeFunction:
-                    getLuaObject(value -> toFunction());
-                    break;
-                default:
-                    break;
-            }
-        }
-        else if (managedObject != NULL)
-        {
-            linkId = managedObject -> getExchangeId();
-        }
-        else
-        {
-            linkId = StringUtils::format("%p", object);
-        }
+        _context -> getOperationQueue() -> performAction([this, managedObject](){
 
-        if (!linkId.empty())
-        {
-
-            beginGetVarsTable();
-
-            _context -> getOperationQueue() -> performAction([this, linkId](){
+            lua_State *state = _context -> getCurrentSession() -> getState();
 
-                lua_State *state = _context -> getCurrentSession() -> getState();
+            if (managedObject != NULL && managedObject -> hasLinkId())
+            {
+                pushVarsTable();
 
-                LuaEngineAdapter::getField(state, -1, linkId.c_str());
+                LuaEngineAdapter::rawGetI(state, -1, managedObject -> getLinkId());
 
-                //将值放入_G之前，目的为了让doActionInVarsTable将_vars_和_G出栈，而不影响该变量值入栈回传Lua
-                LuaEngineAdapter::insert(state, -3);
+                //将值放入_vars_之前，使_vars_出栈后该变量值保留在栈顶回传Lua
+                LuaEngineAdapter::insert(state, -2);
 
-            });
+                LuaEngineAdapter::pop(state, 1);
+            }
+            else
+            {
+                //对象从未传入Lua，不存在对应引用
+                LuaEngineAdapter::pushNil(state);
+            }
 
-            
-            endGetVarsTable();
-        }
+        });
     }
 }
 
-void LuaDataExchanger::setLuaObject(int stackIndex, std::string const& linkId)
+void LuaDataExchanger::setLuaObject(int stackIndex, int linkId)
 {
-    _context -> getOperationQueue() -> performAction([this, &stackIndex, &linkId](){
+    _context -> getOperationQueue() -> performAction([this, &stackIndex, linkId](){
 
         lua_State *state = _context -> getCurrentSession() -> getState();
 
         stackIndex = LuaEngineAdapter::absIndex(state, stackIndex);
 
-        beginGetVarsTable();
+        pushVarsTable();
 
         //放入对象到_vars_表中
         LuaEngineAdapter::pushValue(state, stackIndex);
-        LuaEngineAdapter::setField(state, -2, linkId.c_str());
+        LuaEngineAdapter::rawSetI(state, -2, linkId);
 
-        endGetVarsTable();
+        LuaEngineAdapter::pop(state, 1);
 
     });
 }
@@ -376,38 +309,11 @@ void LuaDataExchanger::retainLuaObject(LuaObject *object)
 {
     if (object != NULL)
     {
-        std::string linkId;
-
-        LuaValue *value = dynamic_cast<LuaValue *>(object);
-        LuaManagedObject *managedObject = dynamic_cast<LuaManagedObject *>(object);
-
-        if (value != NULL)
-        {
-            switch (value -> getType())
-            {
-                case LuaValueTypeObject:
-                    retainLuaObject(value -> toObject());
-                    return;
-                case LuaValueTypePtr:
-                    retainLuaObject(value -> toPointer());
-                    return;
-                case LuaValueTypeFunction:
-                    retainLuaObject(value -> toFunction());
-                    return;
-                default:
-                    break;
-            }
-        }
-        else if (managedObject != NULL)
-        {
-            linkId = managedObject -> getExchangeId();
-        }
-        else
+        LuaManagedObject *managedObject = getManagedObject(object);
+        if (managedObject != NULL && managedObject -> hasLinkId())
         {
-            linkId = StringUtils::format("%p", object);
+            doObjectAction(managedObject -> getLinkId(), LuaObjectActionRetain);
         }
-
-        doObjectAction(linkId, LuaObjectActionRetain);
     }
 }
 
@@ -415,92 +321,145 @@ void LuaDataExchanger::releaseLuaObject(LuaObject *object)
 {
     if (object != NULL)
     {
-        std::string linkId;
+        LuaManagedObject *managedObject = getManagedObject(object);
+        if (managedObject != NULL && managedObject -> hasLinkId())
+        {
+            doObjectAction(managedObject -> getLinkId(), LuaObjectActionRelease);
+        }
+    }
+}
 
-        LuaValue *value = dynamic_cast<LuaValue *>(object);
-        LuaManagedObject *managedObject = dynamic_cast<LuaManagedObject *>(object);
+void LuaDataExchanger::retainLuaObjects(LuaValueList const& values)
+{
+    //在一次操作中完成所有对象的保留
+    _context -> getOperationQueue() -> performAction([this, &values](){
 
-        if (value != NULL)
+        for (LuaValueList::const_iterator it = values.begin(); it != values.end(); ++it)
         {
-            switch (value -> getType())
-            {
-                case LuaValueTypeObject:
-                    releaseLuaObject(value -> toObject());
-                    return;
-                case LuaValueTypePtr:
-                    releaseLuaObject(value -> toPointer());
-                    return;
-                case LuaValueTypeFunction:
-                    releaseLuaObject(value -> toFunction());
-                    return;
-                default:
-                    break;
-            }
+            retainLuaObject(*it);
         }
-        else if (managedObject != NULL)
+
+    });
+}
+
+void LuaDataExchanger::releaseLuaObjects(LuaValueList const& values)
+{
+    //在一次操作中完成所有对象的释放
+    _context -> getOperationQueue() -> performAction([this, &values](){
+
+        for (LuaValueList::const_iterator it = values.begin(); it != values.end(); ++it)
         {
-            linkId = managedObject -> getExchangeId();
+            releaseLuaObject(*it);
         }
-        else
+
+    });
+}
+
+LuaManagedObject* LuaDataExchanger::getManagedObject(LuaObject *object)
+{
+    LuaManagedObject *managedObject = NULL;
+
+    LuaValue *value = dynamic_cast<LuaValue *>(object);
+    if (value != NULL)
+    {
+        switch (value -> getType())
         {
-            linkId = StringUtils::format("%p", object);
+            case LuaValueTypeObject:
+                managedObject = value -> toObject();
+                break;
+            case LuaValueTypePtr:
+                managedObject = value -> toPointer();
+                break;
+            case LuaValueTypeFunction:
+                managedObject = value -> toFunction();
+                break;
+            default:
+                break;
         }
+    }
+    else
+    {
+        managedObject = dynamic_cast<LuaManagedObject *>(object);
+    }
 
-        doObjectAction(linkId, LuaObjectActionRelease);
+    if (managedObject != NULL && managedObject -> getContext() != _context)
+    {
+        //其他上下文的对象，其连接标识在本上下文中无效
+        return NULL;
     }
+
+    return managedObject;
 }
 
-void LuaDataExchanger::beginGetVarsTable()
+int LuaDataExchanger::allocLinkId(LuaManagedObject *object)
 {
-    _context -> getOperationQueue() -> performAction([this](){
+    std::lock_guard<std::mutex> lock(_linkIdLock);
 
-        lua_State *state = _context -> getCurrentSession() -> getState();
+    int linkId = 0;
+    if (!_freeLinkIds.empty())
+    {
+        linkId = _freeLinkIds.back();
+        _freeLinkIds.pop_back();
 
-        LuaEngineAdapter::getGlobal(state, "_G");
-        if (!LuaEngineAdapter::isTable(state, -1))
+        _linkObjects[linkId] = object;
+    }
+    else
+    {
+        if (_linkObjects.empty())
         {
-            LuaEngineAdapter::pop(state, 1);
-
-            LuaEngineAdapter::newTable(state);
-
-            LuaEngineAdapter::pushValue(state, -1);
-            LuaEngineAdapter::setGlobal(state, "_G");
+            //0号位置不使用，0表示未分配标识
+            _linkObjects.push_back(NULL);
         }
 
-        LuaEngineAdapter::getField(state, -1, VarsTableName);
-        if (LuaEngineAdapter::isNil(state, -1))
-        {
-            LuaEngineAdapter::pop(state, 1);
+        linkId = (int)_linkObjects.size();
+        _linkObjects.push_back(object);
+    }
 
-            //创建引用表
-            LuaEngineAdapter::newTable(state);
+    return linkId;
+}
 
-            //创建弱引用表元表
-            LuaEngineAdapter::newTable(state);
-            LuaEngineAdapter::pushString(state, "kv");
-            LuaEngineAdapter::setField(state, -2, "__mode");
-            LuaEngineAdapter::setMetatable(state, -2);
+void LuaDataExchanger::pushVarsTable()
+{
+    lua_State *state = _context -> getCurrentSession() -> getState();
 
-            //放入全局变量_G中
-            LuaEngineAdapter::pushValue(state, -1);
-            LuaEngineAdapter::setField(state, -3, VarsTableName);
-        }
+    if (_varsTableRef == LUA_NOREF)
+    {
+        //创建引用表
+        LuaEngineAdapter::newTable(state);
 
-    });
+        //创建弱引用表元表
+        LuaEngineAdapter::newTable(state);
+        LuaEngineAdapter::pushString(state, "kv");
+        LuaEngineAdapter::setField(state, -2, "__mode");
+        LuaEngineAdapter::setMetatable(state, -2);
 
+        //在注册表中持有，不受脚本修改_G影响
+        LuaEngineAdapter::pushValue(state, -1);
+        _varsTableRef = LuaEngineAdapter::ref(state, LUA_REGISTRYINDEX);
+    }
+    else
+    {
+        LuaEngineAdapter::rawGetI(state, LUA_REGISTRYINDEX, _varsTableRef);
+    }
 }
 
-void LuaDataExchanger::endGetVarsTable()
+void LuaDataExchanger::pushRetainVarsTable()
 {
-    _context -> getOperationQueue() -> performAction([this](){
-
-        lua_State *state = _context -> getCurrentSession() -> getState();
+    lua_State *state = _context -> getCurrentSession() -> getState();
 
-        //弹出_vars_
-        //弹出_G
-        LuaEngineAdapter::pop(state, 2);
+    if (_retainVarsTableRef == LUA_NOREF)
+    {
+        //创建保留表
+        LuaEngineAdapter::newTable(state);
 
-    });
+        //在注册表中持有，不受脚本修改_G影响
+        LuaEngineAdapter::pushValue(state, -1);
+        _retainVarsTableRef = LuaEngineAdapter::ref(state, LUA_REGISTRYINDEX);
+    }
+    else
+    {
+        LuaEngineAdapter::rawGetI(state, LUA_REGISTRYINDEX, _retainVarsTableRef);
+    }
 }
 
 void LuaDataExchanger::pushStackByObject(LuaManagedObject *object)
@@ -510,11 +469,18 @@ void LuaDataExchanger::pushStackByObject(LuaManagedObject *object)
         //LSCFunction\LSCPointer\NSObject
         lua_State *state = _context -> getCurrentSession() -> getState();
 
-        beginGetVarsTable();
+        if (object -> getContext() != _context)
+        {
+            //其他上下文的对象无法复用引用，直接创建对应引用对象
+            object -> push(_context);
+            return;
+        }
+
+        pushVarsTable();
 
-        std::string linkId = object -> getExchangeId();
+        int linkId = object -> getLinkId();
 
-        LuaEngineAdapter::getField(state, -1, linkId.c_str());
+        LuaEngineAdapter::rawGetI(state, -1, linkId);
         if (LuaEngineAdapter::isNil(state, -1))
         {
             //弹出变量
@@ -525,13 +491,13 @@ void LuaDataExchanger::pushStackByObject(LuaManagedObject *object)
 
             //放入_vars_表中，修复如果对象从未在lua回调回来时，无法找到对应对象问题。
             LuaEngineAdapter::pushValue(state, -1);
-            LuaEngineAdapter::setField(state, -3, linkId.c_str());
+            LuaEngineAdapter::rawSetI(state, -3, linkId);
         }
 
-        //将值放入_G之前，目的为了让doActionInVarsTable将_vars_和_G出栈，而不影响该变量值入栈回传Lua
-        LuaEngineAdapter::insert(state, -3);
+        //将值放入_vars_之前，使_vars_出栈后该变量值保留在栈顶回传Lua
+        LuaEngineAdapter::insert(state, -2);
 
-        endGetVarsTable();
+        LuaEngineAdapter::pop(state, 1);
 
     });
 
@@ -543,13 +509,13 @@ void LuaDataExchanger::pushStackByTable(LuaValueList *list)
 
         lua_State *state = _context -> getCurrentSession() -> getState();
 
-        LuaEngineAdapter::newTable(state);
+        LuaEngineAdapter::createTable(state, (int)list -> size(), 0);
 
         int index = 1;
         for (LuaValueList::iterator it = list -> begin(); it != list -> end(); ++it)
         {
             LuaValue *item = *it;
-            pushStack(item);
+            item -> push(_context);
             LuaEngineAdapter::rawSetI(state, -2, index);
 
             index ++;
@@ -565,162 +531,190 @@ void LuaDataExchanger::pushStackByTable(LuaValueMap *map)
 
         lua_State *state = _context -> getCurrentSession() -> getState();
 
-        LuaEngineAdapter::newTable(state);
+        LuaEngineAdapter::createTable(state, 0, (int)map -> size());
 
         for (LuaValueMap::iterator it = map -> begin(); it != map -> end() ; ++it)
         {
             LuaValue *item = it -> second;
-            pushStack(item);
+            item -> push(_context);
             LuaEngineAdapter::setField(state, -2, it -> first.c_str());
         }
 
     });
 }
 
-void LuaDataExchanger::doObjectAction(std::string const& linkId, LuaObjectAction action)
+void LuaDataExchanger::doObjectAction(int linkId, LuaObjectAction action)
 {
     _context -> getOperationQueue() -> performAction([this, linkId, action](){
 
-        if (!linkId.empty())
+        if (linkId == 0)
         {
-            lua_State *state = _context -> getCurrentSession() -> getState();
+            return;
+        }
 
-            LuaEngineAdapter::getGlobal(state, "_G");
-            if (LuaEngineAdapter::isTable(state, -1))
+        //引用次数记录在原生层，仅在引用次数由0变1及由1变0时才需要修改_retainVars_表
+        std::unordered_map<int, int>::iterator it = _retainCounts.find(linkId);
+
+        switch (action)
+        {
+            case LuaObjectActionRetain:
             {
-                LuaEngineAdapter::getField(state, -1, VarsTableName);
-                if (LuaEngineAdapter::isTable(state, -1))
+                if (it != _retainCounts.end())
                 {
-                    //检查对象是否在_vars_表中登记
-                    LuaEngineAdapter::getField(state, -1, linkId.c_str());
-                    if (!LuaEngineAdapter::isNil(state, -1))
-                    {
-                        //检查_retainVars_表是否已经记录对象
-                        LuaEngineAdapter::getField(state, -3, RetainVarsTableName);
-                        if (!LuaEngineAdapter::isTable(state, -1))
-                        {
-                            LuaEngineAdapter::pop(state, 1);
-
-                            //创建引用表
-                            LuaEngineAdapter::newTable(state);
-
-                            //放入全局变量_G中
-                            LuaEngineAdapter::pushValue(state, -1);
-                            LuaEngineAdapter::setField(state, -5, RetainVarsTableName);
-                        }
-
-                        switch (action)
-                        {
-                            case LuaObjectActionRetain:
-                            {
-                                //保留对象
-                                //获取对象
-                                LuaEngineAdapter::getField(state, -1, linkId.c_str());
-                                if (LuaEngineAdapter::isNil(state, -1))
-                                {
-                                    LuaEngineAdapter::pop(state, 1);
-
-                                    LuaEngineAdapter::newTable(state);
-
-                                    //初始化引用次数
-                                    LuaEngineAdapter::pushNumber(state, 0);
-                                    LuaEngineAdapter::setField(state, -2, "retainCount");
-
-                                    LuaEngineAdapter::pushValue(state, -3);
-                                    LuaEngineAdapter::setField(state, -2, "object");
-
-                                    //将对象放入表中
-                                    LuaEngineAdapter::pushValue(state, -1);
-                                    LuaEngineAdapter::setField(state, -3, linkId.c_str());
-                                }
-
-                                //引用次数+1
-                                LuaEngineAdapter::getField(state, -1, "retainCount");
-                                lua_Integer retainCount = LuaEngineAdapter::toInteger(state, -1);
-                                LuaEngineAdapter::pop(state, 1);
-
-                                LuaEngineAdapter::pushNumber(state, retainCount + 1);
-                                LuaEngineAdapter::setField(state, -2, "retainCount");
-
-                                //弹出引用对象
-                                LuaEngineAdapter::pop(state, 1);
-                                break;
-                            }
-                            case LuaObjectActionRelease:
-                            {
-                                //释放对象
-                                //获取对象
-                                LuaEngineAdapter::getField(state, -1, linkId.c_str());
-                                if (!LuaEngineAdapter::isNil(state, -1))
-                                {
-                                    //引用次数-1
-                                    LuaEngineAdapter::getField(state, -1, "retainCount");
-                                    lua_Integer retainCount = LuaEngineAdapter::toInteger(state, -1);
-                                    LuaEngineAdapter::pop(state, 1);
-
-                                    if (retainCount - 1 > 0)
-                                    {
-                                        LuaEngineAdapter::pushNumber(state, retainCount - 1);
-                                        LuaEngineAdapter::setField(state, -2, "retainCount");
-                                    }
-                                    else
-                                    {
-                                        //retainCount<=0时移除对象引用
-                                        LuaEngineAdapter::pushNil(state);
-                                        LuaEngineAdapter::setField(state, -3, linkId.c_str());
-                                    }
-                                }
-
-                                //弹出引用对象
-                                LuaEngineAdapter::pop(state, 1);
-                                break;
-                            }
-                            default:
-                                break;
-                        }
-
-                        //弹出_retainVars_
-                        LuaEngineAdapter::pop(state, 1);
-                    }
-                    //弹出变量
-                    LuaEngineAdapter::pop(state, 1);
+                    it -> second ++;
                 }
-
-                //弹出_vars_
-                LuaEngineAdapter::pop(state, 1);
+                else if (setRetainVar(linkId, true))
+                {
+                    _retainCounts[linkId] = 1;
+                }
+                break;
             }
+            case LuaObjectActionRelease:
+            {
+                if (it != _retainCounts.end() && -- it -> second <= 0)
+                {
+                    //retainCount<=0时移除对象引用
+                    _retainCounts.erase(it);
+                    setRetainVar(linkId, false);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+
+    });
 
-            //弹出_G
+}
+
+bool LuaDataExchanger::setRetainVar(int linkId, bool retain)
+{
+    bool success = false;
+    lua_State *state = _context -> getCurrentSession() -> getState();
+
+    pushRetainVarsTable();
+
+    if (retain)
+    {
+        //检查对象是否在_vars_表中登记，已登记的对象才能保留
+        pushVarsTable();
+        LuaEngineAdapter::rawGetI(state, -1, linkId);
+        if (!LuaEngineAdapter::isNil(state, -1))
+        {
+            LuaEngineAdapter::rawSetI(state, -3, linkId);
+            success = true;
+        }
+        else
+        {
             LuaEngineAdapter::pop(state, 1);
         }
 
-    });
+        //弹出_vars_
+        LuaEngineAdapter::pop(state, 1);
+    }
+    else
+    {
+        LuaEngineAdapter::pushNil(state);
+        LuaEngineAdapter::rawSetI(state, -2, linkId);
+        success = true;
+    }
+
+    //弹出_retainVars_
+    LuaEngineAdapter::pop(state, 1);
 
+    return success;
 }
 
 void LuaDataExchanger::clearObject(LuaManagedObject *object)
 {
     /*
      * fixed：清除_vars_表中持有的对象，虽然_vars_是弱引用表，但是对象释放后器kv依然会保留在表中，因此在对象释放时需要通知该表将对应的key置空，
-     * 否则当有新对象分配到该内存地址的时候就会对某些业务操作造成影响
+     * 否则当有新对象分配到该连接标识的时候就会对某些业务操作造成影响
+     *
+     * 对象可能在任意线程中释放，此处仅将标识放入待清除列表，不访问Lua，由flushPendingClear在下次进入Lua或回收时统一清除
      * */
-    beginGetVarsTable();
+    int linkId = object -> getLinkId();
 
-    _context -> getOperationQueue() -> performAction([this, object](){
+    std::lock_guard<std::mutex> lock(_linkIdLock);
+
+    //反序列化得到的对象与原对象共用连接标识，仅由分配标识的对象负责清除
+    if (linkId <= 0 || linkId >= (int)_linkObjects.size() || _linkObjects[linkId] != object)
+    {
+        return;
+    }
+
+    //清除前标识不可重用
+    _linkObjects[linkId] = NULL;
+    _pendingClearLinkIds.push_back(linkId);
+    _hasPendingClear = true;
+}
+
+void LuaDataExchanger::flushPendingClear()
+{
+    if (!_hasPendingClear)
+    {
+        return;
+    }
+
+    std::vector<int> linkIds;
+    {
+        std::lock_guard<std::mutex> lock(_linkIdLock);
+        linkIds.swap(_pendingClearLinkIds);
+        _hasPendingClear = false;
+    }
+
+    if (linkIds.empty())
+    {
+        return;
+    }
+
+    lua_State *state = _context -> getCurrentSession() -> getState();
+
+    pushVarsTable();
+
+    for (std::vector<int>::iterator it = linkIds.begin(); it != linkIds.end(); ++it)
+    {
+        LuaEngineAdapter::pushNil(state);
+        LuaEngineAdapter::rawSetI(state, -2, *it);
+
+        //对象已释放，无法再解除保留，一并移除保留记录
+        std::unordered_map<int, int>::iterator retainIt = _retainCounts.find(*it);
+        if (retainIt != _retainCounts.end())
+        {
+            _retainCounts.erase(retainIt);
+            setRetainVar(*it, false);
+        }
+    }
+
+    LuaEngineAdapter::pop(state, 1);
+
+    //回收标识
+    std::lock_guard<std::mutex> lock(_linkIdLock);
+    _freeLinkIds.insert(_freeLinkIds.end(), linkIds.begin(), linkIds.end());
+}
+
+void LuaDataExchanger::reset()
+{
+    _context -> getOperationQueue() -> performAction([this](){
 
         lua_State *state = _context -> getCurrentSession() -> getState();
-        const char *linkId = object -> getExchangeId().c_str();
 
-        LuaEngineAdapter::getField(state, -1, linkId);
-        if (!LuaEngineAdapter::isNil(state, -1))
+        _retainCounts.clear();
+
         {
-            LuaEngineAdapter::pushNil(state);
-            LuaEngineAdapter::setField(state, -3, linkId);
+            //引用表将重新创建，待清除的标识可以直接回收
+            std::lock_guard<std::mutex> lock(_linkIdLock);
+            _freeLinkIds.insert(_freeLinkIds.end(), _pendingClearLinkIds.begin(), _pendingClearLinkIds.end());
+            _pendingClearLinkIds.clear();
+            _hasPendingClear = false;
         }
 
-        LuaEngineAdapter::pop(state, 1);
+        //释放引用表，下次使用时重新创建
+        LuaEngineAdapter::unref(state, LUA_REGISTRYINDEX, _varsTableRef);
+        _varsTableRef = LUA_NOREF;
 
-    });
+        LuaEngineAdapter::unref(state, LUA_REGISTRYINDEX, _retainVarsTableRef);
+        _retainVarsTableRef = LUA_NOREF;
 
-    endGetVarsTable();
+    });
 }
@@ -8,6 +8,10 @@
 #include "LuaObject.h"
 #include "LuaValue.h"
 #include "LuaManagedObject.h"
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
 
 namespace cn {
     namespace vimfung {
@@ -35,6 +39,46 @@ namespace cn {
             private:
                 LuaContext *_context;
 
+                /**
+                 * _vars_表在注册表中的引用，记录导入原生层的Lua引用变量（弱引用表）
+                 */
+                int _varsTableRef;
+
+                /**
+                 * _retainVars_表在注册表中的引用，记录保留的Lua对象
+                 */
+                int _retainVarsTableRef;
+
+                /**
+                 * 连接标识对应的管理对象，下标为连接标识，0号位置不使用
+                 */
+                std::vector<LuaManagedObject *> _linkObjects;
+
+                /**
+                 * 已回收可重用的连接标识
+                 */
+                std::vector<int> _freeLinkIds;
+
+                /**
+                 * 连接标识分配锁
+                 */
+                std::mutex _linkIdLock;
+
+                /**
+                 * 待清除的连接标识，对象释放时放入，在flushPendingClear中统一清除后回收
+                 */
+                std::vector<int> _pendingClearLinkIds;
+
+                /**
+                 * 是否有待清除的连接标识
+                 */
+                std::atomic<bool> _hasPendingClear;
+
+                /**
+                 * 对象在Lua中的保留次数，键为连接标识。仅在操作队列中访问
+                 */
+                std::unordered_map<int, int> _retainCounts;
+
             public:
                 /**
                  * 初始化
@@ -74,7 +118,7 @@ namespace cn {
                  * @param stackIndex 栈索引
                  * @param linkId 连接标识
                  */
-                void setLuaObject(int stackIndex, std::string const& linkId);
+                void setLuaObject(int stackIndex, int linkId);
 
                 /**
                  * 保留对象对应在Lua中的引用
@@ -92,11 +136,46 @@ namespace cn {
                 void releaseLuaObject(LuaObject *object);
 
                 /**
-                 * 清除对象在Lua中的引用
+                 * 批量保留对象对应在Lua中的引用，所有对象在一次操作中完成
+                 *
+                 * @param values 值对象列表
+                 */
+                void retainLuaObjects(LuaValueList const& values);
+
+                /**
+                 * 批量释放对象对应在Lua中的引用，所有对象在一次操作中完成
+                 *
+                 * @param values 值对象列表
+                 */
+                void releaseLuaObjects(LuaValueList const& values);
+
+                /**
+                 * 清除对象在Lua中的引用。该方法不访问Lua，可在任意线程调用，引用会在下次调用flushPendingClear时批量清除
                  * @param object 管理对象
                  */
                 void clearObject(LuaManagedObject *object);
 
+                /**
+                 * 批量清除已释放对象在Lua中的引用，需要在操作队列中调用。
+                 * 在进入原生方法调用及垃圾回收时自动调用。
+                 */
+                void flushPendingClear();
+
+                /**
+                 * 为管理对象分配连接标识，标识为_vars_及_retainVars_表中的整数键，对象释放后标识会被回收重用
+                 *
+                 * @param object 管理对象
+                 *
+                 * @return 连接标识
+                 */
+                int allocLinkId(LuaManagedObject *object);
+
+                /**
+                 * 重置数据交换层，清空_vars_与_retainVars_表。
+                 * 注：重置后原生层尚未释放的Lua对象将无法再找到其在Lua中的引用，应在相关对象全部释放后调用。
+                 */
+                void reset();
+
             private:
 
                 /**
@@ -121,14 +200,23 @@ namespace cn {
                 void pushStackByTable(LuaValueMap *map);
 
                 /**
-                 * 开始获取_vars_表
+                 * 将_vars_表入栈，首次调用时创建并在注册表中持有，需要在操作队列中调用
                  */
-                void beginGetVarsTable();
+                void pushVarsTable();
 
                 /**
-                 * 结束获取_vars_表
+                 * 将_retainVars_表入栈，首次调用时创建并在注册表中持有，需要在操作队列中调用
+                 */
+                void pushRetainVarsTable();
+
+                /**
+                 * 获取对象对应的管理对象，值对象会转换为其包含的对象
+                 *
+                 * @param object 原生对象
+                 *
+                 * @return 管理对象，非本上下文的管理对象时返回NULL
                  */
-                void endGetVarsTable();
+                LuaManagedObject* getManagedObject(LuaObject *object);
 
                 /**
                  * 执行对象行为
@@ -136,7 +224,17 @@ namespace cn {
                  * @param linkId 连接标识
                  * @param action 行为
                  */
-                void doObjectAction(std::string const& linkId, LuaObjectAction action);
+                void doObjectAction(int linkId, LuaObjectAction action);
+
+                /**
+                 * 设置对象在_retainVars_表中的引用，需要在操作队列中调用
+                 *
+                 * @param linkId 连接标识
+                 * @param retain true 表示将_vars_表中的对象放入_retainVars_表，false 表示从_retainVars_表移除
+                 *
+                 * @return true 表示设置成功，对象未在_vars_表中登记时无法保留并返回false
+                 */
+                bool setRetainVar(int linkId, bool retain);
             };
 
         }
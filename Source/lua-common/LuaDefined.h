@@ -10,6 +10,8 @@
 #include <list>
 #include <vector>
 #include <deque>
+#include <functional>
+#include "lua.hpp"
 
 namespace cn
 {
@@ -36,9 +38,52 @@ namespace cn
                 LuaValueTypeData = 9,
                 LuaValueTypeFunction = 10,
                 LuaValueTypeTuple = 11,
-                LuaValueTypeClass = 12
+                LuaValueTypeClass = 12,
+                LuaValueTypeNumberArray = 13,
+                LuaValueTypeIntegerArray = 14
             };
 
+            /**
+             * 操作队列模式
+             */
+            enum LuaOperationQueueMode
+            {
+                LuaOperationQueueModeLock = 0,          //加锁模式，在调用线程中执行操作
+                LuaOperationQueueModeExecutor = 1,      //执行器模式，所有操作在队列所属的虚拟机线程中执行
+            };
+
+            /**
+             * 内存回收策略
+             */
+            enum LuaGCPolicy
+            {
+                LuaGCPolicyOff = 0,                     //不进行调度回收，仅依赖Lua自身的自动回收
+                LuaGCPolicyIncremental = 1,             //增量回收，调度器每个周期执行一步回收直至完成一轮回收
+                LuaGCPolicyFullOnIdle = 2,              //空闲回收，上下文空闲一段时间后执行完整回收
+            };
+
+            /**
+             * 内存分配策略
+             */
+            enum LuaAllocatorPolicy
+            {
+                LuaAllocatorPolicyDefault = 0,          //使用系统内存分配
+                LuaAllocatorPolicyPool = 1,             //小对象使用按尺寸分级的内存池分配，大对象使用系统内存分配
+            };
+
+            /**
+             * 内存统计信息
+             */
+            typedef struct {
+
+                size_t liveBytes;           //当前使用字节数
+                size_t peakBytes;           //峰值使用字节数
+                size_t allocCount;          //分配次数
+                size_t freeCount;           //释放次数
+                size_t limitBytes;          //内存上限，0表示不限制
+
+            }LuaMemoryStatistics;
+
             /**
              * Userdata引用
              */
@@ -52,6 +97,8 @@ namespace cn
             typedef std::deque<LuaValue *> LuaArgumentList;
             typedef std::deque<LuaValue *> LuaValueList;
             typedef std::map<std::string, LuaValue*> LuaValueMap;
+            typedef std::vector<double> LuaNumberArray;
+            typedef std::vector<lua_Integer> LuaIntegerArray;
             typedef std::map<int, LuaObject*> LuaObjectMap;
 
             /**
@@ -59,13 +106,55 @@ namespace cn
              */
             typedef void (*LuaExportsNativeTypeHandler) (LuaContext *context, std::string const& typeName);
 
+            /**
+             * 上下文处理器，用于上下文池中上下文的初始化与重置
+             */
+            typedef void (*LuaContextHandler) (LuaContext *context);
+
+            /**
+             * 参数视图，不持有参数对象，仅在方法处理器执行期间有效，如需持有参数请自行retain
+             */
+            typedef struct {
+
+                LuaValue **values;          //参数列表
+                int count;                  //参数数量
+
+            }LuaArgumentView;
+
             typedef LuaValue* (*LuaMethodHandler) (LuaContext *context, std::string const& methodName, LuaArgumentList arguments);
+
+            /**
+             * 快速方法处理器，处理器直接保存在Lua闭包中，调用时无需查找方法表及复制参数列表
+             *
+             * context 上下文对象
+             * arguments 参数视图
+             * 返回值会在入栈后被释放
+             */
+            typedef LuaValue* (*LuaFastMethodHandler) (LuaContext *context, LuaArgumentView const& arguments);
             typedef LuaValue* (*LuaModuleMethodHandler) (LuaModule *module, std::string methodName, LuaArgumentList arguments);
             typedef LuaValue* (*LuaModuleGetterHandler) (LuaModule *module, std::string fieldName);
             typedef void (*LuaModuleSetterHandler) (LuaModule *module, std::string fieldName, LuaValue *value);
 
+            /**
+             * 异步调用完成处理器
+             *
+             * result 调用结果，回调返回后将被释放，如需持有请自行retain
+             * error 错误信息，调用成功时为空字符串
+             */
+            typedef std::function<void (LuaValue *result, std::string const& error)> LuaAsyncCompletionHandler;
+
+            /**
+             * 表遍历处理器
+             *
+             * key 键，回调返回后将被释放，如需持有请自行retain
+             * value 值，回调返回后将被释放，如需持有请自行retain
+             * 返回false时停止遍历
+             */
+            typedef std::function<bool (LuaValue *key, LuaValue *value)> LuaTableEnumerateHandler;
+
             typedef std::map<std::string, LuaModuleMethodHandler> LuaModuleMethodMap;
             typedef std::map<std::string, LuaMethodHandler> LuaMethodMap;
+            typedef std::map<std::string, LuaFastMethodHandler> LuaFastMethodMap;
             typedef std::map<std::string, LuaModuleSetterHandler> LuaModuleSetterMap;
             typedef std::map<std::string, LuaModuleGetterHandler> LuaModuleGetterMap;
             typedef std::map<std::string, LuaModule*> LuaModuleMap;
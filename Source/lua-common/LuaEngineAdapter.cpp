@@ -16,11 +16,73 @@
 
 using namespace cn::vimfung::luascriptcore;
 
+#if LUA_VERSION_NUM == 501
+
+/**
+ * 调用栈信息中首部的层级数量
+ */
+static const int TracebackFirstLevels = 12;
+
+/**
+ * 调用栈信息中尾部的层级数量
+ */
+static const int TracebackLastLevels = 10;
+
+/**
+ * 空关联值表名称
+ */
+static const char *EmptyUserValueTableName = "_LuaEmptyUserValue_";
+
+/**
+ * 将表示未关联值的共享空表入栈，表不存在时创建。
+ * Lua 5.1中关联值保存在userdata的环境表中，环境表不能为nil，使用此表代替
+ *
+ * @param state 状态对象
+ */
+static void pushEmptyUserValueTable(lua_State *state)
+{
+    lua_getfield(state, LUA_REGISTRYINDEX, EmptyUserValueTableName);
+    if (!lua_istable(state, -1))
+    {
+        lua_pop(state, 1);
+
+        lua_newtable(state);
+        lua_pushvalue(state, -1);
+        lua_setfield(state, LUA_REGISTRYINDEX, EmptyUserValueTableName);
+    }
+}
+
+#endif
+
+/**
+ * 未受保护调用中发生错误时的处理，与luaL_newstate中设置的处理一致
+ *
+ * @param state 状态对象
+ *
+ * @return 返回值数量
+ */
+static int panicHandler(lua_State *state)
+{
+    fprintf(stderr, "PANIC: unprotected error in call to Lua API (%s)\n", lua_tostring(state, -1));
+    return 0;
+}
+
 lua_State* LuaEngineAdapter::newState()
 {
     return luaL_newstate();
 }
 
+lua_State* LuaEngineAdapter::newState(lua_Alloc allocFunc, void *userdata)
+{
+    lua_State *state = lua_newstate(allocFunc, userdata);
+    if (state != NULL)
+    {
+        lua_atpanic(state, panicHandler);
+    }
+
+    return state;
+}
+
 int LuaEngineAdapter::GC(lua_State *state, int what, int data)
 {
     return lua_gc(state, what, data);
@@ -51,6 +113,11 @@ const char* LuaEngineAdapter::toString (lua_State *state, int idx)
     return lua_tostring(state, idx);
 }
 
+const char* LuaEngineAdapter::typeName (lua_State *state, int idx)
+{
+    return lua_typename(state, lua_type(state, idx));
+}
+
 void LuaEngineAdapter::getGlobal (lua_State *state, const char *name)
 {
     lua_getglobal(state, name);
@@ -191,6 +258,11 @@ void LuaEngineAdapter::newTable(lua_State *state)
     lua_newtable(state);
 }
 
+void LuaEngineAdapter::createTable(lua_State *state, int narr, int nrec)
+{
+    lua_createtable(state, narr, nrec);
+}
+
 int LuaEngineAdapter::setMetatable (lua_State *state, int objindex)
 {
     return lua_setmetatable(state, objindex);
@@ -268,5 +340,164 @@ void LuaEngineAdapter::pushCFunction (lua_State *state, lua_CFunction fn)
 
 int LuaEngineAdapter::error (lua_State *state, const char *message)
 {
-    return luaL_error(state, message);
+    //消息中可能包含%等格式字符，不能直接作为格式串使用
+    return luaL_error(state, "%s", message);
+}
+
+void LuaEngineAdapter::rawGetI(lua_State *state, int idx, int n)
+{
+    lua_rawgeti(state, idx, n);
+}
+
+size_t LuaEngineAdapter::rawLen(lua_State *state, int idx)
+{
+#if LUA_VERSION_NUM == 501
+    return lua_objlen(state, idx);
+#else
+    return lua_rawlen(state, idx);
+#endif
+}
+
+int LuaEngineAdapter::loadBuffer(lua_State *state, const char *buffer, size_t size, const char *name)
+{
+    return luaL_loadbuffer(state, buffer, size, name);
+}
+
+int LuaEngineAdapter::dump(lua_State *state, lua_Writer writer, void *data)
+{
+#if LUA_VERSION_NUM == 501
+    return lua_dump(state, writer, data);
+#else
+    return lua_dump(state, writer, data, 0);
+#endif
+}
+
+int LuaEngineAdapter::ref(lua_State *state, int tblIndex)
+{
+    return luaL_ref(state, tblIndex);
+}
+
+void LuaEngineAdapter::unref(lua_State *state, int tblIndex, int ref)
+{
+    luaL_unref(state, tblIndex, ref);
+}
+
+bool LuaEngineAdapter::isInteger(lua_State *state, int idx)
+{
+#if LUA_VERSION_NUM == 501
+    if (lua_type(state, idx) != LUA_TNUMBER)
+    {
+        return false;
+    }
+
+    lua_Number number = lua_tonumber(state, idx);
+    return number == (lua_Number)(lua_Integer)number;
+#else
+    return lua_isinteger(state, idx) != 0;
+#endif
+}
+
+void LuaEngineAdapter::getUserValue(lua_State *state, int idx)
+{
+#if LUA_VERSION_NUM == 501
+    lua_getfenv(state, idx);
+
+    pushEmptyUserValueTable(state);
+    bool isEmpty = lua_rawequal(state, -1, -2) != 0;
+    lua_pop(state, 1);
+
+    if (isEmpty)
+    {
+        lua_pop(state, 1);
+        lua_pushnil(state);
+    }
+#else
+    lua_getuservalue(state, idx);
+#endif
+}
+
+void LuaEngineAdapter::setUserValue(lua_State *state, int idx)
+{
+#if LUA_VERSION_NUM == 501
+    idx = lua_absindex(state, idx);
+
+    if (!lua_istable(state, -1))
+    {
+        //环境表只能为表，非表值视为取消关联
+        lua_pop(state, 1);
+        pushEmptyUserValueTable(state);
+    }
+
+    lua_setfenv(state, idx);
+#else
+    lua_setuservalue(state, idx);
+#endif
+}
+
+void LuaEngineAdapter::traceback(lua_State *state, const char *message, int level)
+{
+#if LUA_VERSION_NUM == 501
+    int top = lua_gettop(state);
+    bool firstPart = true;
+    lua_Debug ar;
+
+    if (message != NULL)
+    {
+        lua_pushfstring(state, "%s\n", message);
+    }
+    lua_pushliteral(state, "stack traceback:");
+
+    while (lua_getstack(state, level++, &ar))
+    {
+        if (level > TracebackFirstLevels && firstPart)
+        {
+            //层级过多时仅保留首尾部分
+            if (!lua_getstack(state, level + TracebackLastLevels, &ar))
+            {
+                level--;
+            }
+            else
+            {
+                lua_pushliteral(state, "\n\t...");
+                while (lua_getstack(state, level + TracebackLastLevels, &ar))
+                {
+                    level++;
+                }
+            }
+
+            firstPart = false;
+            continue;
+        }
+
+        lua_getinfo(state, "Snl", &ar);
+        lua_pushfstring(state, "\n\t%s:", ar.short_src);
+        if (ar.currentline > 0)
+        {
+            lua_pushfstring(state, "%d:", ar.currentline);
+        }
+
+        if (*ar.namewhat != '\0')
+        {
+            lua_pushfstring(state, " in function '%s'", ar.name);
+        }
+        else if (*ar.what == 'm')
+        {
+            lua_pushliteral(state, " in main chunk");
+        }
+        else if (*ar.what == 'C' || *ar.what == 't')
+        {
+            lua_pushliteral(state, " ?");
+        }
+        else
+        {
+            lua_pushfstring(state, " in function <%s:%d>", ar.short_src, ar.linedefined);
+        }
+
+        lua_concat(state, lua_gettop(state) - top);
+    }
+
+    lua_concat(state, lua_gettop(state) - top);
+#else
+    luaL_traceback(state, state, message, level);
+#endif
 }
@@ -31,6 +31,16 @@ namespace cn
                  * @return Lua状态对象
                  **/
                 static lua_State* newState();
+
+                /**
+                 * 使用指定内存分配函数创建新的Lua状态对象
+                 *
+                 * @param allocFunc 内存分配函数
+                 * @param userdata 传递给内存分配函数的用户数据
+                 *
+                 * @return Lua状态对象
+                 **/
+                static lua_State* newState(lua_Alloc allocFunc, void *userdata);
                 
                 /**
                  * 调用垃圾回收
@@ -85,6 +95,16 @@ namespace cn
                  **/
                 static const char* toString (lua_State *state, int idx);
                 
+                /**
+                 * 获取指定栈数据的类型名称
+                 *
+                 * @param state 状态对象
+                 * @param idx 栈索引
+                 *
+                 * @return 类型名称
+                 **/
+                static const char* typeName (lua_State *state, int idx);
+                
                 /**
                  * 获取全局变量
                  *
@@ -335,6 +355,15 @@ namespace cn
                  @param state 状态对象
                  */
                 static void newTable(lua_State *state);
+
+                /**
+                 创建Table对象并预分配空间
+
+                 @param state 状态对象
+                 @param narr 数组部分的元素数量
+                 @param nrec 哈希部分的元素数量
+                 */
+                static void createTable(lua_State *state, int narr, int nrec);
                 
                 /**
                  设置元表
@@ -464,6 +493,99 @@ namespace cn
                  @return 执行结果
                  */
                 static int error (lua_State *state, const char *message);
+
+                /**
+                 获取表数据的源操作，不触发index元方法，结果入栈
+
+                 @param state 状态
+                 @param idx Table的栈索引
+                 @param n 下标
+                 */
+                static void rawGetI(lua_State *state, int idx, int n);
+
+                /**
+                 获取对象的原始长度，不触发len元方法
+
+                 @param state 状态
+                 @param idx 对象的栈索引
+                 @return 长度
+                 */
+                static size_t rawLen(lua_State *state, int idx);
+
+                /**
+                 加载缓冲区中的代码块（源码或字节码）
+
+                 @param state 状态对象
+                 @param buffer 缓冲区
+                 @param size 缓冲区大小
+                 @param name 代码块名称
+                 @return 执行结果
+                 */
+                static int loadBuffer(lua_State *state, const char *buffer, size_t size, const char *name);
+
+                /**
+                 将栈顶的函数导出为字节码
+
+                 @param state 状态对象
+                 @param writer 写入函数
+                 @param data 传递给写入函数的数据
+                 @return 执行结果
+                 */
+                static int dump(lua_State *state, lua_Writer writer, void *data);
+
+                /**
+                 将栈顶对象放入表中并返回其引用，对象出栈
+
+                 @param state 状态对象
+                 @param tblIndex 表的栈索引
+                 @return 引用
+                 */
+                static int ref(lua_State *state, int tblIndex);
+
+                /**
+                 释放表中的对象引用
+
+                 @param state 状态对象
+                 @param tblIndex 表的栈索引
+                 @param ref 引用
+                 */
+                static void unref(lua_State *state, int tblIndex, int ref);
+
+                /**
+                 判断是否为整数，Lua 5.1中数值为整数值时即视为整数
+
+                 @param state 状态对象
+                 @param idx 栈索引
+                 @return true 表示为整数，否则不是
+                 */
+                static bool isInteger(lua_State *state, int idx);
+
+                /**
+                 将userdata关联的值入栈，未关联时入栈nil。
+                 Lua 5.1中关联值保存在userdata的环境表中，userdata需要先通过setUserValue关联nil，
+                 否则创建时继承的环境表会被当作关联值
+
+                 @param state 状态对象
+                 @param idx userdata的栈索引
+                 */
+                static void getUserValue(lua_State *state, int idx);
+
+                /**
+                 将栈顶的值关联到userdata，值出栈。Lua 5.1中只能关联表，其他值视为nil
+
+                 @param state 状态对象
+                 @param idx userdata的栈索引
+                 */
+                static void setUserValue(lua_State *state, int idx);
+
+                /**
+                 生成调用栈信息并入栈，与luaL_traceback一致，Lua 5.1中按debug.traceback的格式生成
+
+                 @param state 状态对象
+                 @param message 附加在调用栈信息前的消息，为NULL时不附加
+                 @param level 起始层级
+                 */
+                static void traceback(lua_State *state, const char *message, int level);
             };
             
         }
@@ -11,10 +11,56 @@
 
 using namespace cn::vimfung::luascriptcore;
 
+/**
+ 原生参数分类
+ */
+enum NativeArgumentClass
+{
+    NativeArgumentClassFloat = 0,           //浮点型，f、d
+    NativeArgumentClassInteger = 1,         //整型，c、i、s、l、q及其无符号类型
+    NativeArgumentClassBoolean = 2,         //布尔型，B
+    NativeArgumentClassObject = 3,          //对象，@
+    NativeArgumentClassUnsupported = 4,     //不支持的类型
+};
+
 LuaExportMethodDescriptor::LuaExportMethodDescriptor(std::string const& name, std::string const& methodSignature)
 {
     _name = name;
     _methodSignature = methodSignature;
+
+    //预先将签名转换为参数分类，匹配参数时无需再解析签名
+    _argumentClasses.reserve(methodSignature.length());
+    for (std::string::const_iterator it = methodSignature.begin(); it != methodSignature.end(); ++it)
+    {
+        switch (*it)
+        {
+            case 'f':
+            case 'd':
+                _argumentClasses.push_back(NativeArgumentClassFloat);
+                break;
+            case 'c':
+            case 'i':
+            case 's':
+            case 'l':
+            case 'q':
+            case 'C':
+            case 'I':
+            case 'S':
+            case 'L':
+            case 'Q':
+                _argumentClasses.push_back(NativeArgumentClassInteger);
+                break;
+            case 'B':
+                _argumentClasses.push_back(NativeArgumentClassBoolean);
+                break;
+            case '@':
+                _argumentClasses.push_back(NativeArgumentClassObject);
+                break;
+            default:
+                _argumentClasses.push_back(NativeArgumentClassUnsupported);
+                break;
+        }
+    }
 }
 
 std::string LuaExportMethodDescriptor::name()
@@ -31,3 +77,69 @@ LuaValue* LuaExportMethodDescriptor::invoke(LuaSession *session, LuaArgumentList
 {
     return NULL;
 }
+
+LuaMethodMatchLevel LuaExportMethodDescriptor::matchArguments(LuaArgumentList const& arguments, int startIndex)
+{
+    int count = (int)arguments.size() - startIndex;
+    if (count < 0)
+    {
+        count = 0;
+    }
+
+    if (count != (int)_argumentClasses.size())
+    {
+        return LuaMethodMatchLevelNone;
+    }
+
+    LuaMethodMatchLevel level = LuaMethodMatchLevelExact;
+    for (int i = 0; i < count; i++)
+    {
+        unsigned char argumentClass = _argumentClasses[i];
+        if (argumentClass == NativeArgumentClassUnsupported)
+        {
+            return LuaMethodMatchLevelNone;
+        }
+
+        LuaMethodMatchLevel argumentLevel = LuaMethodMatchLevelExact;
+        switch (arguments[startIndex + i] -> getType())
+        {
+            case LuaValueTypeNumber:
+                //浮点数可传入浮点型参数，其次为整型参数
+                if (argumentClass == NativeArgumentClassInteger)
+                {
+                    argumentLevel = LuaMethodMatchLevelAlternate;
+                }
+                else if (argumentClass != NativeArgumentClassFloat)
+                {
+                    argumentLevel = LuaMethodMatchLevelCompatible;
+                }
+                break;
+            case LuaValueTypeBoolean:
+                if (argumentClass != NativeArgumentClassBoolean)
+                {
+                    argumentLevel = LuaMethodMatchLevelCompatible;
+                }
+                break;
+            case LuaValueTypeInteger:
+                if (argumentClass != NativeArgumentClassInteger)
+                {
+                    argumentLevel = LuaMethodMatchLevelCompatible;
+                }
+                break;
+            default:
+                //其他类型只能传入对象参数
+                if (argumentClass != NativeArgumentClassObject)
+                {
+                    return LuaMethodMatchLevelNone;
+                }
+                break;
+        }
+
+        if (argumentLevel < level)
+        {
+            level = argumentLevel;
+        }
+    }
+
+    return level;
+}
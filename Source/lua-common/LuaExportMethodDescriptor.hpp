@@ -11,6 +11,7 @@
 
 #include <stdio.h>
 #include <string>
+#include <vector>
 #include "LuaObject.h"
 #include "LuaDefined.h"
 
@@ -21,6 +22,17 @@ namespace cn {
             class LuaValue;
             class LuaSession;
             class LuaExportTypeDescriptor;
+
+            /**
+             参数匹配程度
+             */
+            enum LuaMethodMatchLevel
+            {
+                LuaMethodMatchLevelNone = 0,            //不匹配
+                LuaMethodMatchLevelCompatible = 1,      //可转换匹配，如布尔值传入数值参数
+                LuaMethodMatchLevelAlternate = 2,       //备选匹配，浮点数传入整型参数
+                LuaMethodMatchLevelExact = 3,           //完全匹配
+            };
             
             /**
              方法描述器
@@ -59,6 +71,15 @@ namespace cn {
                  @return 返回值
                  */
                 virtual LuaValue* invoke(LuaSession *session, LuaArgumentList arguments);
+
+                /**
+                 匹配传入参数，使用初始化时根据方法签名预先生成的参数分类进行比较，不分配内存
+
+                 @param arguments 参数列表
+                 @param startIndex 参与匹配的起始参数索引
+                 @return 匹配程度
+                 */
+                LuaMethodMatchLevel matchArguments(LuaArgumentList const& arguments, int startIndex);
                 
             public:
                 
@@ -78,6 +99,11 @@ namespace cn {
                  方法签名
                  */
                 std::string _methodSignature;
+
+                /**
+                 参数分类，由方法签名中每个参数的类型符号转换而来
+                 */
+                std::vector<unsigned char> _argumentClasses;
             };
             
         }
@@ -13,10 +13,17 @@
 using namespace cn::vimfung::luascriptcore;
 
 LuaExportPropertyDescriptor::LuaExportPropertyDescriptor(std::string const& name, bool canRead, bool canWrite)
+    : LuaExportPropertyDescriptor(name, canRead, canWrite, LuaValueTypeNil)
+{
+
+}
+
+LuaExportPropertyDescriptor::LuaExportPropertyDescriptor(std::string const& name, bool canRead, bool canWrite, LuaValueType primitiveType)
 {
     _name = name;
     _canRead = canRead;
     _canWrite = canWrite;
+    _primitiveType = primitiveType;
     _getter = NULL;
     _setter = NULL;
 }
@@ -39,6 +46,7 @@ LuaExportPropertyDescriptor::LuaExportPropertyDescriptor(std::string const& name
     
     _canRead = getter != NULL;
     _canWrite = setter != NULL;
+    _primitiveType = LuaValueTypeNil;
 }
 
 LuaExportPropertyDescriptor::~LuaExportPropertyDescriptor()
@@ -71,6 +79,11 @@ std::string LuaExportPropertyDescriptor::name()
     return _name;
 }
 
+LuaValueType LuaExportPropertyDescriptor::primitiveType()
+{
+    return _primitiveType;
+}
+
 LuaValue* LuaExportPropertyDescriptor::invokeGetter(LuaSession *session, LuaObjectDescriptor *instance)
 {
     LuaValue *retValue = NULL;
@@ -95,3 +108,16 @@ void LuaExportPropertyDescriptor::invokeSetter(LuaSession *session, LuaObjectDes
         _setter -> invoke(&args);
     }
 }
+
+LuaPrimitiveValue LuaExportPropertyDescriptor::invokePrimitiveGetter(LuaObjectDescriptor *instance)
+{
+    LuaPrimitiveValue value;
+    value.integerValue = 0;
+
+    return value;
+}
+
+void LuaExportPropertyDescriptor::invokePrimitiveSetter(LuaObjectDescriptor *instance, LuaPrimitiveValue value)
+{
+
+}
@@ -24,6 +24,16 @@ namespace cn
             class LuaFunction;
             class LuaExportTypeDescriptor;
             class LuaObjectDescriptor;
+
+            /**
+             基础类型属性值
+             */
+            typedef union
+            {
+                lua_Number numberValue;         //浮点数，类型为LuaValueTypeNumber时使用
+                lua_Integer integerValue;       //整数，类型为LuaValueTypeInteger时使用
+                bool booleanValue;              //布尔值，类型为LuaValueTypeBoolean时使用
+            } LuaPrimitiveValue;
             
             /**
              属性描述
@@ -40,6 +50,16 @@ namespace cn
                  @param canWrite 是否能写
                  */
                 LuaExportPropertyDescriptor(std::string const& name, bool canRead, bool canWrite);
+
+                /**
+                 初始化基础类型属性，读写时通过invokePrimitiveGetter及invokePrimitiveSetter直接存取值，无需创建LuaValue对象
+
+                 @param name 属性名称
+                 @param canRead 是否能读
+                 @param canWrite 是否能写
+                 @param primitiveType 基础类型，可以为LuaValueTypeNumber、LuaValueTypeInteger或LuaValueTypeBoolean
+                 */
+                LuaExportPropertyDescriptor(std::string const& name, bool canRead, bool canWrite, LuaValueType primitiveType);
                 
                 /**
                  初始化
@@ -76,6 +96,13 @@ namespace cn
                  @return 属性名称
                  */
                 std::string name();
+
+                /**
+                 获取基础类型
+
+                 @return 基础类型，不是基础类型属性时返回LuaValueTypeNil
+                 */
+                LuaValueType primitiveType();
                 
                 /**
                  调用Getter方法
@@ -95,6 +122,22 @@ namespace cn
                  @param value 属性值
                  */
                 virtual void invokeSetter(LuaSession *session, LuaObjectDescriptor *instance, LuaValue *value);
+
+                /**
+                 读取基础类型属性值，调用时不会创建会话，实现中不应访问Lua
+
+                 @param instance 实例对象
+                 @return 属性值
+                 */
+                virtual LuaPrimitiveValue invokePrimitiveGetter(LuaObjectDescriptor *instance);
+
+                /**
+                 设置基础类型属性值，调用时不会创建会话，实现中不应访问Lua
+
+                 @param instance 实例对象
+                 @param value 属性值
+                 */
+                virtual void invokePrimitiveSetter(LuaObjectDescriptor *instance, LuaPrimitiveValue value);
                 
             public:
                 
@@ -119,6 +162,11 @@ namespace cn
                  是否可写
                  */
                 bool _canWrite;
+
+                /**
+                 基础类型
+                 */
+                LuaValueType _primitiveType;
                 
                 /**
                  获取处理器
@@ -16,11 +16,164 @@
 #include "LuaContext.h"
 #include "LuaExportsTypeManager.hpp"
 #include "LuaValue.h"
-#include <deque>
-#include <regex>
+#include <atomic>
 
 using namespace cn::vimfung::luascriptcore;
 
+/**
+ 参数签名中可记录的最大参数数量，每个参数占2位，最高8位记录参数数量
+ */
+#define LUA_METHOD_SIGNATURE_MAX_ARGUMENTS 28
+
+/**
+ 决策表预先编译的最大参数数量，每增加一个参数签名数量扩大4倍，超出该数量的调用直接匹配方法
+ */
+#define LUA_METHOD_DECISION_MAX_ARGUMENTS 4
+
+/**
+ 生成方法版本，所有类型共用一个递增序列，避免类型描述对象地址复用时误用调用点缓存
+
+ @return 方法版本
+ */
+static unsigned int nextMethodsVersion()
+{
+    static std::atomic<unsigned int> version(0);
+    return ++version;
+}
+
+/**
+ 成员版本
+ */
+static std::atomic<unsigned int> _membersVersion(1);
+
+/**
+ 生成参数签名，数值、布尔值、整数、其他类型分别使用0至3表示
+
+ @param arguments 参数列表
+ @param startIndex 起始参数索引
+ @param signature 参数签名
+ @return true 表示生成成功，参数数量过多时返回false
+ */
+static bool argumentsSignature(LuaArgumentList const& arguments, int startIndex, unsigned long long &signature)
+{
+    int count = (int)arguments.size() - startIndex;
+    if (count < 0)
+    {
+        count = 0;
+    }
+
+    if (count > LUA_METHOD_SIGNATURE_MAX_ARGUMENTS)
+    {
+        return false;
+    }
+
+    signature = (unsigned long long)count << 56;
+    for (int i = 0; i < count; i++)
+    {
+        unsigned long long sign = 3;
+        switch (arguments[startIndex + i] -> getType())
+        {
+            case LuaValueTypeNumber:
+                sign = 0;
+                break;
+            case LuaValueTypeBoolean:
+                sign = 1;
+                break;
+            case LuaValueTypeInteger:
+                sign = 2;
+                break;
+            default:
+                break;
+        }
+
+        signature |= sign << (i * 2);
+    }
+
+    return true;
+}
+
+/**
+ 从重载方法中选择最匹配的方法，优先选择第一个完全匹配的方法，其次为最后一个备选匹配的方法，最后为第一个可转换匹配的方法
+
+ @param methodList 方法列表
+ @param arguments 参数列表
+ @param startIndex 起始参数索引
+ @return 方法描述，没有匹配方法时返回NULL
+ */
+static LuaExportMethodDescriptor* matchMethod(MethodList const& methodList, LuaArgumentList const& arguments, int startIndex)
+{
+    LuaExportMethodDescriptor *alternateMethod = NULL;
+    LuaExportMethodDescriptor *compatibleMethod = NULL;
+
+    for (MethodList::const_iterator it = methodList.begin(); it != methodList.end(); ++it)
+    {
+        LuaExportMethodDescriptor *methodDesc = *it;
+        switch (methodDesc -> matchArguments(arguments, startIndex))
+        {
+            case LuaMethodMatchLevelExact:
+                return methodDesc;
+            case LuaMethodMatchLevelAlternate:
+                alternateMethod = methodDesc;
+                break;
+            case LuaMethodMatchLevelCompatible:
+                if (compatibleMethod == NULL)
+                {
+                    compatibleMethod = methodDesc;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    return alternateMethod != NULL ? alternateMethod : compatibleMethod;
+}
+
+/**
+ 编译重载方法决策表，为不超过LUA_METHOD_DECISION_MAX_ARGUMENTS个参数的每种参数签名预先选出匹配的方法。
+ 方法匹配仅取决于参数签名中的类型分类，因此使用各分类的代表值进行匹配即可。
+
+ @param methodList 方法列表
+ @param decisionTable 决策表
+ */
+static void compileMethodDecisions(MethodList const& methodList, MethodDecisionTable &decisionTable)
+{
+    decisionTable.clear();
+
+    //与argumentsSignature中的分类顺序一致：数值、布尔值、整数、其他类型
+    LuaValue *typeValues[4] = {
+        LuaValue::NumberValue(0),
+        LuaValue::BooleanValue(false),
+        LuaValue::IntegerValue(0),
+        LuaValue::NilValue()
+    };
+
+    LuaArgumentList arguments;
+    for (int count = 0; count <= LUA_METHOD_DECISION_MAX_ARGUMENTS; count++)
+    {
+        unsigned long long combinations = 1ULL << (count * 2);
+        for (unsigned long long signs = 0; signs < combinations; signs++)
+        {
+            arguments.clear();
+            for (int i = 0; i < count; i++)
+            {
+                arguments.push_back(typeValues[(signs >> (i * 2)) & 3]);
+            }
+
+            LuaExportMethodDescriptor *targetMethod = matchMethod(methodList, arguments, 0);
+            if (targetMethod != NULL)
+            {
+                decisionTable[((unsigned long long)count << 56) | signs] = targetMethod;
+            }
+        }
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        typeValues[i] -> release();
+    }
+}
+
 LuaExportTypeDescriptor* LuaExportTypeDescriptor::objectTypeDescriptor()
 {
     static LuaExportTypeDescriptor *objectTypeDescriptor = NULL;
@@ -41,6 +194,7 @@ LuaExportTypeDescriptor::LuaExportTypeDescriptor (std::string const& nativeTypeN
     _typeName = StringUtils::replace(nativeTypeName, ".", "_");
     _parentTypeDescriptor = parentTypeDescriptor;
     _prototypeTypeName = StringUtils::format("_%s_PROTOTYPE_", _typeName.c_str());
+    _methodsVersion = nextMethodsVersion();
 }
 
 LuaExportTypeDescriptor::~LuaExportTypeDescriptor()
@@ -110,20 +264,32 @@ bool LuaExportTypeDescriptor::subtypeOfType(LuaExportTypeDescriptor *typeDescrip
 
 void LuaExportTypeDescriptor::addClassMethod(std::string const& methodName, LuaExportMethodDescriptor *methodDescriptor)
 {
-    std::list<LuaExportMethodDescriptor *> methods = _classMethods[methodName];
     methodDescriptor -> retain();
     methodDescriptor -> typeDescriptor = this;
-    methods.push_back(methodDescriptor);
-    _classMethods[methodName] = methods;
+    MethodList &methodList = _classMethods[methodName];
+    methodList.push_back(methodDescriptor);
+
+    //重载列表变更，重新编译决策表并使调用点缓存失效
+    if (methodList.size() > 1)
+    {
+        compileMethodDecisions(methodList, _classMethodDecisions[methodName]);
+    }
+    _methodsVersion = nextMethodsVersion();
 }
 
 void LuaExportTypeDescriptor::addInstanceMethod(std::string const& methodName, LuaExportMethodDescriptor *methodDescriptor)
 {
-    std::list<LuaExportMethodDescriptor *> methods = _instanceMethods[methodName];
     methodDescriptor -> retain();
     methodDescriptor -> typeDescriptor = this;
-    methods.push_back(methodDescriptor);
-    _instanceMethods[methodName] = methods;
+    MethodList &methodList = _instanceMethods[methodName];
+    methodList.push_back(methodDescriptor);
+
+    //重载列表变更，重新编译决策表并使调用点缓存失效
+    if (methodList.size() > 1)
+    {
+        compileMethodDecisions(methodList, _instanceMethodDecisions[methodName]);
+    }
+    _methodsVersion = nextMethodsVersion();
 }
 
 void LuaExportTypeDescriptor::addProperty(std::string const& propertyName, LuaExportPropertyDescriptor *propertyDescriptor)
@@ -131,6 +297,18 @@ void LuaExportTypeDescriptor::addProperty(std::string const& propertyName, LuaEx
     propertyDescriptor -> retain();
     propertyDescriptor -> typeDescriptor = this;
     _properties[propertyName] = propertyDescriptor;
+
+    updateMembersVersion();
+}
+
+unsigned int LuaExportTypeDescriptor::membersVersion()
+{
+    return _membersVersion;
+}
+
+void LuaExportTypeDescriptor::updateMembersVersion()
+{
+    ++_membersVersion;
 }
 
 std::list<std::string> LuaExportTypeDescriptor::classMethodNameList()
@@ -157,14 +335,24 @@ std::list<std::string> LuaExportTypeDescriptor::instanceMethodNameList()
     return nameList;
 }
 
-LuaExportMethodDescriptor* LuaExportTypeDescriptor::getClassMethod(std::string const& methodName, LuaArgumentList arguments)
+LuaExportMethodDescriptor* LuaExportTypeDescriptor::getClassMethod(std::string const& methodName, LuaArgumentList const& arguments)
+{
+    return filterMethod(methodName, arguments, true, NULL);
+}
+
+LuaExportMethodDescriptor* LuaExportTypeDescriptor::getClassMethod(std::string const& methodName, LuaArgumentList const& arguments, LuaMethodCallSiteCache *cache)
+{
+    return filterMethod(methodName, arguments, true, cache);
+}
+
+LuaExportMethodDescriptor* LuaExportTypeDescriptor::getInstanceMethod(std::string const& methodName, LuaArgumentList const& arguments)
 {
-    return filterMethod(methodName, arguments, true);
+    return filterMethod(methodName, arguments, false, NULL);
 }
 
-LuaExportMethodDescriptor* LuaExportTypeDescriptor::getInstanceMethod(std::string const& methodName, LuaArgumentList arguments)
+LuaExportMethodDescriptor* LuaExportTypeDescriptor::getInstanceMethod(std::string const& methodName, LuaArgumentList const& arguments, LuaMethodCallSiteCache *cache)
 {
-    return filterMethod(methodName, arguments, false);
+    return filterMethod(methodName, arguments, false, cache);
 }
 
 LuaExportPropertyDescriptor* LuaExportTypeDescriptor::getProperty(std::string const& propertyName)
@@ -193,186 +381,82 @@ LuaExportTypeDescriptor* LuaExportTypeDescriptor::createSubType(LuaSession *sess
     return new LuaExportTypeDescriptor(subTypeName, this);
 }
 
-LuaExportMethodDescriptor* LuaExportTypeDescriptor::filterMethod(std::string const& methodName, LuaArgumentList arguments, bool isStatic)
+LuaExportMethodDescriptor* LuaExportTypeDescriptor::filterMethod(std::string const& methodName, LuaArgumentList const& arguments, bool isStatic, LuaMethodCallSiteCache *cache)
 {
-    MethodList methodList;
-    if (isStatic)
+    int startIndex = isStatic ? 0 : 1;
+    unsigned long long signature = 0;
+    bool hasSignature = false;
+    bool hasComputedSignature = false;
+
+    if (cache != NULL
+        && cache -> methodDescriptor != NULL
+        && cache -> typeDescriptor == this
+        && cache -> version == _methodsVersion)
     {
-        MethodMap::iterator mapIt = _classMethods.find(methodName);
-        if (mapIt != _classMethods.end())
+        if (!cache -> overloaded)
+        {
+            return cache -> methodDescriptor;
+        }
+
+        hasSignature = argumentsSignature(arguments, startIndex, signature);
+        hasComputedSignature = true;
+        if (hasSignature && cache -> signature == signature)
         {
-            methodList = mapIt -> second;
+            return cache -> methodDescriptor;
         }
     }
+
+    MethodMap &methods = isStatic ? _classMethods : _instanceMethods;
+    MethodMap::iterator mapIt = methods.find(methodName);
+    if (mapIt == methods.end())
+    {
+        return NULL;
+    }
+
+    MethodList &methodList = mapIt -> second;
+    bool overloaded = methodList.size() > 1;
+    LuaExportMethodDescriptor *targetMethod = NULL;
+
+    if (!overloaded)
+    {
+        targetMethod = methodList.front();
+    }
     else
     {
-        MethodMap::iterator mapIt = _instanceMethods.find(methodName);
-        if (mapIt != _instanceMethods.end())
+        if (!hasComputedSignature)
         {
-            methodList = mapIt -> second;
+            hasSignature = argumentsSignature(arguments, startIndex, signature);
         }
-    }
 
-    if (methodList.size() > 1)
-    {
-        LuaExportMethodDescriptor *targetMethod = NULL;
-        
-        int startIndex = isStatic ? 0 : 1;
-        if (arguments.size() > startIndex)
+        if (hasSignature && (int)(signature >> 56) <= LUA_METHOD_DECISION_MAX_ARGUMENTS)
         {
-            //带参数
-            std::deque<std::string> signList;
-            std::string signListStr;
-            std::string signStrRegexp;
-            
-            for (LuaArgumentList::iterator it = arguments.begin() + startIndex; it != arguments.end(); it++)
-            {
-                LuaValue *value = *it;
-                switch (value -> getType())
-                {
-                    case LuaValueTypeNumber:
-                        signList.push_back("N");
-                        signListStr += "N";
-                        signStrRegexp += "[fdcislqCISLQB@]";
-                        break;
-                    case LuaValueTypeBoolean:
-                        signList.push_back("B");
-                        signListStr += "B";
-                        signStrRegexp += "[BcislqCISLQfd@]";
-                        break;
-                    case LuaValueTypeInteger:
-                        signList.push_back("I");
-                        signListStr += "I";
-                        signStrRegexp += "[cislqCISLQfdB@]";
-                        break;
-                    default:
-                        signList.push_back("O");
-                        signListStr += "O";
-                        signStrRegexp += "@";
-                        break;
-                }
-            }
-            
-            std::string luaMethodSignStr = methodName  + "_" + signListStr;
-            MappingMethodMap::iterator methodIt = _methodsMapping.find(luaMethodSignStr);
-            
-            if (methodIt == _methodsMapping.end())
+            //决策表在添加方法时已编译完成，调用时只读，表中没有的签名表示无匹配方法
+            MethodDecisionTableMap const& decisions = isStatic ? _classMethodDecisions : _instanceMethodDecisions;
+            MethodDecisionTableMap::const_iterator decisionsIt = decisions.find(methodName);
+            if (decisionsIt != decisions.end())
             {
-                //映射表无该方法，查找匹配方法
-                MethodList matchMethods;
-                std::regex regExp(signStrRegexp);
-                
-                for (MethodList::iterator methodIt = methodList.begin(); methodIt != methodList.end(); methodIt ++)
+                MethodDecisionTable::const_iterator decisionIt = decisionsIt -> second.find(signature);
+                if (decisionIt != decisionsIt -> second.end())
                 {
-                    LuaExportMethodDescriptor *methodDesc = *methodIt;
-                    if (std::regex_match(methodDesc -> methodSignature(), regExp))
-                    {
-                        matchMethods.push_back(methodDesc);
-                    }
+                    targetMethod = decisionIt -> second;
                 }
-                
-                if (matchMethods.size() > 0)
-                {
-                    //选择最匹配的方法
-                    //备选方法，如果没有最匹配的情况下使用
-                    LuaExportMethodDescriptor *alternateMethod = NULL;
-                    for (MethodList::iterator methodIt = matchMethods.begin(); methodIt != matchMethods.end(); methodIt ++)
-                    {
-                        LuaExportMethodDescriptor *methodDesc = *methodIt;
-                        bool hasMatch = true;
-                        bool hasAlternate = false;
-                        for (int i = 0; i < methodDesc -> methodSignature().length(); i++)
-                        {
-                            if (i < signList.size())
-                            {
-                                std::string luaSign = signList[i];
-                                char nativeSign = methodDesc -> methodSignature()[i];
-                                if (luaSign == "N" && nativeSign != 'f' && nativeSign != 'd')
-                                {
-                                    hasAlternate = true;
-                                    luaSign = "I";
-                                }
-                                
-                                if (luaSign == "B" && nativeSign != 'B')
-                                {
-                                    hasMatch = false;
-                                    break;
-                                }
-                                
-                                if (luaSign == "I" && nativeSign != 'c' && nativeSign != 'i' && nativeSign != 's' && nativeSign != 'l' && nativeSign != 'q'
-                                    && nativeSign != 'C' && nativeSign != 'I' && nativeSign != 'S' && nativeSign != 'L' && nativeSign != 'Q')
-                                {
-                                    hasMatch = false;
-                                    break;
-                                }
-                                
-                                if (luaSign == "O" && nativeSign != '@')
-                                {
-                                    hasMatch = false;
-                                    break;
-                                }
-                            }
-                        }
-                        
-                        if (hasMatch)
-                        {
-                            if (hasAlternate)
-                            {
-                                //记录备选方法
-                                alternateMethod = methodDesc;
-                            }
-                            else
-                            {
-                                //设置匹配方法
-                                targetMethod = methodDesc;
-                                break;
-                            }
-                        }
-                    }
-                    
-                    if (targetMethod == NULL)
-                    {
-                        if (alternateMethod != NULL)
-                        {
-                            //使用备选方法
-                            targetMethod = alternateMethod;
-                        }
-                        else
-                        {
-                            //没有最匹配则使用第一个方法
-                            targetMethod = *(matchMethods.begin());
-                        }
-                    }
-                    
-                    //设置方法映射
-                    _methodsMapping[luaMethodSignStr] = targetMethod;
-                }
-            }
-            else
-            {
-                targetMethod = methodIt -> second;
             }
         }
         else
         {
-            //不带参数
-            for (MethodList::iterator it = methodList.begin(); it != methodList.end(); it++)
-            {
-                LuaExportMethodDescriptor *methodDesc = *it;
-                if (methodDesc -> methodSignature() == "")
-                {
-                    targetMethod = methodDesc;
-                    break;
-                }
-            }
+            //参数过多未编译入决策表，直接匹配
+            targetMethod = matchMethod(methodList, arguments, startIndex);
         }
-        
-        return targetMethod;
     }
-    else if (methodList.size() == 1)
+
+    if (cache != NULL && targetMethod != NULL && (!overloaded || hasSignature))
     {
-        return *(methodList.begin());
+        cache -> typeDescriptor = this;
+        cache -> version = _methodsVersion;
+        cache -> overloaded = overloaded;
+        cache -> signature = signature;
+        cache -> methodDescriptor = targetMethod;
     }
-    
-    return NULL;
+
+    return targetMethod;
 }
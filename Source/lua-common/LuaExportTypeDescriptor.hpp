@@ -13,6 +13,7 @@
 #include <string>
 #include <map>
 #include <list>
+#include <unordered_map>
 #include "LuaObject.h"
 #include "LuaDefined.h"
 
@@ -24,11 +25,30 @@ namespace cn {
             class LuaExportPropertyDescriptor;
             class LuaObjectDescriptor;
             class LuaSession;
+            class LuaExportTypeDescriptor;
             
             typedef std::list<LuaExportMethodDescriptor *> MethodList;
             typedef std::map<std::string, MethodList> MethodMap;
-            typedef std::map<std::string, LuaExportMethodDescriptor *> MappingMethodMap;
             typedef std::map<std::string, LuaExportPropertyDescriptor *> PropertyMap;
+
+            /**
+             重载方法决策表，以参数签名为键记录匹配的方法
+             */
+            typedef std::unordered_map<unsigned long long, LuaExportMethodDescriptor *> MethodDecisionTable;
+            typedef std::map<std::string, MethodDecisionTable> MethodDecisionTableMap;
+
+            /**
+             方法调用点缓存，保存在方法路由闭包中，记录上一次调用匹配的方法。
+             类型描述及方法版本一致时，非重载方法直接使用缓存，重载方法仅需比较参数签名。
+             */
+            typedef struct
+            {
+                LuaExportTypeDescriptor *typeDescriptor;        //类型描述
+                unsigned int version;                           //方法版本
+                bool overloaded;                                //是否为重载方法
+                unsigned long long signature;                   //参数签名
+                LuaExportMethodDescriptor *methodDescriptor;    //匹配的方法
+            } LuaMethodCallSiteCache;
             
             /**
              Lua类型描述
@@ -138,7 +158,17 @@ namespace cn {
                  @param arguments 传入参数
                  @return 方法描述
                  */
-                LuaExportMethodDescriptor* getClassMethod(std::string const& methodName, LuaArgumentList arguments);
+                LuaExportMethodDescriptor* getClassMethod(std::string const& methodName, LuaArgumentList const& arguments);
+
+                /**
+                 获取类方法
+
+                 @param methodName 方法名称
+                 @param arguments 传入参数
+                 @param cache 调用点缓存
+                 @return 方法描述
+                 */
+                LuaExportMethodDescriptor* getClassMethod(std::string const& methodName, LuaArgumentList const& arguments, LuaMethodCallSiteCache *cache);
                 
                 /**
                  获取实例方法
@@ -147,7 +177,17 @@ namespace cn {
                  @param arguments 传入参数
                  @return 方法描述
                  */
-                LuaExportMethodDescriptor* getInstanceMethod(std::string const& methodName, LuaArgumentList arguments);
+                LuaExportMethodDescriptor* getInstanceMethod(std::string const& methodName, LuaArgumentList const& arguments);
+
+                /**
+                 获取实例方法
+
+                 @param methodName 方法名称
+                 @param arguments 传入参数
+                 @param cache 调用点缓存
+                 @return 方法描述
+                 */
+                LuaExportMethodDescriptor* getInstanceMethod(std::string const& methodName, LuaArgumentList const& arguments, LuaMethodCallSiteCache *cache);
                 
                 /**
                  获取属性
@@ -156,6 +196,20 @@ namespace cn {
                  @return 属性对象
                  */
                 LuaExportPropertyDescriptor* getProperty(std::string const& propertyName);
+
+            public:
+
+                /**
+                 获取成员版本，任意类型添加属性或原型成员发生变化时更新，用于使扁平化的实例成员查找表失效
+
+                 @return 成员版本
+                 */
+                static unsigned int membersVersion();
+
+                /**
+                 更新成员版本
+                 */
+                static void updateMembersVersion();
                 
             public:
                 
@@ -222,9 +276,19 @@ namespace cn {
                 LuaExportTypeDescriptor *_parentTypeDescriptor;
                 
                 /**
-                 方法映射表，用于提供匹配重载方法的效率，第一次调用方法时会将最匹配的方法记录入该表，以后可从该表中取出对应的方法。
+                 类方法决策表，用于提高匹配重载方法的效率。添加方法时为每种参数签名预先编译出最匹配的方法，调用时只读，可在多个上下文间共享。
+                 */
+                MethodDecisionTableMap _classMethodDecisions;
+
+                /**
+                 实例方法决策表
+                 */
+                MethodDecisionTableMap _instanceMethodDecisions;
+
+                /**
+                 方法版本，添加方法时更新，用于使调用点缓存失效
                  */
-                MappingMethodMap _methodsMapping;
+                unsigned int _methodsVersion;
                 
                 /**
                  过滤方法
@@ -232,9 +296,10 @@ namespace cn {
                  @param methodName 方法名称
                  @param arguments 传入参数
                  @param isStatic 是否为静态方法
+                 @param cache 调用点缓存，可以为NULL
                  @return 方法描述
                  */
-                LuaExportMethodDescriptor* filterMethod(std::string const& methodName, LuaArgumentList arguments, bool isStatic);
+                LuaExportMethodDescriptor* filterMethod(std::string const& methodName, LuaArgumentList const& arguments, bool isStatic, LuaMethodCallSiteCache *cache);
             };
             
         }
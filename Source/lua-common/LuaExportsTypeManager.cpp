@@ -21,9 +21,25 @@
 #include "StringUtils.h"
 
 #include <algorithm>
+#include <string.h>
 
 using namespace cn::vimfung::luascriptcore;
 
+/**
+ 以字符串地址查找成员的键的最大长度，不超过该长度的字符串在Lua中是唯一的
+ */
+#define LUA_MEMBER_KEY_MAX_LENGTH 40
+
+/**
+ 以字符串地址查找成员的键的最大数量，超过后使用键名查找
+ */
+#define LUA_MEMBER_KEY_MAX_COUNT 4096
+
+/**
+ 非导出类型名称的最大记录数量，超出时清空重新记录
+ */
+#define LUA_UNEXPORTABLE_NAME_MAX_COUNT 1024
+
 
 /**
  * 类型映射处理
@@ -61,18 +77,15 @@ static int typeMappingHandler(lua_State *state)
 }
 
 /**
- *  创建对象时处理
+ *  创建对象
  *
  *  @param state 状态机
- *
- *  @return 参数数量
+ *  @param hasError 是否产生异常，产生异常时异常信息位于栈顶
  */
-static int objectCreateHandler (lua_State *state)
+static void createObject(lua_State *state, bool &hasError)
 {
     LuaExportsTypeManager *manager = (LuaExportsTypeManager *)LuaEngineAdapter::toPointer(state, LuaEngineAdapter::upValueIndex(1));
 
-    LuaSession *session = manager -> context() -> makeSession(state, false);
-
     LuaExportTypeDescriptor *typeDescriptor = NULL;
     LuaEngineAdapter::getField(state, 1, "_nativeType");
     if (LuaEngineAdapter::type(state, -1) == LUA_TLIGHTUSERDATA)
@@ -81,23 +94,53 @@ static int objectCreateHandler (lua_State *state)
     }
     LuaEngineAdapter::pop(state, 1);
 
-    if (typeDescriptor != NULL)
+    if (typeDescriptor == NULL)
     {
-        LuaObjectDescriptor *objectDescriptor = typeDescriptor -> createInstance(session);
+        hasError = true;
+        LuaEngineAdapter::pushString(state, "can't construct instance, Invalid type!");
+        return;
+    }
+
+    LuaSessionScope scope(state, manager -> context(), false);
+    LuaSession *session = scope.getSession();
+
+    LuaObjectDescriptor *objectDescriptor = typeDescriptor -> createInstance(session);
 
-        session -> checkException();
+    std::string errMessage;
+    if (session -> takeException(errMessage))
+    {
+        if (objectDescriptor != NULL)
+        {
+            objectDescriptor -> release();
+        }
 
-        manager -> _initLuaObject(objectDescriptor);
-        objectDescriptor -> release();
+        hasError = true;
+        LuaEngineAdapter::pushString(state, errMessage.c_str());
+        return;
     }
-    else
+
+    manager -> _initLuaObject(objectDescriptor);
+    objectDescriptor -> release();
+}
+
+/**
+ *  创建对象时处理
+ *
+ *  @param state 状态机
+ *
+ *  @return 参数数量
+ */
+static int objectCreateHandler (lua_State *state)
+{
+    bool hasError = false;
+    createObject(state, hasError);
+
+    if (hasError)
     {
-        LuaEngineAdapter::error(state, "can't construct instance, Invalid type!");
+        //会话已在createObject返回时离开，抛出异常中断执行不会导致泄露
+        LuaEngineAdapter::error(state, LuaEngineAdapter::toString(state, -1));
     }
 
-    
-    manager -> context() -> destorySession(session);
-    
     return 1;
 }
 
@@ -453,115 +496,124 @@ static int instanceOfHandler (lua_State *state)
 }
 
 /**
- 类方法路由处理器
- 
+ 调用类方法
+
  @param state 状态
+ @param hasError 是否产生异常，产生异常时异常信息位于栈顶
  @return 返回参数数量
  */
-static int classMethodRouteHandler(lua_State *state)
+static int invokeClassMethod(lua_State *state, bool &hasError)
 {
     int retCount = 0;
-    
+
     LuaExportsTypeManager *manager = (LuaExportsTypeManager *)LuaEngineAdapter::toPointer(state, LuaEngineAdapter::upValueIndex(1));
     const char *methodName = LuaEngineAdapter::toString(state, LuaEngineAdapter::upValueIndex(2));
 
-    if (LuaEngineAdapter::type(state, 1) != LUA_TTABLE)
+    LuaExportTypeDescriptor *typeDescriptor = NULL;
+    LuaEngineAdapter::getField(state, 1, "_nativeType");
+    if (LuaEngineAdapter::type(state, -1) == LUA_TLIGHTUSERDATA)
     {
-        LuaEngineAdapter::error(state, "please use the colon syntax to call the method");
+        typeDescriptor = (LuaExportTypeDescriptor *)LuaEngineAdapter::toPointer(state, -1);
     }
-    else
+    LuaEngineAdapter::pop(state, 1);
+
+    if (typeDescriptor == NULL)
     {
-        LuaContext *context = manager -> context();
-        LuaSession *session = context -> makeSession(state, false);
+        hasError = true;
+        std::string errMsg = StringUtils::format("call `%s` method fail : invalid type", methodName);
+        LuaEngineAdapter::pushString(state, errMsg.c_str());
+        return 0;
+    }
 
-        LuaExportTypeDescriptor *typeDescriptor = NULL;
-        LuaEngineAdapter::getField(state, 1, "_nativeType");
-        if (LuaEngineAdapter::type(state, -1) == LUA_TLIGHTUSERDATA)
+    LuaSessionScope scope(state, manager -> context(), false);
+    LuaSession *session = scope.getSession();
+
+    LuaArgumentList args;
+    session -> parseArguments(args, 2);
+
+    LuaMethodCallSiteCache *cache = (LuaMethodCallSiteCache *)LuaEngineAdapter::toUserdata(state, LuaEngineAdapter::upValueIndex(3));
+    LuaExportMethodDescriptor *methodDescriptor = typeDescriptor -> getClassMethod(methodName, args, cache);
+    if (methodDescriptor != NULL)
+    {
+        LuaValue *retValue = methodDescriptor -> invoke(session, args);
+        if (retValue != NULL)
         {
-            typeDescriptor = (LuaExportTypeDescriptor *)LuaEngineAdapter::toPointer(state, -1);
+            retCount = session -> setReturnValue(retValue);
+            //释放返回值
+            retValue -> release();
         }
-        LuaEngineAdapter::pop(state, 1);
+    }
 
-        if (typeDescriptor != NULL)
-        {
-            LuaArgumentList args;
-            session -> parseArguments(args, 2);
+    //释放参数内存
+    for (LuaArgumentList::iterator it = args.begin(); it != args.end() ; ++it)
+    {
+        LuaValue *item = *it;
+        item -> release();
+    }
 
-            LuaExportMethodDescriptor *methodDescriptor = typeDescriptor -> getClassMethod(methodName, args);
-            if (methodDescriptor != NULL)
-            {
-                LuaValue *retValue = methodDescriptor -> invoke(session, args);
+    //检测异常
+    std::string errMessage;
+    if (session -> takeException(errMessage))
+    {
+        hasError = true;
+        LuaEngineAdapter::pushString(state, errMessage.c_str());
+    }
 
-                //检测异常
-                session -> checkException();
+    return retCount;
+}
 
-                if (retValue != NULL)
-                {
-                    retCount = session -> setReturnValue(retValue);
-                    //释放返回值
-                    retValue -> release();
-                }
-            }
+/**
+ 类方法路由处理器
+ 
+ @param state 状态
+ @return 返回参数数量
+ */
+static int classMethodRouteHandler(lua_State *state)
+{
+    if (LuaEngineAdapter::type(state, 1) != LUA_TTABLE)
+    {
+        LuaEngineAdapter::error(state, "please use the colon syntax to call the method");
+        return 0;
+    }
 
-            //释放参数内存
-            for (LuaArgumentList::iterator it = args.begin(); it != args.end() ; ++it)
-            {
-                LuaValue *item = *it;
-                item -> release();
-            }
-        }
-        else
-        {
-            std::string errMsg = StringUtils::format("call `%s` method fail : invalid type", methodName);
-            LuaEngineAdapter::error(state, errMsg.c_str());
-        }
+    bool hasError = false;
+    int retCount = invokeClassMethod(state, hasError);
 
-        //销毁会话
-        context -> destorySession(session);
+    if (hasError)
+    {
+        //会话已在invokeClassMethod返回时离开，抛出异常中断执行不会导致泄露
+        LuaEngineAdapter::error(state, LuaEngineAdapter::toString(state, -1));
     }
-    
+
     return retCount;
 }
 
 /**
- 实例方法路由处理
- 
+ 调用实例方法
+
  @param state 状态
+ @param hasError 是否产生异常，产生异常时异常信息位于栈顶
  @return 参数个数
  */
-static int instanceMethodRouteHandler(lua_State *state)
+static int invokeInstanceMethod(lua_State *state, bool &hasError)
 {
     int returnCount = 0;
-    
+
     LuaExportsTypeManager *manager = (LuaExportsTypeManager *)LuaEngineAdapter::toPointer(state, LuaEngineAdapter::upValueIndex(1));
     LuaExportTypeDescriptor *typeDescriptor = (LuaExportTypeDescriptor *)LuaEngineAdapter::toPointer(state, LuaEngineAdapter::upValueIndex(2));
     std::string methodName = LuaEngineAdapter::toString(state, LuaEngineAdapter::upValueIndex(3));
-    
-    LuaContext *context = manager -> context();
-    
-    if (LuaEngineAdapter::type(state, 1) != LUA_TUSERDATA)
-    {
-        std::string errMsg = "call " + methodName + " method error : missing self parameter, please call by instance:methodName(param)";
-        LuaEngineAdapter::error(state, errMsg.c_str());
-        
-        //回收内存
-        LuaEngineAdapter::GC(state, LUA_GCCOLLECT, 0);
-        
-        return 0;
-    }
-    
-    LuaSession *session = context -> makeSession(state, false);
+
+    LuaSessionScope scope(state, manager -> context(), false);
+    LuaSession *session = scope.getSession();
+
     LuaArgumentList args;
     session -> parseArguments(args);
     
-    LuaExportMethodDescriptor *methodDescriptor = typeDescriptor -> getInstanceMethod(methodName, args);
+    LuaMethodCallSiteCache *cache = (LuaMethodCallSiteCache *)LuaEngineAdapter::toUserdata(state, LuaEngineAdapter::upValueIndex(4));
+    LuaExportMethodDescriptor *methodDescriptor = typeDescriptor -> getInstanceMethod(methodName, args, cache);
     if (methodDescriptor != NULL)
     {
         LuaValue *retValue = methodDescriptor -> invoke(session, args);
-
-        //检测异常
-        session -> checkException();
-       
         if (retValue != NULL)
         {
             returnCount = session -> setReturnValue(retValue);
@@ -576,57 +628,230 @@ static int instanceMethodRouteHandler(lua_State *state)
         LuaValue *item = *it;
         item -> release();
     }
-    
-    context -> destorySession(session);
+
+    //检测异常
+    std::string errMessage;
+    if (session -> takeException(errMessage))
+    {
+        hasError = true;
+        LuaEngineAdapter::pushString(state, errMessage.c_str());
+    }
     
     return returnCount;
 }
 
 /**
- 实例对象更新索引处理
+ 实例方法路由处理
  
+ @param state 状态
+ @return 参数个数
+ */
+static int instanceMethodRouteHandler(lua_State *state)
+{
+    if (LuaEngineAdapter::type(state, 1) != LUA_TUSERDATA)
+    {
+        std::string methodName = LuaEngineAdapter::toString(state, LuaEngineAdapter::upValueIndex(3));
+        std::string errMsg = "call " + methodName + " method error : missing self parameter, please call by instance:methodName(param)";
+        LuaEngineAdapter::error(state, errMsg.c_str());
+        
+        //回收内存
+        LuaEngineAdapter::GC(state, LUA_GCCOLLECT, 0);
+        
+        return 0;
+    }
+
+    bool hasError = false;
+    int returnCount = invokeInstanceMethod(state, hasError);
+
+    if (hasError)
+    {
+        //会话已在invokeInstanceMethod返回时离开，抛出异常中断执行不会导致泄露
+        LuaEngineAdapter::error(state, LuaEngineAdapter::toString(state, -1));
+    }
+
+    return returnCount;
+}
+
+/**
+ 准备实例对象的键，数值键会被转换为字符串，与字段名保持一致
+
+ @param state 状态
+ @param keyIndex 键索引
+ @return true 表示键为字符串，否则为其他类型
+ */
+static bool prepareInstanceKey(lua_State *state, int keyIndex)
+{
+    if (LuaEngineAdapter::type(state, keyIndex) == LUA_TNUMBER)
+    {
+        LuaEngineAdapter::toString(state, keyIndex);
+    }
+
+    return LuaEngineAdapter::type(state, keyIndex) == LUA_TSTRING;
+}
+
+/**
+ 直接设置基础类型属性值，无需创建值对象
+
+ @param state 状态
+ @param propertyDescriptor 属性描述
+ @param instance 实例对象
+ @param valueIndex 值索引
+ @return true 表示已设置，属性不是基础类型或值类型不匹配时返回false
+ */
+static bool setPrimitivePropertyValue(lua_State *state,
+                                      LuaExportPropertyDescriptor *propertyDescriptor,
+                                      LuaObjectDescriptor *instance,
+                                      int valueIndex)
+{
+    LuaPrimitiveValue value;
+    switch (propertyDescriptor -> primitiveType())
+    {
+        case LuaValueTypeNumber:
+            if (LuaEngineAdapter::type(state, valueIndex) != LUA_TNUMBER)
+            {
+                return false;
+            }
+            value.numberValue = LuaEngineAdapter::toNumber(state, valueIndex);
+            break;
+        case LuaValueTypeInteger:
+            if (LuaEngineAdapter::type(state, valueIndex) != LUA_TNUMBER || !LuaEngineAdapter::isInteger(state, valueIndex))
+            {
+                return false;
+            }
+            value.integerValue = LuaEngineAdapter::toInteger(state, valueIndex);
+            break;
+        case LuaValueTypeBoolean:
+            if (LuaEngineAdapter::type(state, valueIndex) != LUA_TBOOLEAN)
+            {
+                return false;
+            }
+            value.booleanValue = LuaEngineAdapter::toBoolean(state, valueIndex);
+            break;
+        default:
+            return false;
+    }
+
+    propertyDescriptor -> invokePrimitiveSetter(instance, value);
+    return true;
+}
+
+/**
+ 直接将基础类型属性值入栈，无需创建值对象
+
+ @param state 状态
+ @param propertyDescriptor 属性描述
+ @param instance 实例对象
+ @return true 表示已入栈，属性不是基础类型时返回false
+ */
+static bool pushPrimitivePropertyValue(lua_State *state,
+                                       LuaExportPropertyDescriptor *propertyDescriptor,
+                                       LuaObjectDescriptor *instance)
+{
+    switch (propertyDescriptor -> primitiveType())
+    {
+        case LuaValueTypeNumber:
+            LuaEngineAdapter::pushNumber(state, propertyDescriptor -> invokePrimitiveGetter(instance).numberValue);
+            return true;
+        case LuaValueTypeInteger:
+            LuaEngineAdapter::pushInteger(state, propertyDescriptor -> invokePrimitiveGetter(instance).integerValue);
+            return true;
+        case LuaValueTypeBoolean:
+            LuaEngineAdapter::pushBoolean(state, propertyDescriptor -> invokePrimitiveGetter(instance).booleanValue);
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ 设置实例对象索引值
+
  @param state 状态机
- @return 参数数量
+ @param hasError 是否产生异常，产生异常时异常信息位于栈顶
  */
-static int instanceNewIndexHandler (lua_State *state)
+static void setInstanceIndexValue(lua_State *state, bool &hasError)
 {
     LuaExportsTypeManager *manager = (LuaExportsTypeManager *)LuaEngineAdapter::toPointer(state, LuaEngineAdapter::upValueIndex(1));
-    LuaObjectDescriptor *instance = (LuaObjectDescriptor *)LuaEngineAdapter::toPointer(state, LuaEngineAdapter::upValueIndex(2));
-    
-    LuaSession *session = manager -> context() -> makeSession(state, true);
-    
-    std::string key = LuaEngineAdapter::toString(state, 2);
-    
-    LuaArgumentList arguments;
-    
-    //检测是否存在类型属性
-    LuaExportPropertyDescriptor *propertyDescriptor = manager -> _findInstanceProperty(session,
-                                                                                      instance -> getTypeDescriptor(),
-                                                                                      key);
+
+    LuaUserdataRef ref = (LuaUserdataRef)LuaEngineAdapter::toUserdata(state, 1);
+    if (ref == NULL)
+    {
+        return;
+    }
+
+    LuaObjectDescriptor *instance = (LuaObjectDescriptor *)ref -> value;
+
+    //检测是否存在类型属性，原型成员不作为属性处理
+    LuaExportPropertyDescriptor *propertyDescriptor = NULL;
+    if (prepareInstanceKey(state, 2))
+    {
+        bool isPrototypeMember = false;
+        propertyDescriptor = manager -> _findInstanceMember(state, instance -> getTypeDescriptor(), 2, isPrototypeMember);
+        if (isPrototypeMember)
+        {
+            LuaEngineAdapter::pop(state, 1);
+        }
+    }
+
     if (propertyDescriptor != NULL)
     {
-        //调用对象属性
+        if (propertyDescriptor -> canWrite() && setPrimitivePropertyValue(state, propertyDescriptor, instance, 3))
+        {
+            return;
+        }
+
+        //调用对象属性，会话在栈上创建
+        LuaSessionScope scope(state, manager -> context(), true);
+        LuaSession *session = scope.getSession();
+
         LuaValue *value = LuaValue::TmpValue(manager -> context(), 3);
         propertyDescriptor -> invokeSetter(session, instance, value);
-        //检测异常
-        session -> checkException();
         value -> release();
+
+        std::string errMessage;
+        if (session -> takeException(errMessage))
+        {
+            hasError = true;
+            LuaEngineAdapter::pushString(state, errMessage.c_str());
+        }
     }
     else
     {
-        //先找到实例对象的元表，向元表添加属性
-        LuaEngineAdapter::getMetatable(state, 1);
-        if (LuaEngineAdapter::isTable(state, -1))
+        //向实例的字段表添加属性，字段表在第一次设置时创建
+        LuaEngineAdapter::getUserValue(state, 1);
+        if (!LuaEngineAdapter::isTable(state, -1))
         {
-            LuaEngineAdapter::pushValue(state, 2);
-            LuaEngineAdapter::pushValue(state, 3);
-            LuaEngineAdapter::rawSet(state, -3);
+            LuaEngineAdapter::pop(state, 1);
+
+            LuaEngineAdapter::newTable(state);
+            LuaEngineAdapter::pushValue(state, -1);
+            LuaEngineAdapter::setUserValue(state, 1);
         }
-        
+
+        LuaEngineAdapter::pushValue(state, 2);
+        LuaEngineAdapter::pushValue(state, 3);
+        LuaEngineAdapter::rawSet(state, -3);
+
         LuaEngineAdapter::pop(state, 1);
     }
-    
-    manager -> context() -> destorySession(session);
+}
+
+/**
+ 实例对象更新索引处理
+ 
+ @param state 状态机
+ @return 参数数量
+ */
+static int instanceNewIndexHandler (lua_State *state)
+{
+    bool hasError = false;
+    setInstanceIndexValue(state, hasError);
+
+    if (hasError)
+    {
+        //会话已在setInstanceIndexValue返回时离开，抛出异常中断执行不会导致泄露
+        LuaEngineAdapter::error(state, LuaEngineAdapter::toString(state, -1));
+    }
 
     return 0;
 }
@@ -640,43 +865,142 @@ static int instanceNewIndexHandler (lua_State *state)
 static int globalIndexMetaMethodHandler(lua_State *state)
 {
     LuaExportsTypeManager *exporter = (LuaExportsTypeManager *)LuaEngineAdapter::toPointer(state, LuaEngineAdapter::upValueIndex(1));
-    
+
+    if (LuaEngineAdapter::type(state, 2) == LUA_TNUMBER)
+    {
+        //数值键转换为字符串
+        LuaEngineAdapter::toString(state, 2);
+    }
+
+    LuaEngineAdapter::pushValue(state, 2);
+    LuaEngineAdapter::rawGet(state, 1);
+    if (!LuaEngineAdapter::isNil(state, -1)
+        || LuaEngineAdapter::type(state, 2) != LUA_TSTRING
+        || exporter -> _isUnexportableName(state, 2))
+    {
+        return 1;
+    }
+
     LuaSession *session = exporter -> context() -> makeSession(state, true);
     
     //获取key
     std::string key = LuaEngineAdapter::toString(state, 2);
     
-    LuaEngineAdapter::rawGet(state, 1);
-    if (LuaEngineAdapter::isNil(state, -1))
+    //检测是否该key是否为导出类型
+    LuaExportTypeDescriptor *typeDescriptor = exporter -> _getMappingType(key);
+    if (typeDescriptor != NULL)
+    {
+        //为导出类型
+        LuaEngineAdapter::pop(state, 1);
+
+        LuaEngineAdapter::pushString(state, typeDescriptor->typeName().c_str());
+        LuaEngineAdapter::rawGet(state, 1);
+
+        if (LuaEngineAdapter::isNil(state, -1))
+        {
+            LuaEngineAdapter::pop(state, 1);
+
+            //导出类型
+            exporter -> _prepareExportsType(state, typeDescriptor);
+
+            //重新获取
+            LuaEngineAdapter::pushString(state, typeDescriptor->typeName().c_str());
+            LuaEngineAdapter::rawGet(state, 1);
+        }
+    }
+    else
+    {
+        //记录非导出类型名称，再次访问时不再通知上下文加载原生类型
+        exporter -> _addUnexportableName(state, 2);
+    }
+    
+    exporter -> context() -> destorySession(session);
+    
+    return 1;
+}
+
+/**
+ 获取实例对象索引值
+
+ @param state 状态
+ @param hasError 是否产生异常，产生异常时异常信息位于栈顶
+ @return 返回参数数量
+ */
+static int getInstanceIndexValue(lua_State *state, bool &hasError)
+{
+    LuaExportsTypeManager *exporter = (LuaExportsTypeManager *)LuaEngineAdapter::toPointer(state, LuaEngineAdapter::upValueIndex(1));
+
+    LuaUserdataRef ref = (LuaUserdataRef)LuaEngineAdapter::toUserdata(state, 1);
+    if (ref == NULL)
+    {
+        LuaEngineAdapter::pushNil(state);
+        return 1;
+    }
+
+    LuaObjectDescriptor *instance = (LuaObjectDescriptor *)ref -> value;
+
+    bool isStringKey = prepareInstanceKey(state, 2);
+
+    //检测实例的字段表是否包含指定值
+    LuaEngineAdapter::getUserValue(state, 1);
+    if (LuaEngineAdapter::isTable(state, -1))
     {
-        //检测是否该key是否为导出类型
-        LuaExportTypeDescriptor *typeDescriptor = exporter -> _getMappingType(key);
-        if (typeDescriptor != NULL)
+        LuaEngineAdapter::pushValue(state, 2);
+        LuaEngineAdapter::rawGet(state, -2);
+        if (!LuaEngineAdapter::isNil(state, -1))
         {
-            //为导出类型
-            LuaEngineAdapter::pop(state, 1);
+            return 1;
+        }
+        LuaEngineAdapter::pop(state, 1);
+    }
+    LuaEngineAdapter::pop(state, 1);
 
-            LuaEngineAdapter::pushString(state, typeDescriptor->typeName().c_str());
-            LuaEngineAdapter::rawGet(state, 1);
+    if (!isStringKey)
+    {
+        LuaEngineAdapter::pushNil(state);
+        return 1;
+    }
 
-            if (LuaEngineAdapter::isNil(state, -1))
-            {
-                LuaEngineAdapter::pop(state, 1);
+    //查找原型成员或属性，原型成员已入栈
+    bool isPrototypeMember = false;
+    LuaExportPropertyDescriptor *propertyDescriptor = exporter -> _findInstanceMember(state, instance -> getTypeDescriptor(), 2, isPrototypeMember);
+    if (isPrototypeMember)
+    {
+        return 1;
+    }
 
-                //导出类型
-                exporter -> _prepareExportsType(state, typeDescriptor);
+    if (propertyDescriptor == NULL || !propertyDescriptor -> canRead())
+    {
+        LuaEngineAdapter::pushNil(state);
+        return 1;
+    }
 
-                //重新获取
-                LuaEngineAdapter::pushString(state, typeDescriptor->typeName().c_str());
-                LuaEngineAdapter::rawGet(state, 1);
-            }
+    if (pushPrimitivePropertyValue(state, propertyDescriptor, instance))
+    {
+        return 1;
+    }
 
-        }
+    //调用属性获取方法，会话在栈上创建
+    int returnCount = 0;
+
+    LuaSessionScope scope(state, exporter -> context(), true);
+    LuaSession *session = scope.getSession();
+
+    LuaValue *retValue = propertyDescriptor -> invokeGetter(session, instance);
+    returnCount = session -> setReturnValue(retValue);
+    if (retValue != NULL)
+    {
+        retValue -> release();
     }
-    
-    exporter -> context() -> destorySession(session);
-    
-    return 1;
+
+    std::string errMessage;
+    if (session -> takeException(errMessage))
+    {
+        hasError = true;
+        LuaEngineAdapter::pushString(state, errMessage.c_str());
+    }
+
+    return returnCount;
 }
 
 /**
@@ -687,33 +1011,16 @@ static int globalIndexMetaMethodHandler(lua_State *state)
  */
 static int instanceIndexHandler(lua_State *state)
 {
-    int retValueCount = 1;
-    
-    LuaExportsTypeManager *exporter = (LuaExportsTypeManager *)LuaEngineAdapter::toPointer(state, LuaEngineAdapter::upValueIndex(1));
-    LuaObjectDescriptor *instance = (LuaObjectDescriptor *)LuaEngineAdapter::toPointer(state, LuaEngineAdapter::upValueIndex(2));
-
-    LuaSession *session = exporter -> context() -> makeSession(state, true);
-    
-    std::string key = LuaEngineAdapter::toString(state, 2);
+    bool hasError = false;
+    int returnCount = getInstanceIndexValue(state, hasError);
 
-    //检测元表是否包含指定值
-    LuaEngineAdapter::getMetatable(state, 1);
-    LuaEngineAdapter::pushValue(state, 2);
-    LuaEngineAdapter::rawGet(state, -2);
-    
-    if (LuaEngineAdapter::isNil(state, -1))
+    if (hasError)
     {
-        LuaEngineAdapter::pop(state, 1);
-        retValueCount = exporter -> _getInstancePropertyValue(session, instance, instance -> getTypeDescriptor(), key);
-        //检测异常
-        session -> checkException();
+        //会话已在getInstanceIndexValue返回时离开，抛出异常中断执行不会导致泄露
+        LuaEngineAdapter::error(state, LuaEngineAdapter::toString(state, -1));
     }
-    
-    LuaEngineAdapter::remove(state, -1-retValueCount);
-    
-    exporter -> context() -> destorySession(session);
-    
-    return retValueCount;
+
+    return returnCount;
 }
 
 /**
@@ -769,7 +1076,7 @@ static int prototypeNewIndexHandler (lua_State *state)
                 LuaValue *propertyNameValue = LuaValue::ValueByIndex(exporter -> context(), 2);
                 
                 LuaExportPropertyDescriptor *propertyDescriptor = new LuaExportPropertyDescriptor(propertyNameValue -> toString(), getter, setter);
-                typeDescriptor -> addProperty(propertyDescriptor -> name(), propertyDescriptor);
+                exporter -> _addLuaProperty(typeDescriptor, propertyDescriptor);
                 propertyDescriptor -> release();
             }
         }
@@ -779,6 +1086,9 @@ static int prototypeNewIndexHandler (lua_State *state)
     {
         //直接设置
         LuaEngineAdapter::rawSet(state, 1);
+
+        //原型成员变更，使实例成员查找表失效
+        LuaExportTypeDescriptor::updateMembersVersion();
     }
     
     exporter -> context() -> destorySession(session);
@@ -790,6 +1100,12 @@ LuaExportsTypeManager::LuaExportsTypeManager(LuaContext *context, std::string co
 {
     _context = context;
     _platform = platform;
+    _memberKeysRef = LUA_NOREF;
+    _memberKeyCount = 0;
+    _exportTypesVersion = 0;
+    _unexportableNamesRef = LUA_NOREF;
+    _unexportableNamesVersion = 0;
+    _unexportableNameCount = 0;
     
     _setupExportEnv();
     _setupExportType();
@@ -797,6 +1113,15 @@ LuaExportsTypeManager::LuaExportsTypeManager(LuaContext *context, std::string co
 
 LuaExportsTypeManager::~LuaExportsTypeManager()
 {
+    //释放Lua中定义的属性
+    for (std::unordered_map<LuaExportTypeDescriptor*, PropertyMap>::iterator typeIt = _luaProperties.begin(); typeIt != _luaProperties.end(); typeIt++)
+    {
+        for (PropertyMap::iterator propIt = typeIt -> second.begin(); propIt != typeIt -> second.end(); propIt++)
+        {
+            propIt -> second -> release();
+        }
+    }
+
     //释放导出类型
     std::map<std::string, LuaExportTypeDescriptor*>::iterator it;
     for (it = _exportTypes.begin(); it != _exportTypes.end(); it++)
@@ -829,7 +1154,37 @@ void LuaExportsTypeManager::exportsType(LuaExportTypeDescriptor *typeDescriptor)
     {
         typeDescriptor -> retain();
         _exportTypes[typeDescriptor -> nativeTypeName()] = typeDescriptor;
+        _exportTypesVersion++;
+    }
+}
+
+void LuaExportsTypeManager::importTypes(LuaExportsTypeManager *manager)
+{
+    if (manager == NULL || manager == this)
+    {
+        return;
+    }
+
+    //导入类型映射
+    for (std::map<std::string, std::string>::iterator it = manager -> _exportTypesMapping.begin(); it != manager -> _exportTypesMapping.end(); ++it)
+    {
+        if (_exportTypesMapping.find(it -> first) == _exportTypesMapping.end())
+        {
+            _exportTypesMapping[it -> first] = it -> second;
+        }
+    }
+
+    //导入类型描述
+    for (std::map<std::string, LuaExportTypeDescriptor*>::iterator it = manager -> _exportTypes.begin(); it != manager -> _exportTypes.end(); ++it)
+    {
+        if (_exportTypes.find(it -> first) == _exportTypes.end())
+        {
+            it -> second -> retain();
+            _exportTypes[it -> first] = it -> second;
+        }
     }
+
+    _exportTypesVersion++;
 }
 
 bool LuaExportsTypeManager::_mappingType(std::string const& platform, std::string const& name, std::string const& alias)
@@ -837,6 +1192,7 @@ bool LuaExportsTypeManager::_mappingType(std::string const& platform, std::strin
     if (platform == _platform)
     {
         _exportTypesMapping[alias] = name;
+        _exportTypesVersion++;
         return true;
     }
     
@@ -1076,6 +1432,9 @@ void LuaExportsTypeManager::_exportsType(lua_State *state, LuaExportTypeDescript
 
         LuaEngineAdapter::pop(state, 1);
 
+        //新增原型表，使实例成员查找表失效
+        LuaExportTypeDescriptor::updateMembersVersion();
+
     });
 }
 
@@ -1093,7 +1452,12 @@ void LuaExportsTypeManager::_exportsClassMethods(lua_State *state, LuaExportType
 
                 LuaEngineAdapter::pushLightUserdata(state, (void *)this);
                 LuaEngineAdapter::pushString(state, (*it).c_str());
-                LuaEngineAdapter::pushCClosure(state, classMethodRouteHandler, 2);
+
+                //调用点缓存
+                LuaMethodCallSiteCache *cache = (LuaMethodCallSiteCache *)LuaEngineAdapter::newUserdata(state, sizeof(LuaMethodCallSiteCache));
+                memset(cache, 0, sizeof(LuaMethodCallSiteCache));
+
+                LuaEngineAdapter::pushCClosure(state, classMethodRouteHandler, 3);
 
                 LuaEngineAdapter::setField(state, -2, (*it).c_str());
             }
@@ -1122,7 +1486,12 @@ void LuaExportsTypeManager::_exportsInstanceMethods(lua_State *state, LuaExportT
                 LuaEngineAdapter::pushLightUserdata(state, (void *)this);
                 LuaEngineAdapter::pushLightUserdata(state, (void *)typeDescriptor);
                 LuaEngineAdapter::pushString(state, (*it).c_str());
-                LuaEngineAdapter::pushCClosure(state, instanceMethodRouteHandler, 3);
+
+                //调用点缓存
+                LuaMethodCallSiteCache *cache = (LuaMethodCallSiteCache *)LuaEngineAdapter::newUserdata(state, sizeof(LuaMethodCallSiteCache));
+                memset(cache, 0, sizeof(LuaMethodCallSiteCache));
+
+                LuaEngineAdapter::pushCClosure(state, instanceMethodRouteHandler, 4);
 
                 LuaEngineAdapter::setField(state, -2, (*it).c_str());
             }
@@ -1247,47 +1616,351 @@ void LuaExportsTypeManager::_bindLuaInstance(LuaObjectDescriptor *objectDescript
             objectDescriptor -> retain();
         }
 
-        //创建一个临时table作为元表，用于在lua上动态添加属性或方法
-        LuaEngineAdapter::newTable(state);
+        //清空关联值，Lua 5.1中userdata创建时会继承当前环境表
+        LuaEngineAdapter::pushNil(state);
+        LuaEngineAdapter::setUserValue(state, -2);
 
-        //设置__index元方法为路由方法，用于检测对象的属性
-        LuaEngineAdapter::pushLightUserdata(state, this);
-        LuaEngineAdapter::pushLightUserdata(state, objectDescriptor);
-        LuaEngineAdapter::pushCClosure(state, instanceIndexHandler, 2);
-        LuaEngineAdapter::setField(state, -2, "__index");
+        //设置类型实例共用的元表，用于检测对象的属性，在lua上动态添加的属性或方法保存在userdata的关联值中
+        _pushInstanceMetatable(state, objectDescriptor -> getTypeDescriptor());
+        LuaEngineAdapter::setMetatable(state, -2);
 
-        LuaEngineAdapter::pushLightUserdata(state, this);
-        LuaEngineAdapter::pushLightUserdata(state, objectDescriptor);
-        LuaEngineAdapter::pushCClosure(state, instanceNewIndexHandler, 2);
-        LuaEngineAdapter::setField(state, -2, "__newindex");
+        //将创建对象放入到_vars_表中，主要修复对象创建后，在init中调用方法或者访问属性，由于对象尚未记录在_vars_中，而循环创建lua对象，并导致栈溢出。
+        this -> context() -> getDataExchanger() -> setLuaObject(-1, objectDescriptor -> getLinkId());
 
-        LuaEngineAdapter::pushLightUserdata(state, this);
-        LuaEngineAdapter::pushCClosure(state, objectDestroyHandler, 1);
-        LuaEngineAdapter::setField(state, -2, "__gc");
+    });
+}
 
-        LuaEngineAdapter::pushLightUserdata(state, this);
-        LuaEngineAdapter::pushCClosure(state, objectToStringHandler, 1);
-        LuaEngineAdapter::setField(state, -2, "__tostring");
+void LuaExportsTypeManager::_pushInstanceMetatable(lua_State *state, LuaExportTypeDescriptor *typeDescriptor)
+{
+    std::unordered_map<LuaExportTypeDescriptor*, int>::iterator it = _instanceMetatableRefs.find(typeDescriptor);
+    if (it != _instanceMetatableRefs.end())
+    {
+        LuaEngineAdapter::rawGetI(state, LUA_REGISTRYINDEX, it -> second);
+        return;
+    }
 
-        LuaEngineAdapter::pushValue(state, -1);
-        LuaEngineAdapter::setMetatable(state, -3);
+    LuaEngineAdapter::newTable(state);
+
+    //设置__index元方法为路由方法，用于检测对象的属性
+    LuaEngineAdapter::pushLightUserdata(state, this);
+    LuaEngineAdapter::pushCClosure(state, instanceIndexHandler, 1);
+    LuaEngineAdapter::setField(state, -2, "__index");
+
+    LuaEngineAdapter::pushLightUserdata(state, this);
+    LuaEngineAdapter::pushCClosure(state, instanceNewIndexHandler, 1);
+    LuaEngineAdapter::setField(state, -2, "__newindex");
+
+    LuaEngineAdapter::pushLightUserdata(state, this);
+    LuaEngineAdapter::pushCClosure(state, objectDestroyHandler, 1);
+    LuaEngineAdapter::setField(state, -2, "__gc");
+
+    LuaEngineAdapter::pushLightUserdata(state, this);
+    LuaEngineAdapter::pushCClosure(state, objectToStringHandler, 1);
+    LuaEngineAdapter::setField(state, -2, "__tostring");
+
+    LuaEngineAdapter::getMetatable(state, typeDescriptor -> prototypeTypeName().c_str());
+    if (LuaEngineAdapter::isTable(state, -1))
+    {
+        LuaEngineAdapter::setMetatable(state, -2);
+    }
+    else
+    {
+        LuaEngineAdapter::pop(state, 1);
+    }
+
+    LuaEngineAdapter::pushValue(state, -1);
+    _instanceMetatableRefs[typeDescriptor] = LuaEngineAdapter::ref(state, LUA_REGISTRYINDEX);
+}
+
+void LuaExportsTypeManager::_addLuaProperty(LuaExportTypeDescriptor *typeDescriptor, LuaExportPropertyDescriptor *propertyDescriptor)
+{
+    propertyDescriptor -> retain();
+    propertyDescriptor -> typeDescriptor = typeDescriptor;
+
+    PropertyMap &properties = _luaProperties[typeDescriptor];
+    PropertyMap::iterator it = properties.find(propertyDescriptor -> name());
+    if (it != properties.end())
+    {
+        it -> second -> release();
+    }
+    properties[propertyDescriptor -> name()] = propertyDescriptor;
+
+    LuaExportTypeDescriptor::updateMembersVersion();
+}
+
+LuaExportPropertyDescriptor* LuaExportsTypeManager::_getLuaProperty(LuaExportTypeDescriptor *typeDescriptor, std::string const& propertyName)
+{
+    std::unordered_map<LuaExportTypeDescriptor*, PropertyMap>::iterator typeIt = _luaProperties.find(typeDescriptor);
+    if (typeIt == _luaProperties.end())
+    {
+        return NULL;
+    }
+
+    PropertyMap::iterator it = typeIt -> second.find(propertyName);
+    if (it != typeIt -> second.end())
+    {
+        return it -> second;
+    }
+
+    return NULL;
+}
+
+LuaInstanceMemberTable& LuaExportsTypeManager::_getInstanceMemberTable(LuaExportTypeDescriptor *typeDescriptor)
+{
+    LuaInstanceMemberTable &memberTable = _instanceMemberTables[typeDescriptor];
+
+    unsigned int version = LuaExportTypeDescriptor::membersVersion();
+    if (memberTable.version != version)
+    {
+        memberTable.members.clear();
+        memberTable.keyMembers.clear();
+        memberTable.version = version;
+    }
+
+    return memberTable;
+}
+
+bool LuaExportsTypeManager::_retainMemberKey(lua_State *state, int keyIndex)
+{
+    keyIndex = LuaEngineAdapter::absIndex(state, keyIndex);
+
+    if (_memberKeysRef == LUA_NOREF)
+    {
+        LuaEngineAdapter::newTable(state);
+        _memberKeysRef = LuaEngineAdapter::ref(state, LUA_REGISTRYINDEX);
+    }
+
+    LuaEngineAdapter::rawGetI(state, LUA_REGISTRYINDEX, _memberKeysRef);
 
-        LuaEngineAdapter::getMetatable(state, objectDescriptor -> getTypeDescriptor() -> prototypeTypeName().c_str());
-        if (LuaEngineAdapter::isTable(state, -1))
+    bool retained = true;
+
+    LuaEngineAdapter::pushValue(state, keyIndex);
+    LuaEngineAdapter::rawGet(state, -2);
+    if (LuaEngineAdapter::isNil(state, -1))
+    {
+        if (_memberKeyCount < LUA_MEMBER_KEY_MAX_COUNT)
         {
-            LuaEngineAdapter::setMetatable(state, -2);
+            LuaEngineAdapter::pushValue(state, keyIndex);
+            LuaEngineAdapter::pushBoolean(state, true);
+            LuaEngineAdapter::rawSet(state, -4);
+            _memberKeyCount++;
         }
         else
         {
+            retained = false;
+        }
+    }
+
+    LuaEngineAdapter::pop(state, 2);
+
+    return retained;
+}
+
+void LuaExportsTypeManager::_pushUnexportableNames(lua_State *state)
+{
+    if (_unexportableNamesRef == LUA_NOREF
+        || _unexportableNamesVersion != _exportTypesVersion
+        || _unexportableNameCount >= LUA_UNEXPORTABLE_NAME_MAX_COUNT)
+    {
+        //导出类型已变更，重建名称表
+        LuaEngineAdapter::unref(state, LUA_REGISTRYINDEX, _unexportableNamesRef);
+
+        LuaEngineAdapter::newTable(state);
+        _unexportableNamesRef = LuaEngineAdapter::ref(state, LUA_REGISTRYINDEX);
+        _unexportableNamesVersion = _exportTypesVersion;
+        _unexportableNameCount = 0;
+    }
+
+    LuaEngineAdapter::rawGetI(state, LUA_REGISTRYINDEX, _unexportableNamesRef);
+}
+
+bool LuaExportsTypeManager::_isUnexportableName(lua_State *state, int keyIndex)
+{
+    if (_unexportableNamesRef == LUA_NOREF || _unexportableNamesVersion != _exportTypesVersion)
+    {
+        return false;
+    }
+
+    keyIndex = LuaEngineAdapter::absIndex(state, keyIndex);
+
+    LuaEngineAdapter::rawGetI(state, LUA_REGISTRYINDEX, _unexportableNamesRef);
+    LuaEngineAdapter::pushValue(state, keyIndex);
+    LuaEngineAdapter::rawGet(state, -2);
+    bool unexportable = !LuaEngineAdapter::isNil(state, -1);
+    LuaEngineAdapter::pop(state, 2);
+
+    return unexportable;
+}
+
+void LuaExportsTypeManager::_addUnexportableName(lua_State *state, int keyIndex)
+{
+    keyIndex = LuaEngineAdapter::absIndex(state, keyIndex);
+
+    _pushUnexportableNames(state);
+    LuaEngineAdapter::pushValue(state, keyIndex);
+    LuaEngineAdapter::pushBoolean(state, true);
+    LuaEngineAdapter::rawSet(state, -3);
+    LuaEngineAdapter::pop(state, 1);
+
+    _unexportableNameCount++;
+}
+
+int LuaExportsTypeManager::_getPrototypeRef(lua_State *state, LuaExportTypeDescriptor *typeDescriptor)
+{
+    std::unordered_map<LuaExportTypeDescriptor*, int>::iterator it = _prototypeRefs.find(typeDescriptor);
+    if (it != _prototypeRefs.end())
+    {
+        return it -> second;
+    }
+
+    int prototypeRef = LUA_NOREF;
+
+    LuaEngineAdapter::getMetatable(state, typeDescriptor -> prototypeTypeName().c_str());
+    if (LuaEngineAdapter::isTable(state, -1))
+    {
+        //原型表创建后不会被替换，记录引用后无需再按名称查找
+        prototypeRef = LuaEngineAdapter::ref(state, LUA_REGISTRYINDEX);
+        _prototypeRefs[typeDescriptor] = prototypeRef;
+    }
+    else
+    {
+        LuaEngineAdapter::pop(state, 1);
+    }
+
+    return prototypeRef;
+}
+
+LuaExportPropertyDescriptor* LuaExportsTypeManager::_findInstanceMember(lua_State *state,
+                                                                        LuaExportTypeDescriptor *typeDescriptor,
+                                                                        std::string const& memberName,
+                                                                        bool &isPrototypeMember)
+{
+    isPrototypeMember = false;
+
+    LuaInstanceMemberTable &memberTable = _getInstanceMemberTable(typeDescriptor);
+
+    LuaInstanceMemberMap::iterator it = memberTable.members.find(memberName);
+    if (it != memberTable.members.end())
+    {
+        if (it -> second.prototypeRef == LUA_NOREF)
+        {
+            return it -> second.propertyDescriptor;
+        }
+
+        LuaEngineAdapter::rawGetI(state, LUA_REGISTRYINDEX, it -> second.prototypeRef);
+        LuaEngineAdapter::pushString(state, memberName.c_str());
+        LuaEngineAdapter::rawGet(state, -2);
+        LuaEngineAdapter::remove(state, -2);
+
+        if (!LuaEngineAdapter::isNil(state, -1))
+        {
+            isPrototypeMember = true;
+            return NULL;
+        }
+
+        //原型成员已被移除，重新查找
+        LuaEngineAdapter::pop(state, 1);
+        memberTable.members.erase(it);
+    }
+
+    LuaInstanceMemberEntry entry;
+    entry.prototypeRef = LUA_NOREF;
+    entry.propertyDescriptor = NULL;
+
+    //沿继承链查找，先检查原型表，再检查类型属性
+    LuaExportTypeDescriptor *targetTypeDescriptor = typeDescriptor;
+    while (targetTypeDescriptor != NULL)
+    {
+        int prototypeRef = _getPrototypeRef(state, targetTypeDescriptor);
+        if (prototypeRef != LUA_NOREF)
+        {
+            LuaEngineAdapter::rawGetI(state, LUA_REGISTRYINDEX, prototypeRef);
+            LuaEngineAdapter::pushString(state, memberName.c_str());
+            LuaEngineAdapter::rawGet(state, -2);
+            LuaEngineAdapter::remove(state, -2);
+
+            if (!LuaEngineAdapter::isNil(state, -1))
+            {
+                entry.prototypeRef = prototypeRef;
+                isPrototypeMember = true;
+                break;
+            }
+
             LuaEngineAdapter::pop(state, 1);
         }
 
+        //Lua中定义的属性优先于类型属性
+        entry.propertyDescriptor = _getLuaProperty(targetTypeDescriptor, memberName);
+        if (entry.propertyDescriptor == NULL)
+        {
+            entry.propertyDescriptor = targetTypeDescriptor -> getProperty(memberName);
+        }
+
+        if (entry.propertyDescriptor != NULL)
+        {
+            break;
+        }
+
+        targetTypeDescriptor = targetTypeDescriptor -> parentTypeDescriptor();
+    }
+
+    memberTable.members[memberName] = entry;
+
+    return entry.propertyDescriptor;
+}
+
+LuaExportPropertyDescriptor* LuaExportsTypeManager::_findInstanceMember(lua_State *state,
+                                                                        LuaExportTypeDescriptor *typeDescriptor,
+                                                                        int keyIndex,
+                                                                        bool &isPrototypeMember)
+{
+    isPrototypeMember = false;
+    keyIndex = LuaEngineAdapter::absIndex(state, keyIndex);
+
+    size_t length = 0;
+    const char *key = LuaEngineAdapter::toLString(state, keyIndex, &length);
+    if (length > LUA_MEMBER_KEY_MAX_LENGTH)
+    {
+        //长字符串不一定唯一，使用键名查找
+        return _findInstanceMember(state, typeDescriptor, std::string(key, length), isPrototypeMember);
+    }
+
+    LuaInstanceMemberTable &memberTable = _getInstanceMemberTable(typeDescriptor);
+
+    LuaInstanceKeyMemberMap::iterator it = memberTable.keyMembers.find(key);
+    if (it != memberTable.keyMembers.end())
+    {
+        if (it -> second.prototypeRef == LUA_NOREF)
+        {
+            return it -> second.propertyDescriptor;
+        }
+
+        LuaEngineAdapter::rawGetI(state, LUA_REGISTRYINDEX, it -> second.prototypeRef);
+        LuaEngineAdapter::pushValue(state, keyIndex);
+        LuaEngineAdapter::rawGet(state, -2);
+        LuaEngineAdapter::remove(state, -2);
+
+        if (!LuaEngineAdapter::isNil(state, -1))
+        {
+            isPrototypeMember = true;
+            return NULL;
+        }
+
+        //原型成员已被移除，重新查找
         LuaEngineAdapter::pop(state, 1);
+        memberTable.keyMembers.erase(it);
+    }
 
-        //将创建对象放入到_vars_表中，主要修复对象创建后，在init中调用方法或者访问属性，由于对象尚未记录在_vars_中，而循环创建lua对象，并导致栈溢出。
-        this -> context() -> getDataExchanger() -> setLuaObject(-1, objectDescriptor -> getExchangeId());
+    std::string memberName(key, length);
+    LuaExportPropertyDescriptor *propertyDescriptor = _findInstanceMember(state, typeDescriptor, memberName, isPrototypeMember);
 
-    });
+    LuaInstanceMemberMap::iterator memberIt = memberTable.members.find(memberName);
+    if (memberIt != memberTable.members.end() && _retainMemberKey(state, keyIndex))
+    {
+        memberTable.keyMembers[key] = memberIt -> second;
+    }
+
+    return propertyDescriptor;
 }
 
 int LuaExportsTypeManager::_getInstancePropertyValue(LuaSession *session,
@@ -1302,48 +1975,22 @@ int LuaExportsTypeManager::_getInstancePropertyValue(LuaSession *session,
 
             lua_State *state = session -> getState();
 
-            LuaEngineAdapter::getMetatable(state, typeDescriptor -> prototypeTypeName().c_str());
-            LuaEngineAdapter::pushString(state, propertyName.c_str());
-            LuaEngineAdapter::rawGet(state, -2);
+            bool isPrototypeMember = false;
+            LuaExportPropertyDescriptor *propertyDescriptor = _findInstanceMember(state, typeDescriptor, propertyName, isPrototypeMember);
 
-            if (LuaEngineAdapter::isNil(state, -1))
+            if (!isPrototypeMember)
             {
-                LuaEngineAdapter::pop(state, 1);
-
-                //不存在
-                LuaExportPropertyDescriptor *propertyDescriptor = typeDescriptor -> getProperty(propertyName);
-                if (propertyDescriptor == NULL)
+                if (propertyDescriptor != NULL && propertyDescriptor -> canRead())
                 {
-                    if (typeDescriptor -> parentTypeDescriptor() != NULL)
-                    {
-                        //递归父类
-                        retValueCount = _getInstancePropertyValue(
-                                session,
-                                instance,
-                                typeDescriptor -> parentTypeDescriptor(),
-                                propertyName);
-                    }
-                    else
-                    {
-                        LuaEngineAdapter::pushNil(state);
-                    }
+                    LuaValue *retValue = propertyDescriptor -> invokeGetter(session, instance);
+                    retValueCount = session -> setReturnValue(retValue);
                 }
                 else
                 {
-                    if (propertyDescriptor -> canRead())
-                    {
-                        LuaValue *retValue = propertyDescriptor -> invokeGetter(session, instance);
-                        retValueCount = session -> setReturnValue(retValue);
-                    }
-                    else
-                    {
-                        LuaEngineAdapter::pushNil(state);
-                    }
+                    LuaEngineAdapter::pushNil(state);
                 }
             }
 
-            LuaEngineAdapter::remove(state, -1-retValueCount);
-
         });
 
 
@@ -1364,26 +2011,14 @@ LuaExportPropertyDescriptor* LuaExportsTypeManager::_findInstanceProperty(LuaSes
 
             lua_State *state = session -> getState();
 
-            LuaEngineAdapter::getMetatable(state, typeDescriptor -> prototypeTypeName().c_str());
-            LuaEngineAdapter::pushString(state, propertyName.c_str());
-            LuaEngineAdapter::rawGet(state, -2);
+            bool isPrototypeMember = false;
+            propertyDescriptor = _findInstanceMember(state, typeDescriptor, propertyName, isPrototypeMember);
 
-            if (LuaEngineAdapter::isNil(state, -1))
+            if (isPrototypeMember)
             {
-                //不存在
-                propertyDescriptor = typeDescriptor -> getProperty(propertyName);
-                if (propertyDescriptor == NULL)
-                {
-                    if (typeDescriptor -> parentTypeDescriptor() != NULL)
-                    {
-                        //递归父类
-                        propertyDescriptor = _findInstanceProperty(session, typeDescriptor -> parentTypeDescriptor(), propertyName);
-                    }
-                }
+                LuaEngineAdapter::pop(state, 1);
             }
 
-            LuaEngineAdapter::pop(state, 2);
-
         });
 
 
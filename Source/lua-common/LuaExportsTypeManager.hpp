@@ -11,6 +11,7 @@
 
 #include <stdio.h>
 #include <map>
+#include <unordered_map>
 #include <string>
 #include "LuaObject.h"
 #include "lua.hpp"
@@ -29,6 +30,28 @@ namespace cn {
             class LuaExportPropertyDescriptor;
             class LuaSession;
 
+            /**
+             实例成员查找结果
+             */
+            typedef struct
+            {
+                int prototypeRef;                                   //定义该成员的原型表在注册表中的引用，不是原型成员时为LUA_NOREF
+                LuaExportPropertyDescriptor *propertyDescriptor;    //属性描述，成员不是属性时为NULL
+            } LuaInstanceMemberEntry;
+
+            typedef std::unordered_map<std::string, LuaInstanceMemberEntry> LuaInstanceMemberMap;
+            typedef std::unordered_map<const char*, LuaInstanceMemberEntry> LuaInstanceKeyMemberMap;
+
+            /**
+             实例成员查找表，记录沿继承链查找成员的结果，成员版本变更时清空
+             */
+            typedef struct
+            {
+                unsigned int version;                               //成员版本
+                LuaInstanceMemberMap members;                       //成员查找结果
+                LuaInstanceKeyMemberMap keyMembers;                 //以Lua内部字符串地址为键的成员查找结果
+            } LuaInstanceMemberTable;
+
             /**
              导出类型管理器
              */
@@ -70,6 +93,14 @@ namespace cn {
                  @param typeDescriptor 类型描述
                  */
                 void exportsType(LuaExportTypeDescriptor *typeDescriptor);
+
+                /**
+                 导入其他管理器中已导出的类型，导入的类型描述与来源管理器共享（只读）。
+                 用于多个上下文共享同一套类型描述，避免每个上下文重复创建。
+
+                 @param manager 来源类型管理器
+                 */
+                void importTypes(LuaExportsTypeManager *manager);
                 
                 /**
                  根据一个原生对象创建一个Lua对象
@@ -158,6 +189,47 @@ namespace cn {
                 LuaExportPropertyDescriptor* _findInstanceProperty(LuaSession *session,
                                                                    LuaExportTypeDescriptor *typeDescriptor,
                                                                    std::string const& propertyName);
+
+                /**
+                 根据栈中的字符串键查找实例成员。短字符串在Lua中是唯一的，因此直接以其地址查找，无需复制键名；
+                 作为查找键的字符串会被记录在注册表中，避免被回收后地址被其他字符串复用。
+
+                 @param state 状态
+                 @param typeDescriptor 类型描述
+                 @param keyIndex 键的栈索引，键必须为字符串
+                 @param isPrototypeMember 是否为原型成员，为原型成员时成员值会被放入栈顶
+                 @return 属性描述，成员不是属性时返回NULL
+                 */
+                LuaExportPropertyDescriptor* _findInstanceMember(lua_State *state,
+                                                                 LuaExportTypeDescriptor *typeDescriptor,
+                                                                 int keyIndex,
+                                                                 bool &isPrototypeMember);
+
+                /**
+                 添加在Lua中通过原型定义的属性。类型描述可能被上下文组中的多个上下文共享，
+                 而属性的访问器为当前上下文中的方法，因此属性记录在管理器中，不修改类型描述
+
+                 @param typeDescriptor 类型描述
+                 @param propertyDescriptor 属性描述
+                 */
+                void _addLuaProperty(LuaExportTypeDescriptor *typeDescriptor, LuaExportPropertyDescriptor *propertyDescriptor);
+
+                /**
+                 检测栈中的字符串键是否为已知的非导出类型名称，用于避免重复通知上下文加载原生类型
+
+                 @param state 状态
+                 @param keyIndex 键的栈索引，键必须为字符串
+                 @return true 表示为非导出类型名称
+                 */
+                bool _isUnexportableName(lua_State *state, int keyIndex);
+
+                /**
+                 记录非导出类型名称，导出类型或类型映射变更时记录会被清空
+
+                 @param state 状态
+                 @param keyIndex 键的栈索引，键必须为字符串
+                 */
+                void _addUnexportableName(lua_State *state, int keyIndex);
                 
             private:
                 
@@ -181,6 +253,122 @@ namespace cn {
                  */
                 std::map<std::string, LuaExportTypeDescriptor*> _exportTypes;
 
+                /**
+                 导出类型版本，导出类型或类型映射变更时递增
+                 */
+                int _exportTypesVersion;
+
+                /**
+                 非导出类型名称表在注册表中的引用
+                 */
+                int _unexportableNamesRef;
+
+                /**
+                 非导出类型名称表对应的导出类型版本，与导出类型版本不一致时表会被重建
+                 */
+                int _unexportableNamesVersion;
+
+                /**
+                 非导出类型名称数量
+                 */
+                int _unexportableNameCount;
+
+                /**
+                 将非导出类型名称表入栈，导出类型版本变更时重建该表
+
+                 @param state 状态
+                 */
+                void _pushUnexportableNames(lua_State *state);
+
+                /**
+                 原型表引用，key为类型描述，value为原型表在注册表中的引用
+                 */
+                std::unordered_map<LuaExportTypeDescriptor*, int> _prototypeRefs;
+
+                /**
+                 扁平化的实例成员查找表，key为类型描述
+                 */
+                std::unordered_map<LuaExportTypeDescriptor*, LuaInstanceMemberTable> _instanceMemberTables;
+
+                /**
+                 在Lua中通过原型定义的属性，key为类型描述
+                 */
+                std::unordered_map<LuaExportTypeDescriptor*, PropertyMap> _luaProperties;
+
+                /**
+                 获取在Lua中通过原型定义的属性
+
+                 @param typeDescriptor 类型描述
+                 @param propertyName 属性名称
+                 @return 属性描述，不存在时返回NULL
+                 */
+                LuaExportPropertyDescriptor* _getLuaProperty(LuaExportTypeDescriptor *typeDescriptor, std::string const& propertyName);
+
+                /**
+                 成员键表在注册表中的引用，用于持有作为查找键的字符串
+                 */
+                int _memberKeysRef;
+
+                /**
+                 成员键数量
+                 */
+                int _memberKeyCount;
+
+                /**
+                 获取实例成员查找表，成员版本变更时清空查找表
+
+                 @param typeDescriptor 类型描述
+                 @return 查找表
+                 */
+                LuaInstanceMemberTable& _getInstanceMemberTable(LuaExportTypeDescriptor *typeDescriptor);
+
+                /**
+                 记录作为查找键的字符串
+
+                 @param state 状态
+                 @param keyIndex 键的栈索引
+                 @return true 表示已记录，键数量达到上限时返回false
+                 */
+                bool _retainMemberKey(lua_State *state, int keyIndex);
+
+                /**
+                 实例元表引用，key为类型描述，value为该类型实例共用的元表在注册表中的引用
+                 */
+                std::unordered_map<LuaExportTypeDescriptor*, int> _instanceMetatableRefs;
+
+                /**
+                 将类型实例共用的元表入栈，元表不存在时创建。
+                 元方法通过userdata获取实例对象，实例的动态字段保存在userdata的关联值中。
+
+                 @param state 状态
+                 @param typeDescriptor 类型描述
+                 */
+                void _pushInstanceMetatable(lua_State *state, LuaExportTypeDescriptor *typeDescriptor);
+
+                /**
+                 获取原型表引用
+
+                 @param state 状态
+                 @param typeDescriptor 类型描述
+                 @return 原型表在注册表中的引用，类型尚未导出时返回LUA_NOREF
+                 */
+                int _getPrototypeRef(lua_State *state, LuaExportTypeDescriptor *typeDescriptor);
+
+                /**
+                 查找实例成员，优先使用扁平化的查找表，表中不存在时沿继承链逐级查找原型表、Lua中定义的属性及类型属性并记录结果。
+                 通过rawset直接修改原型表不会更新成员版本，但原型成员被移除时会重新查找。
+
+                 @param state 状态
+                 @param typeDescriptor 类型描述
+                 @param memberName 成员名称
+                 @param isPrototypeMember 是否为原型成员，为原型成员时成员值会被放入栈顶
+                 @return 属性描述，成员不是属性时返回NULL
+                 */
+                LuaExportPropertyDescriptor* _findInstanceMember(lua_State *state,
+                                                                 LuaExportTypeDescriptor *typeDescriptor,
+                                                                 std::string const& memberName,
+                                                                 bool &isPrototypeMember);
+
                 /**
                  初始化导出类型
                  */
@@ -4,6 +4,7 @@
 
 #include <limits>
 #include <stdio.h>
+#include <stdlib.h>
 #include "LuaFunction.h"
 #include "LuaContext.h"
 #include "LuaValue.h"
@@ -32,9 +33,7 @@ LuaFunction::LuaFunction (LuaContext *context)
 LuaFunction::LuaFunction(LuaContext *context, int index)
     : LuaManagedObject(context)
 {
-    _exchangeId = StringUtils::format("%p", this);
-
-    getContext() -> getDataExchanger() -> setLuaObject(index, _exchangeId);
+    getContext() -> getDataExchanger() -> setLuaObject(index, getLinkId());
     getContext() -> getDataExchanger() -> retainLuaObject(this);
 }
 
@@ -56,14 +55,14 @@ LuaFunction::LuaFunction (LuaObjectDecoder *decoder)
     :LuaManagedObject(decoder)
 {
     decoder -> readInt32(); //读取Unity中传过来的ContextID，并忽略(decoder中包含context对象)
-    _exchangeId = decoder -> readString();
+    _linkId = atoi(decoder -> readString().c_str());
 }
 
 void LuaFunction::serialization (LuaObjectEncoder *encoder)
 {
     LuaObject::serialization(encoder);
     encoder -> writeInt32(getContext() -> objectId());
-    encoder -> writeString(_exchangeId);
+    encoder -> writeString(getExchangeId());
 }
 
 void LuaFunction::push(LuaContext *context)
@@ -79,7 +78,8 @@ LuaValue* LuaFunction::invoke(LuaArgumentList *arguments)
 
         lua_State *state = getContext() -> getCurrentSession() -> getState();
 
-
+        //清除已释放对象的引用
+        getContext() -> getDataExchanger() -> flushPendingClear();
 
         int errFuncIndex = getContext() -> catchException();
         //记录栈顶位置，用于计算返回值数量
@@ -100,6 +100,7 @@ LuaValue* LuaFunction::invoke(LuaArgumentList *arguments)
             if (LuaEngineAdapter::pCall(state, (int)arguments -> size(), LUA_MULTRET, errFuncIndex) == 0)
             {
                 //调用成功
+                getContext() -> setAsyncCallResult(true);
                 returnCount = LuaEngineAdapter::getTop(state) - top;
                 if (returnCount > 1)
                 {
@@ -123,6 +124,7 @@ LuaValue* LuaFunction::invoke(LuaArgumentList *arguments)
             else
             {
                 //调用失败
+                getContext() -> setAsyncCallResult(false);
                 returnCount = LuaEngineAdapter::getTop(state) - top;
             }
 
@@ -151,3 +153,56 @@ LuaValue* LuaFunction::invoke(LuaArgumentList *arguments)
 
     return retValue;
 }
+
+
+void LuaFunction::invokeAsync(LuaArgumentList *arguments, LuaAsyncCompletionHandler handler)
+{
+    //复制并持有参数与方法对象，调用完成后释放
+    LuaArgumentList args = *arguments;
+    for (LuaArgumentList::iterator it = args.begin(); it != args.end(); ++it)
+    {
+        (*it) -> retain();
+    }
+    retain();
+
+    getContext() -> performAsyncAction([this, args]() mutable {
+
+        //调用抛出异常时同样需要释放参数与方法对象，释放后再重新抛出
+        LuaValue *retValue = NULL;
+        std::exception_ptr error;
+        try
+        {
+            retValue = invoke(&args);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        for (LuaArgumentList::iterator it = args.begin(); it != args.end(); ++it)
+        {
+            (*it) -> release();
+        }
+        release();
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+
+        return retValue;
+
+    }, handler);
+}
+
+std::future<LuaValue*> LuaFunction::invokeAsync(LuaArgumentList *arguments)
+{
+    std::shared_ptr<std::promise<LuaValue*> > promise = std::make_shared<std::promise<LuaValue*> >();
+    std::future<LuaValue*> future = promise -> get_future();
+
+    invokeAsync(arguments, [promise](LuaValue *result, std::string const& error) {
+        LuaContext::fulfillPromise(promise, result, error);
+    });
+
+    return future;
+}
@@ -7,6 +7,7 @@
 
 #include "LuaManagedObject.h"
 #include "LuaDefined.h"
+#include <future>
 
 namespace cn {
     namespace vimfung {
@@ -76,6 +77,23 @@ namespace cn {
                  */
                 LuaValue* invoke(LuaArgumentList *arguments);
 
+                /**
+                 * 异步调用方法，参数列表会被复制并持有至调用完成
+                 *
+                 * @param arguments 参数列表
+                 * @param handler 完成处理器
+                 */
+                void invokeAsync(LuaArgumentList *arguments, LuaAsyncCompletionHandler handler);
+
+                /**
+                 * 异步调用方法，参数列表会被复制并持有至调用完成
+                 *
+                 * @param arguments 参数列表
+                 *
+                 * @return 返回值的future，返回值需要调用者释放，执行出错时get会抛出std::runtime_error
+                 */
+                std::future<LuaValue*> invokeAsync(LuaArgumentList *arguments);
+
             public:
 
                 /**
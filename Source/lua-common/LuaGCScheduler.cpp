@@ -0,0 +1,187 @@
+#include "LuaGCScheduler.h"
+#include "LuaContext.h"
+#include <vector>
+
+using namespace cn::vimfung::luascriptcore;
+
+LuaGCScheduler* LuaGCScheduler::SharedInstance()
+{
+    static LuaGCScheduler *_scheduler = NULL;
+    static std::once_flag _onceFlag;
+
+    std::call_once(_onceFlag, [](){
+        _scheduler = new LuaGCScheduler();
+    });
+
+    return _scheduler;
+}
+
+LuaGCScheduler::LuaGCScheduler()
+    : _running(false),
+      _tickInterval(std::chrono::milliseconds(10)),
+      _idleDelay(std::chrono::milliseconds(100))
+{
+
+}
+
+void LuaGCScheduler::schedule(LuaContext *context)
+{
+    LuaGCPolicy policy = context -> getGCPolicy();
+    if (policy == LuaGCPolicyOff)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_lock);
+
+    Clock::time_point now = Clock::now();
+
+    EntryMap::iterator it = _entries.find(context);
+    if (it == _entries.end())
+    {
+        //持有上下文直到回收完成
+        context -> retain();
+
+        Entry entry;
+        entry.policy = policy;
+        entry.lastRequest = now;
+        entry.nextTick = now + _tickInterval;
+        entry.requestSeq = 0;
+        _entries[context] = entry;
+    }
+    else
+    {
+        it -> second.policy = policy;
+        it -> second.lastRequest = now;
+        it -> second.requestSeq ++;
+    }
+
+    if (!_running)
+    {
+        _running = true;
+        _thread = std::thread(&LuaGCScheduler::run, this);
+        _thread.detach();
+    }
+
+    _cond.notify_one();
+}
+
+void LuaGCScheduler::setTickInterval(int interval)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    _tickInterval = std::chrono::milliseconds(interval);
+}
+
+void LuaGCScheduler::setIdleDelay(int delay)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    _idleDelay = std::chrono::milliseconds(delay);
+}
+
+void LuaGCScheduler::run()
+{
+    /**
+     * 回收任务
+     */
+    struct Task
+    {
+        LuaContext *context;
+        LuaGCPolicy policy;
+        int requestSeq;
+        bool finished;
+    };
+
+    std::vector<Task> tasks;
+    std::vector<LuaContext *> finishedContexts;
+
+    std::unique_lock<std::mutex> lock(_lock);
+
+    for (;;)
+    {
+        if (_entries.empty())
+        {
+            _cond.wait(lock);
+            continue;
+        }
+
+        //找出到期的回收任务，并计算下次唤醒时间
+        Clock::time_point now = Clock::now();
+        Clock::time_point wakeTime = Clock::time_point::max();
+
+        tasks.clear();
+        for (EntryMap::iterator it = _entries.begin(); it != _entries.end(); ++it)
+        {
+            Entry &entry = it -> second;
+            Clock::time_point dueTime = entry.policy == LuaGCPolicyIncremental
+                                        ? entry.nextTick
+                                        : entry.lastRequest + _idleDelay;
+
+            if (dueTime <= now)
+            {
+                Task task = {it -> first, entry.policy, entry.requestSeq, false};
+                tasks.push_back(task);
+            }
+            else if (dueTime < wakeTime)
+            {
+                wakeTime = dueTime;
+            }
+        }
+
+        if (tasks.empty())
+        {
+            _cond.wait_until(lock, wakeTime);
+            continue;
+        }
+
+        //执行回收时不持有调度器锁，避免阻塞请求回收的线程
+        lock.unlock();
+
+        for (std::vector<Task>::iterator it = tasks.begin(); it != tasks.end(); ++it)
+        {
+            if (it -> policy == LuaGCPolicyIncremental)
+            {
+                it -> finished = it -> context -> gcStep();
+            }
+            else
+            {
+                it -> context -> gcHandler();
+                it -> finished = true;
+            }
+        }
+
+        lock.lock();
+
+        finishedContexts.clear();
+        now = Clock::now();
+        for (std::vector<Task>::iterator it = tasks.begin(); it != tasks.end(); ++it)
+        {
+            EntryMap::iterator entryIt = _entries.find(it -> context);
+            if (entryIt == _entries.end())
+            {
+                continue;
+            }
+
+            Entry &entry = entryIt -> second;
+            if (it -> finished && entry.requestSeq == it -> requestSeq)
+            {
+                //已完成回收，且回收期间没有新的回收请求
+                finishedContexts.push_back(it -> context);
+                _entries.erase(entryIt);
+            }
+            else
+            {
+                entry.nextTick = now + _tickInterval;
+            }
+        }
+
+        //释放上下文可能触发上下文销毁，需要在锁外进行
+        lock.unlock();
+
+        for (std::vector<LuaContext *>::iterator it = finishedContexts.begin(); it != finishedContexts.end(); ++it)
+        {
+            (*it) -> release();
+        }
+
+        lock.lock();
+    }
+}
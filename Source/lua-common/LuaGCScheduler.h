@@ -0,0 +1,95 @@
+#ifndef ANDROID_LUAGCSCHEDULER_H
+#define ANDROID_LUAGCSCHEDULER_H
+
+#include "LuaDefined.h"
+#include <map>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+
+namespace cn {
+    namespace vimfung {
+        namespace luascriptcore {
+
+            class LuaContext;
+
+            /**
+             * 内存回收调度器，在单独的后台线程中按上下文的回收策略执行内存回收
+             */
+            class LuaGCScheduler
+            {
+            private:
+
+                LuaGCScheduler();
+
+            public:
+
+                /**
+                 * 获取共享的回收调度器实例
+                 */
+                static LuaGCScheduler* SharedInstance();
+
+            public:
+
+                /**
+                 * 请求对上下文进行内存回收，上下文在回收完成前会被调度器持有
+                 *
+                 * @param context 上下文对象
+                 */
+                void schedule(LuaContext *context);
+
+                /**
+                 * 设置增量回收的调度间隔，默认为10毫秒
+                 *
+                 * @param interval 间隔（毫秒）
+                 */
+                void setTickInterval(int interval);
+
+                /**
+                 * 设置空闲回收的延迟时间，上下文在该时间内没有再次请求回收时执行完整回收，默认为100毫秒
+                 *
+                 * @param delay 延迟时间（毫秒）
+                 */
+                void setIdleDelay(int delay);
+
+            private:
+
+                typedef std::chrono::steady_clock Clock;
+
+                /**
+                 * 调度项
+                 */
+                struct Entry
+                {
+                    LuaGCPolicy policy;             //回收策略
+                    Clock::time_point lastRequest;  //最近一次请求时间
+                    Clock::time_point nextTick;     //下次增量回收时间
+                    int requestSeq;                 //请求序号，用于判断回收期间是否有新的请求
+                };
+
+                typedef std::map<LuaContext *, Entry> EntryMap;
+
+                /**
+                 * 调度线程入口
+                 */
+                void run();
+
+            private:
+
+                std::mutex _lock;
+                std::condition_variable _cond;
+                std::thread _thread;
+                bool _running;
+
+                EntryMap _entries;
+
+                Clock::duration _tickInterval;
+                Clock::duration _idleDelay;
+            };
+        }
+    }
+}
+
+
+#endif //ANDROID_LUAGCSCHEDULER_H
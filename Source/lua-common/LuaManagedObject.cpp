@@ -6,17 +6,18 @@
 #include "LuaObjectDecoder.hpp"
 #include "LuaContext.h"
 #include "LuaDataExchanger.h"
+#include "StringUtils.h"
 
 using namespace cn::vimfung::luascriptcore;
 
 LuaManagedObject::LuaManagedObject(LuaContext *context)
-    : LuaObject(), _context(context)
+    : LuaObject(), _context(context), _linkId(0)
 {
 
 }
 
 LuaManagedObject::LuaManagedObject (LuaObjectDecoder *decoder)
-    : LuaObject (decoder), _context(decoder -> getContext())
+    : LuaObject (decoder), _context(decoder -> getContext()), _linkId(0)
 {
 
 }
@@ -33,8 +34,11 @@ void LuaManagedObject::serialization (LuaObjectEncoder *encoder)
 
 LuaManagedObject::~LuaManagedObject()
 {
-    //清除对象在交互层的引用
-    _context -> getDataExchanger() -> clearObject(this);
+    //清除对象在交互层的引用，未分配交换层标识的对象从未进入Lua层，无需清除
+    if (_linkId != 0)
+    {
+        _context -> getDataExchanger() -> clearObject(this);
+    }
 }
 
 LuaContext *LuaManagedObject::getContext()
@@ -42,7 +46,22 @@ LuaContext *LuaManagedObject::getContext()
     return _context;
 }
 
+int LuaManagedObject::getLinkId()
+{
+    if (_linkId == 0)
+    {
+        _linkId = _context -> getDataExchanger() -> allocLinkId(this);
+    }
+
+    return _linkId;
+}
+
+bool LuaManagedObject::hasLinkId()
+{
+    return _linkId != 0;
+}
+
 std::string LuaManagedObject::getExchangeId()
 {
-    return _exchangeId;
+    return StringUtils::format("%d", getLinkId());
 }
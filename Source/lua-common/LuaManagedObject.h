@@ -27,9 +27,9 @@ namespace cn
             protected:
 
                 /**
-                 * 交换层标识，每个对象应该保证唯一
+                 * 交换层标识，由所属上下文的数据交换层在首次使用时分配，在上下文中唯一，0表示尚未分配
                  */
-                std::string _exchangeId;
+                int _linkId;
 
             public:
                 LuaManagedObject(LuaContext *context);
@@ -51,7 +51,21 @@ namespace cn
             public:
 
                 /**
-                 * 获取交换层标识
+                 * 获取交换层标识，尚未分配时由数据交换层分配
+                 *
+                 * @return 交换层标识
+                 */
+                int getLinkId();
+
+                /**
+                 * 判断是否已分配交换层标识
+                 *
+                 * @return true 表示已分配，否则未分配
+                 */
+                bool hasLinkId();
+
+                /**
+                 * 获取交换层标识的字符串形式，用于序列化
                  */
                 std::string getExchangeId();
 
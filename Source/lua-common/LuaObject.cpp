@@ -7,6 +7,7 @@
 #include "LuaObjectDecoder.hpp"
 #include "LuaObjectManager.h"
 #include <map>
+#include <mutex>
 #include <typeinfo>
 
 using namespace cn::vimfung::luascriptcore;
@@ -16,50 +17,74 @@ typedef std::map<int, LuaObject *> ObjectPoolMap;
 /**
  对象流水号
  */
-static int _objSeqId = 0;
+static std::atomic<int> _objSeqId(0);
 
 /**
- 对象池
+ 对象池，不随进程退出析构，避免后台线程（如回收调度器）在退出阶段释放对象时访问已销毁的对象池
  */
-static ObjectPoolMap _objectPool;
+static ObjectPoolMap &_objectPool = *new ObjectPoolMap();
+
+/**
+ 对象池锁，对象可能在多个线程中创建和销毁
+ */
+static std::mutex _objectPoolLock;
 
 LuaObject::LuaObject()
 {
     _retainCount = 1;
 
-    _objSeqId ++;
-    _objectId = _objSeqId;
-    
-    _objectPool[_objectId] = this;
+    //对象标识在首次使用（如序列化）时才分配
+    _objectId = 0;
 }
 
 LuaObject::LuaObject (LuaObjectDecoder *decoder)
 {
     _retainCount = 1;
     
-    _objectId = decoder -> readInt32();
-    if (_objectId == 0)
+    int objectId = decoder -> readInt32();
+    if (objectId == 0)
     {
         //分配对象标识
-        _objSeqId ++;
-        _objectId = _objSeqId;
+        objectId = ++_objSeqId;
     }
-    
-    _objectPool[_objectId] = this;
+
+    _objectId = objectId;
+
+    std::lock_guard<std::mutex> lock(_objectPoolLock);
+    _objectPool[objectId] = this;
 }
 
 LuaObject::~LuaObject()
 {
-    ObjectPoolMap::iterator it = _objectPool.find(_objectId);
-    if (it != _objectPool.end())
+    int objectId = _objectId.load(std::memory_order_relaxed);
+    if (objectId != 0)
     {
-        _objectPool.erase(it);
+        std::lock_guard<std::mutex> lock(_objectPoolLock);
+        ObjectPoolMap::iterator it = _objectPool.find(objectId);
+        if (it != _objectPool.end())
+        {
+            _objectPool.erase(it);
+        }
     }
 }
 
 int LuaObject::objectId()
 {
-    return _objectId;
+    int objectId = _objectId.load(std::memory_order_acquire);
+    if (objectId == 0)
+    {
+        std::lock_guard<std::mutex> lock(_objectPoolLock);
+
+        objectId = _objectId.load(std::memory_order_relaxed);
+        if (objectId == 0)
+        {
+            objectId = ++_objSeqId;
+            _objectPool[objectId] = this;
+            _objectId.store(objectId, std::memory_order_release);
+        }
+    }
+
+    return objectId;
 }
 
 void LuaObject::retain()
@@ -69,9 +94,7 @@ void LuaObject::retain()
 
 void LuaObject::release()
 {
-    _retainCount --;
-    
-    if (_retainCount <= 0)
+    if (--_retainCount <= 0)
     {
         delete this;
     }
@@ -85,11 +108,12 @@ std::string LuaObject::typeName()
 
 void LuaObject::serialization (LuaObjectEncoder *encoder)
 {
-    encoder -> writeInt32(_objectId);
+    encoder -> writeInt32(objectId());
 }
 
 LuaObject* LuaObject::findObject(int objectId)
 {
+    std::lock_guard<std::mutex> lock(_objectPoolLock);
     ObjectPoolMap::iterator it = _objectPool.find(objectId);
     
     if (it != _objectPool.end())
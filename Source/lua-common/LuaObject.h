@@ -6,6 +6,7 @@
 #define SAMPLE_LUAOBJECT_H
 
 #include <string>
+#include <atomic>
 
 namespace cn
 {
@@ -19,8 +20,8 @@ namespace cn
             class LuaObject
             {
             private:
-                int _retainCount;
-                int _objectId;
+                std::atomic<int> _retainCount;
+                std::atomic<int> _objectId;
                 
             public:
                 LuaObject ();
@@ -28,7 +29,14 @@ namespace cn
                 virtual ~LuaObject();
 
             public:
+
+                /**
+                 获取对象标识，首次获取时才分配标识并登记到对象池中
+
+                 @return 对象标识
+                 */
                 int objectId ();
+
                 virtual std::string typeName();
                 void retain ();
                 void release ();
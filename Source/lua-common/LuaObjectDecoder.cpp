@@ -13,13 +13,20 @@
 #include "LuaContext.h"
 #include "LuaObjectManager.h"
 #include <memory.h>
+#include <limits.h>
 
 using namespace cn::vimfung::luascriptcore;
 
 LuaObjectDecoder::LuaObjectDecoder(LuaContext *context, const void *buf)
-    :_buf(buf), _offset(0), _context(context)
+    :_buf(buf), _offset(0), _context(context), _length(buf != NULL ? INT_MAX : 0), _truncated(false), _version(LUA_OBJECT_ENCODING_VERSION_1)
 {
-    
+    readHeader();
+}
+
+LuaObjectDecoder::LuaObjectDecoder(LuaContext *context, const void *buf, int length)
+    :_buf(buf), _offset(0), _context(context), _length(buf != NULL && length > 0 ? length : 0), _truncated(false), _version(LUA_OBJECT_ENCODING_VERSION_1)
+{
+    readHeader();
 }
 
 LuaObjectDecoder::~LuaObjectDecoder()
@@ -28,21 +35,96 @@ LuaObjectDecoder::~LuaObjectDecoder()
     _offset = 0;
 }
 
+void LuaObjectDecoder::readHeader()
+{
+    if (_length >= 2 && ((const unsigned char *)_buf)[0] == LUA_OBJECT_ENCODING_MAGIC)
+    {
+        _version = ((const unsigned char *)_buf)[1];
+        _offset = 2;
+
+        if (_version != LUA_OBJECT_ENCODING_VERSION_1 && _version != LUA_OBJECT_ENCODING_VERSION_2)
+        {
+            //无法识别的版本，按截断处理，不再读取任何数据
+            _truncated = true;
+            _offset = _length;
+        }
+    }
+}
+
+bool LuaObjectDecoder::checkLength(int size)
+{
+    if (_truncated || size < 0 || size > _length - _offset)
+    {
+        _truncated = true;
+        _offset = _length;
+        return false;
+    }
+    
+    return true;
+}
+
 LuaContext* LuaObjectDecoder::getContext()
 {
     return _context;
 }
 
+bool LuaObjectDecoder::isTruncated()
+{
+    return _truncated;
+}
+
 char LuaObjectDecoder::readByte()
 {
+    if (!checkLength(1))
+    {
+        return 0;
+    }
+    
     char value = ((char *)_buf) [_offset];
     _offset++;
     
     return value;
 }
 
+unsigned long long LuaObjectDecoder::readVarUInt()
+{
+    unsigned long long value = 0;
+    int shift = 0;
+    
+    unsigned char byte = 0;
+    do
+    {
+        if (!checkLength(1))
+        {
+            return 0;
+        }
+        
+        byte = ((unsigned char *)_buf) [_offset];
+        _offset++;
+        
+        if (shift < 64)
+        {
+            value |= (unsigned long long)(byte & 0x7f) << shift;
+        }
+        shift += 7;
+    }
+    while (byte & 0x80);
+    
+    return value;
+}
+
 short LuaObjectDecoder::readInt16()
 {
+    if (_version >= LUA_OBJECT_ENCODING_VERSION_2)
+    {
+        return (short)readInt64();
+    }
+    
+    if (!checkLength(2))
+    {
+        return 0;
+    }
+    
     short value = (((unsigned char *)_buf) [_offset] << 8)
 				| ((unsigned char *)_buf) [_offset + 1];
     _offset += 2;
@@ -52,6 +134,16 @@ short LuaObjectDecoder::readInt16()
 
 int LuaObjectDecoder::readInt32()
 {
+    if (_version >= LUA_OBJECT_ENCODING_VERSION_2)
+    {
+        return (int)readInt64();
+    }
+    
+    if (!checkLength(4))
+    {
+        return 0;
+    }
+    
     int value = (((unsigned char *)_buf) [_offset] << 24)
 				| (((unsigned char *)_buf) [_offset + 1] << 16)
 				| (((unsigned char *)_buf) [_offset + 2] << 8)
@@ -63,6 +155,18 @@ int LuaObjectDecoder::readInt32()
 
 long long LuaObjectDecoder::readInt64()
 {
+    if (_version >= LUA_OBJECT_ENCODING_VERSION_2)
+    {
+        //zigzag解码
+        unsigned long long value = readVarUInt();
+        return (long long)(value >> 1) ^ -(long long)(value & 1);
+    }
+    
+    if (!checkLength(8))
+    {
+        return 0;
+    }
+    
     long long value = ((long long)((unsigned char *)_buf) [_offset] << 56)
 				| ((long long)((unsigned char *)_buf) [_offset + 1] << 48)
 				| ((long long)((unsigned char *)_buf) [_offset + 2] << 40)
@@ -78,6 +182,11 @@ long long LuaObjectDecoder::readInt64()
 
 double LuaObjectDecoder::readDouble()
 {
+    if (!checkLength(8))
+    {
+        return 0;
+    }
+    
     DoubleStruct ds;
     memcpy(ds.bytes, (((unsigned char *)_buf) + _offset), 8);
     _offset += 8;
@@ -87,29 +196,63 @@ double LuaObjectDecoder::readDouble()
 
 const std::string LuaObjectDecoder::readString()
 {
-    std::string str;
-    
-    int size = readInt32();
-    char *buf = new char[size + 1] {0};
-    memcpy(buf, (char *)_buf + _offset, size);
-    _offset += size;
-    str = buf;
-    delete[] buf;
+    int size = 0;
+    const char *str = readStringView(&size);
+    if (str == NULL)
+    {
+        return "";
+    }
     
-    return str;
+    return std::string(str, size);
 }
 
 void LuaObjectDecoder::readBytes(void **bytes, int *length)
 {
-    *length = readInt32();
+    const char *view = readBytesView(length);
+    if (view == NULL)
+    {
+        *bytes = NULL;
+        return;
+    }
     
     *bytes = new char[*length];
-    memcpy(*bytes, (char *)_buf + _offset, *length);
-    _offset += *length;
+    memcpy(*bytes, view, *length);
+}
+
+const char* LuaObjectDecoder::readBytesView(int *length)
+{
+    int size = readInt32();
+    if (!checkLength(size))
+    {
+        *length = 0;
+        return NULL;
+    }
+    
+    const char *bytes = (const char *)_buf + _offset;
+    _offset += size;
+    *length = size;
+    
+    return bytes;
+}
+
+const char* LuaObjectDecoder::readStringView(int *length)
+{
+    //字符串与缓存数据的格式一致，均为长度加内容
+    return readBytesView(length);
 }
 
 LuaObject* LuaObjectDecoder::readObject()
 {
+    if (_version >= LUA_OBJECT_ENCODING_VERSION_2)
+    {
+        return readObjectV2();
+    }
+    
+    if (!checkLength(1))
+    {
+        return NULL;
+    }
+    
     if (((char *)_buf) [_offset] == 'L')
     {
         _offset ++;
@@ -121,22 +264,7 @@ LuaObject* LuaObjectDecoder::readObject()
             LuaNativeClass *nativeClass = LuaNativeClass::findClass(className);
             if (nativeClass != NULL)
             {
-                //取出对象标识，并从对象管理器中查找是否存在此对象。
-                int objectId = readInt32();
-                LuaObject *obj = LuaObject::findObject(objectId);
-                if (obj == NULL)
-                {
-                    //恢复读取对象标识的游标
-                    _offset -= 4;
-                    obj = (LuaObject *)nativeClass -> createInstance(this);
-                }
-                else
-                {
-                    //增加一次引用
-                    obj -> retain();
-                }
-                
-                return obj;
+                return readObjectWithClass(nativeClass);
             }
         }
     }
@@ -145,6 +273,10 @@ LuaObject* LuaObjectDecoder::readObject()
         //其他原生类型使用ObjectDescriptor装载
         void **objRef = NULL;
         objRef = (void **)readInt64();
+        if (_truncated)
+        {
+            return NULL;
+        }
         
         LuaObjectDescriptor *objDesc = new LuaObjectDescriptor(getContext(), *objRef);
         return objDesc;
@@ -152,3 +284,93 @@ LuaObject* LuaObjectDecoder::readObject()
     
     return NULL;
 }
+
+LuaObject* LuaObjectDecoder::readObjectV2()
+{
+    if (!checkLength(1))
+    {
+        return NULL;
+    }
+    
+    unsigned char tag = (unsigned char)readByte();
+    
+    LuaNativeClass *nativeClass = NULL;
+    if (tag & LUA_OBJECT_TAG_CLASS_INLINE_INDEX)
+    {
+        size_t index = tag & ~LUA_OBJECT_TAG_CLASS_INLINE_INDEX;
+        if (index < _classes.size())
+        {
+            nativeClass = _classes[index];
+        }
+    }
+    else
+    {
+        switch (tag)
+        {
+            case LUA_OBJECT_TAG_CLASS_NAME:
+            {
+                //每种类型只在首次出现时查找一次
+                nativeClass = LuaNativeClass::findClass(readString());
+                _classes.push_back(nativeClass);
+                break;
+            }
+            case LUA_OBJECT_TAG_CLASS_INDEX:
+            {
+                unsigned long long index = readVarUInt();
+                if (index < _classes.size())
+                {
+                    nativeClass = _classes[(size_t)index];
+                }
+                break;
+            }
+            case LUA_OBJECT_TAG_REFERENCE:
+            {
+                //其他原生类型使用ObjectDescriptor装载
+                void **objRef = (void **)readInt64();
+                if (_truncated)
+                {
+                    return NULL;
+                }
+                
+                return new LuaObjectDescriptor(getContext(), *objRef);
+            }
+            default:
+                break;
+        }
+    }
+    
+    if (nativeClass != NULL)
+    {
+        return readObjectWithClass(nativeClass);
+    }
+    
+    return NULL;
+}
+
+LuaObject* LuaObjectDecoder::readObjectWithClass(LuaNativeClass *nativeClass)
+{
+    //取出对象标识，并从对象管理器中查找是否存在此对象。
+    int offset = _offset;
+    int objectId = readInt32();
+    LuaObject *obj = LuaObject::findObject(objectId);
+    if (obj == NULL)
+    {
+        //恢复读取对象标识的游标
+        _offset = offset;
+        obj = (LuaObject *)nativeClass -> createInstance(this);
+        
+        if (_truncated && obj != NULL)
+        {
+            //数据被截断，丢弃不完整的对象
+            obj -> release();
+            obj = NULL;
+        }
+    }
+    else
+    {
+        //增加一次引用
+        obj -> retain();
+    }
+    
+    return obj;
+}
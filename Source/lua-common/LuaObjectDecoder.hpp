@@ -10,6 +10,7 @@
 #define LuaObjectDecoder_hpp
 
 #include <stdio.h>
+#include <vector>
 #include "LuaObject.h"
 
 namespace cn
@@ -19,9 +20,10 @@ namespace cn
         namespace luascriptcore
         {
             class LuaContext;
+            class LuaNativeClass;
             
             /**
-             对象解码器
+             对象解码器，可读取v1及v2格式的数据，格式说明见LuaObjectSerializationTypes.h
              */
             class LuaObjectDecoder : public LuaObject
             {
@@ -29,15 +31,86 @@ namespace cn
                 const void *_buf;
                 int _offset;
                 LuaContext *_context;
+                
+                /**
+                 缓冲区大小，未指定大小时为INT_MAX，此时不进行越界检查
+                 */
+                int _length;
+                
+                /**
+                 是否读取越界，即数据被截断或长度字段无效
+                 */
+                bool _truncated;
+                
+                /**
+                 数据格式版本
+                 */
+                int _version;
+                
+                /**
+                 类型字典，v2格式中按出现顺序记录类型名称对应的原生类型，找不到类型时为NULL
+                 */
+                std::vector<LuaNativeClass *> _classes;
+                
+            private:
+                
+                /**
+                 读取数据头部，判断数据格式版本，版本无法识别时标记为越界
+                 */
+                void readHeader();
+                
+                /**
+                 检查剩余数据是否足够，不足时标记为越界并将游标移到末尾
+
+                 @param size 需要读取的大小
+                 
+                 @return true 表示数据足够，否则越界
+                 */
+                bool checkLength(int size);
+                
+                /**
+                 读取一个无符号变长整数（LEB128）
+
+                 @return 整数值
+                 */
+                unsigned long long readVarUInt();
+                
+                /**
+                 读取v2格式的对象
+                 
+                 @return 对象
+                 */
+                LuaObject* readObjectV2();
+                
+                /**
+                 创建或查找对象，对象标识对应的对象存在时直接返回该对象，否则使用原生类型创建对象
+
+                 @param nativeClass 原生类型
+                 
+                 @return 对象
+                 */
+                LuaObject* readObjectWithClass(LuaNativeClass *nativeClass);
+                
             public:
                 
                 /**
-                 创建对象解码器
+                 创建对象解码器，根据数据头部判断数据格式版本。由于不知道缓冲区大小，不会进行越界检查
                  
                  @param context 上下文对象
+                 @param buf 数据缓冲区
                  */
                 LuaObjectDecoder(LuaContext *context, const void *buf);
                 
+                /**
+                 创建对象解码器，读取时进行越界检查，数据被截断时不会读取缓冲区以外的内容。
+                 解码器不复制数据，缓冲区需要在解码器及其返回的数据视图使用期间保持有效
+                 
+                 @param context 上下文对象
+                 @param buf 数据缓冲区
+                 @param length 缓冲区大小
+                 */
+                LuaObjectDecoder(LuaContext *context, const void *buf, int length);
+                
                 /**
                  销毁对象解码器
                  */
@@ -52,6 +125,13 @@ namespace cn
                  */
                 LuaContext* getContext();
                 
+                /**
+                 是否读取越界，数据被截断、长度字段无效或版本无法识别时为true，此后的读取操作均返回空值
+
+                 @return true 表示越界，否则数据完整
+                 */
+                bool isTruncated();
+                
             public:
                 
                 /**
@@ -97,13 +177,31 @@ namespace cn
                 const std::string readString();
                 
                 /**
-                 读取缓存数据
+                 读取缓存数据，数据被复制到新分配的缓存中，需要使用delete[]释放
                  
-                 @param bytes 缓存数据
+                 @param bytes 缓存数据，越界时为NULL
                  @param length 缓存大小
                  */
                 void readBytes(void **bytes, int *length);
                 
+                /**
+                 读取缓存数据视图，返回指向缓冲区内部的指针而不复制数据
+                 
+                 @param length 缓存大小
+                 
+                 @return 缓存数据，越界时返回NULL
+                 */
+                const char* readBytesView(int *length);
+                
+                /**
+                 读取字符串视图，返回指向缓冲区内部的指针而不复制数据，字符串不以'\0'结尾
+                 
+                 @param length 字符串长度
+                 
+                 @return 字符串，越界时返回NULL
+                 */
+                const char* readStringView(int *length);
+                
                 /**
                  读取对象
 
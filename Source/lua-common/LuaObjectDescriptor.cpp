@@ -3,6 +3,7 @@
 //
 
 #include <stdint.h>
+#include <stdlib.h>
 #include "LuaObjectDescriptor.h"
 #include "LuaObjectEncoder.hpp"
 #include "LuaObjectDecoder.hpp"
@@ -47,19 +48,19 @@ static int objectReferenceGCHandler(lua_State *state)
 LuaObjectDescriptor::LuaObjectDescriptor(LuaContext *context)
         : LuaManagedObject(context), _object(NULL), _typeDescriptor(NULL)
 {
-    _exchangeId = StringUtils::format("%p", this);
+
 }
 
 LuaObjectDescriptor::LuaObjectDescriptor(LuaContext *context, const void *object)
     : LuaManagedObject(context), _object((void *)object), _typeDescriptor(NULL)
 {
-    _exchangeId = StringUtils::format("%p", this);
+
 }
 
 LuaObjectDescriptor::LuaObjectDescriptor(LuaContext *context, void *object, LuaExportTypeDescriptor *typeDescriptor)
     : LuaManagedObject(context), _object(object), _typeDescriptor(typeDescriptor)
 {
-    _exchangeId = StringUtils::format("%p", this);
+
 }
 
 LuaObjectDescriptor::LuaObjectDescriptor (LuaObjectDecoder *decoder)
@@ -69,7 +70,7 @@ LuaObjectDescriptor::LuaObjectDescriptor (LuaObjectDecoder *decoder)
     objRef = (void *)decoder -> readInt64();
     setObject(objRef);
 
-    _exchangeId = decoder -> readString();
+    _linkId = atoi(decoder -> readString().c_str());
     
     //读取类型
     std::string typeName = decoder -> readString();
@@ -77,7 +78,7 @@ LuaObjectDescriptor::LuaObjectDescriptor (LuaObjectDecoder *decoder)
     
     //读取用户数据
     int size = decoder -> readInt32();
-    for (int i = 0; i < size; i++)
+    for (int i = 0; i < size && !decoder -> isTruncated(); i++)
     {
         std::string key = decoder -> readString();
         std::string value = decoder -> readString();
@@ -188,7 +189,7 @@ void LuaObjectDescriptor::serialization (LuaObjectEncoder *encoder)
     LuaObject::serialization(encoder);
     
     encoder -> writeInt64((long long)_object);
-    encoder -> writeString(_exchangeId);
+    encoder -> writeString(getExchangeId());
     
     //写入类型标识
     if (_typeDescriptor != NULL)
@@ -17,19 +17,30 @@ using namespace cn::vimfung::luascriptcore;
 typedef std::map<std::string, std::string> MappingClassesMap;
 static MappingClassesMap _mappingClassesMap;
 
+/**
+ 编码器缓冲区的初始容量
+ */
+static const int EncoderInitialCapacity = 64;
+
 LuaObjectEncoder::LuaObjectEncoder (LuaContext *context)
-    :_buf(NULL), _bufLength(0), _context(context)
+    :_buf(NULL), _bufLength(0), _bufCapacity(0), _ownsBuffer(true), _context(context)
 {
     
 }
 
+LuaObjectEncoder::LuaObjectEncoder (LuaContext *context, void *buffer, int capacity)
+    :_buf(buffer), _bufLength(0), _bufCapacity(buffer != NULL ? capacity : 0), _ownsBuffer(buffer == NULL), _context(context)
+{
+
+}
+
 LuaObjectEncoder::~LuaObjectEncoder()
 {
-    if (_buf != NULL)
+    if (_buf != NULL && _ownsBuffer)
     {
         free(_buf);
-        _buf = NULL;
     }
+    _buf = NULL;
 }
 
 LuaContext* LuaObjectEncoder::getContext()
@@ -39,20 +50,32 @@ LuaContext* LuaObjectEncoder::getContext()
 
 void LuaObjectEncoder::reallocBuffer(int size)
 {
-    if (_bufLength == 0)
+    int length = _bufLength + size;
+    if (length <= _bufCapacity)
     {
-        _bufLength = size;
-        _buf = malloc(size);
-        memset(_buf, 0, _bufLength);
+        return;
+    }
+
+    int capacity = _bufCapacity > 0 ? _bufCapacity : EncoderInitialCapacity;
+    while (capacity < length)
+    {
+        capacity *= 2;
+    }
+
+    if (_ownsBuffer)
+    {
+        _buf = realloc(_buf, capacity);
     }
     else
     {
-        _buf = realloc(_buf, _bufLength + size);
-        
-        void *offset = (char *)_buf + _bufLength;
-        memset(offset, 0, size);
-        _bufLength += size;
+        //调用方提供的缓冲区容量不足，改为使用自身分配的缓冲区
+        void *buf = malloc(capacity);
+        memcpy(buf, _buf, _bufLength);
+        _buf = buf;
+        _ownsBuffer = true;
     }
+
+    _bufCapacity = capacity;
 }
 
 void LuaObjectEncoder::writeByte(char value)
@@ -62,45 +85,62 @@ void LuaObjectEncoder::writeByte(char value)
 
 void LuaObjectEncoder::writeBuffer(const void *bytes, int length)
 {
-    reallocBuffer(length);
+    if (length <= 0)
+    {
+        return;
+    }
+
+    if (_bufLength == 0)
+    {
+        //新消息，先写入v2格式头部
+        reallocBuffer(length + 2);
+        ((unsigned char *)_buf)[0] = LUA_OBJECT_ENCODING_MAGIC;
+        ((unsigned char *)_buf)[1] = LUA_OBJECT_ENCODING_VERSION_2;
+        _bufLength = 2;
+    }
+    else
+    {
+        reallocBuffer(length);
+    }
     
-    void *offset = (void *)((char *)_buf + _bufLength - length);
-    memcpy(offset, bytes, length);
+    memcpy((char *)_buf + _bufLength, bytes, length);
+    _bufLength += length;
 }
 
-void LuaObjectEncoder::writeInt16(short value)
+void LuaObjectEncoder::writeVarUInt(unsigned long long value)
 {
-    char buf[2] = {0};
-    buf[0] = value >> 8 & 0xff;
-    buf[1] = value & 0xff;
+    unsigned char buf[10];
+    int length = 0;
     
-    writeBuffer(buf, 2);
+    do
+    {
+        unsigned char byte = value & 0x7f;
+        value >>= 7;
+        if (value != 0)
+        {
+            byte |= 0x80;
+        }
+        buf[length++] = byte;
+    }
+    while (value != 0);
+    
+    writeBuffer(buf, length);
+}
+
+void LuaObjectEncoder::writeInt16(short value)
+{
+    writeInt64(value);
 }
 
 void LuaObjectEncoder::writeInt32(int value)
 {
-    char buf[4] = {0};
-    buf[0] = (value >> 24) & 0xff;
-    buf[1] = (value >> 16) & 0xff;
-    buf[2] = (value >> 8) & 0xff;
-    buf[3] = value & 0xff;
-    
-    writeBuffer(buf, 4);
+    writeInt64(value);
 }
 
 void LuaObjectEncoder::writeInt64(long long value)
 {
-    char buf[8] = {0};
-    buf[0] = value >> 56 & 0xff;
-    buf[1] = value >> 48 & 0xff;
-    buf[2] = value >> 40 & 0xff;
-    buf[3] = value >> 32 & 0xff;
-    buf[4] = value >> 24 & 0xff;
-    buf[5] = value >> 16 & 0xff;
-    buf[6] = value >> 8 & 0xff;
-    buf[7] = value & 0xff;
-    
-    writeBuffer(buf, 8);
+    //zigzag编码，使绝对值较小的负数也只占用少量字节
+    writeVarUInt(((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63));
 }
 
 void LuaObjectEncoder::writeDouble(double value)
@@ -125,15 +165,27 @@ void LuaObjectEncoder::writeObject(LuaObject *object)
     MappingClassesMap::iterator it = _mappingClassesMap.find(typeName);
     if (it != _mappingClassesMap.end())
     {
-        this -> writeByte('L');
-        this -> writeString(it -> second);
-        this -> writeByte(';');
+        typeName = it -> second;
     }
-    else
+    
+    std::map<std::string, int>::iterator indexIt = _classIndexes.find(typeName);
+    if (indexIt == _classIndexes.end())
     {
-        this -> writeByte('L');
+        //首次出现的类型写入名称，之后以索引引用
+        int index = (int)_classIndexes.size();
+        _classIndexes[typeName] = index;
+        
+        this -> writeByte(LUA_OBJECT_TAG_CLASS_NAME);
         this -> writeString(typeName);
-        this -> writeByte(';');
+    }
+    else if (indexIt -> second < LUA_OBJECT_TAG_CLASS_INLINE_INDEX_COUNT)
+    {
+        this -> writeByte((char)(LUA_OBJECT_TAG_CLASS_INLINE_INDEX | indexIt -> second));
+    }
+    else
+    {
+        this -> writeByte(LUA_OBJECT_TAG_CLASS_INDEX);
+        this -> writeVarUInt(indexIt -> second);
     }
     
     object -> serialization(this);
@@ -156,6 +208,38 @@ int LuaObjectEncoder::getBufferLength()
     return _bufLength;
 }
 
+void* LuaObjectEncoder::detachBuffer()
+{
+    if (_bufLength == 0)
+    {
+        return NULL;
+    }
+
+    void *buf = _buf;
+    if (_ownsBuffer)
+    {
+        //移交自身分配的缓冲区，无需复制
+        _buf = NULL;
+        _bufCapacity = 0;
+    }
+    else
+    {
+        buf = malloc(_bufLength);
+        memcpy(buf, _buf, _bufLength);
+    }
+
+    _bufLength = 0;
+    _classIndexes.clear();
+
+    return buf;
+}
+
+void LuaObjectEncoder::reset()
+{
+    _bufLength = 0;
+    _classIndexes.clear();
+}
+
 void LuaObjectEncoder::setMappingClassType(std::string const& className, std::string const& mappingClassName)
 {
     _mappingClassesMap[className] = mappingClassName;
@@ -167,9 +251,9 @@ int LuaObjectEncoder::encodeObject(LuaContext *context, LuaObject *object, const
     {
         LuaObjectEncoder *encoder = new LuaObjectEncoder(context);
         encoder -> writeObject(object);
-        *bytes = (void *)encoder -> cloneBuffer();
         
         int bufferLen = encoder -> getBufferLength();
+        *bytes = encoder -> detachBuffer();
         encoder -> release();
         
         return bufferLen;
@@ -11,6 +11,7 @@
 
 #include <stdio.h>
 #include <string>
+#include <map>
 #include "LuaObject.h"
 
 namespace cn
@@ -23,7 +24,7 @@ namespace cn
             class LuaContext;
             
             /**
-             对象编码器
+             对象编码器，以v2格式写入数据，格式说明见LuaObjectSerializationTypes.h
              */
             class LuaObjectEncoder : public LuaObject
             {
@@ -35,9 +36,24 @@ namespace cn
                 void *_buf;
                 
                 /**
-                 缓冲区大小
+                 已写入数据大小
                  */
                 int _bufLength;
+
+                /**
+                 缓冲区容量
+                 */
+                int _bufCapacity;
+
+                /**
+                 是否持有缓冲区，调用方提供的缓冲区不由编码器释放
+                 */
+                bool _ownsBuffer;
+
+                /**
+                 类型名称字典，记录当前消息中已写入的类型名称及其索引
+                 */
+                std::map<std::string, int> _classIndexes;
                 
                 /**
                  上下文对象
@@ -47,11 +63,18 @@ namespace cn
             private:
                 
                 /**
-                 重新分配缓冲区
+                 确保缓冲区剩余容量足够，容量不足时按倍数扩展，避免每次写入都重新分配
 
-                 @param size 新增大小
+                 @param size 需要写入的大小
                  */
                 void reallocBuffer(int size);
+
+                /**
+                 写入一个无符号变长整数（LEB128）
+
+                 @param value 整数值
+                 */
+                void writeVarUInt(unsigned long long value);
                 
             public:
                 
@@ -62,6 +85,16 @@ namespace cn
                  */
                 LuaObjectEncoder (LuaContext *context);
                 
+                /**
+                 使用调用方提供的缓冲区创建对象编码器，可传入栈上或缓存池中的缓冲区以避免分配内存。
+                 写入数据超出容量时会改为使用编码器分配的缓冲区，调用方提供的缓冲区需要在编码器使用期间保持有效。
+
+                 @param context 上下文对象
+                 @param buffer 缓冲区
+                 @param capacity 缓冲区容量
+                 */
+                LuaObjectEncoder (LuaContext *context, void *buffer, int capacity);
+                
                 /**
                  析构对象编码器
                  */
@@ -87,21 +120,21 @@ namespace cn
                 void writeByte(char value);
                 
                 /**
-                 写入一个16位整型
+                 写入一个16位整型，以zigzag变长整数写入
 
                  @param value 16位整型值
                  */
                 void writeInt16(short value);
                 
                 /**
-                 写入一个32位整型
+                 写入一个32位整型，以zigzag变长整数写入
 
                  @param value 32位整型值
                  */
                 void writeInt32(int value);
                 
                 /**
-                 写入一个64位整型
+                 写入一个64位整型，以zigzag变长整数写入
 
                  @param value 64位整型值
                  */
@@ -160,6 +193,19 @@ namespace cn
                  */
                 int getBufferLength();
                 
+                /**
+                 移交缓冲区数据，调用方取得缓冲区所有权并使用free释放，移交后编码器被清空。
+                 编码器持有缓冲区时直接移交，不会复制数据
+
+                 @return 缓冲区数据，没有数据时返回NULL
+                 */
+                void* detachBuffer();
+
+                /**
+                 重置编码器，清空已写入数据并保留缓冲区，用于复用编码器
+                 */
+                void reset();
+                
             public:
                 
                 /**
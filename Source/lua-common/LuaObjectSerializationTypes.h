@@ -16,4 +16,53 @@ typedef union
     
 }DoubleStruct;
 
+/*
+ 数据格式说明：
+ 
+ v1格式没有头部，整数以大端序定长写入，对象以'L' + 类型名称 + ';'开头。
+ v2格式以LUA_OBJECT_ENCODING_MAGIC及版本号两个字节开头，整数（包括字符串及二进制数据的长度）
+ 使用zigzag编码后以LEB128变长写入，浮点数仍以8字节写入。对象以一个字节的标记开头，
+ 类型名称在每个消息中只写入一次，之后以其在字典中的索引引用。
+ */
+
+/**
+ v2格式的头部标识，v1格式的首字节只可能为'L'或大端序整数的高位字节，不会与之冲突
+ */
+#define LUA_OBJECT_ENCODING_MAGIC 0xFF
+
+/**
+ v1格式版本号
+ */
+#define LUA_OBJECT_ENCODING_VERSION_1 1
+
+/**
+ v2格式版本号
+ */
+#define LUA_OBJECT_ENCODING_VERSION_2 2
+
+/**
+ v2对象标记：新类型名称，后跟类型名称字符串，并按出现顺序加入类型名称字典
+ */
+#define LUA_OBJECT_TAG_CLASS_NAME 0x01
+
+/**
+ v2对象标记：类型名称索引，后跟变长整数索引，用于索引不小于LUA_OBJECT_TAG_CLASS_INLINE_INDEX_COUNT的类型
+ */
+#define LUA_OBJECT_TAG_CLASS_INDEX 0x02
+
+/**
+ v2对象标记：非导出对象引用，后跟64位整数引用标识
+ */
+#define LUA_OBJECT_TAG_REFERENCE 0x03
+
+/**
+ v2对象标记：内联类型名称索引，标记的低7位为索引，常见类型只需一个字节
+ */
+#define LUA_OBJECT_TAG_CLASS_INLINE_INDEX 0x80
+
+/**
+ 可内联在标记中的类型名称索引数量
+ */
+#define LUA_OBJECT_TAG_CLASS_INLINE_INDEX_COUNT 0x80
+
 #endif /* LuaObjectSerializationTypes_h */
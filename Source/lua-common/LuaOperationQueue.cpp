@@ -3,12 +3,216 @@
 //
 
 #include "LuaOperationQueue.h"
+#include <condition_variable>
+#include <stdint.h>
 
 
+namespace cn {
+    namespace vimfung {
+        namespace luascriptcore {
+
+            /**
+             * 执行器状态，内部为有界多生产者单消费者无锁队列
+             */
+            struct LuaOperationExecutor
+            {
+                /**
+                 * 队列单元
+                 */
+                struct Cell
+                {
+                    std::atomic<size_t> sequence;
+                    std::function<void(void)> action;
+                };
+
+                Cell *cells;
+                size_t capacityMask;
+
+                //入队位置由多个生产者竞争，与出队位置分开在不同缓存行
+                char padding0[64];
+                std::atomic<size_t> enqueuePos;
+                char padding1[64];
+                size_t dequeuePos;
+                char padding2[64];
+
+                std::atomic<bool> stopping;
+                std::atomic<bool> idle;
+                std::mutex idleMutex;
+                std::condition_variable idleCond;
+                std::thread thread;
+
+                LuaOperationExecutor(size_t capacity)
+                    : capacityMask(capacity - 1), enqueuePos(0), dequeuePos(0), stopping(false), idle(false)
+                {
+                    cells = new Cell[capacity];
+                    for (size_t i = 0; i < capacity; i++)
+                    {
+                        cells[i].sequence.store(i, std::memory_order_relaxed);
+                    }
+                }
+
+                ~LuaOperationExecutor()
+                {
+                    delete[] cells;
+                }
+
+                /**
+                 * 入队，队列已满时返回false
+                 */
+                bool enqueue(std::function<void(void)> const& action)
+                {
+                    Cell *cell = NULL;
+                    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+
+                    for (;;)
+                    {
+                        cell = &cells[pos & capacityMask];
+                        size_t seq = cell -> sequence.load(std::memory_order_acquire);
+                        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+                        if (diff == 0)
+                        {
+                            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                            {
+                                break;
+                            }
+                        }
+                        else if (diff < 0)
+                        {
+                            return false;
+                        }
+                        else
+                        {
+                            pos = enqueuePos.load(std::memory_order_relaxed);
+                        }
+                    }
+
+                    cell -> action = action;
+                    cell -> sequence.store(pos + 1, std::memory_order_release);
+
+                    return true;
+                }
+
+                /**
+                 * 出队，仅在执行器线程调用，队列为空时返回false
+                 */
+                bool dequeue(std::function<void(void)> &action)
+                {
+                    Cell *cell = &cells[dequeuePos & capacityMask];
+                    size_t seq = cell -> sequence.load(std::memory_order_acquire);
+
+                    if (seq != dequeuePos + 1)
+                    {
+                        return false;
+                    }
+
+                    action.swap(cell -> action);
+                    cell -> sequence.store(dequeuePos + capacityMask + 1, std::memory_order_release);
+                    dequeuePos++;
+
+                    return true;
+                }
+
+                /**
+                 * 是否有待执行操作
+                 */
+                bool hasPending()
+                {
+                    Cell *cell = &cells[dequeuePos & capacityMask];
+                    return cell -> sequence.load(std::memory_order_acquire) == dequeuePos + 1;
+                }
+
+                /**
+                 * 唤醒空闲的执行器
+                 */
+                void wakeup()
+                {
+                    //与执行器进入空闲前的检测配对，保证不会丢失唤醒
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    if (idle.load())
+                    {
+                        std::lock_guard<std::mutex> lock(idleMutex);
+                        idleCond.notify_one();
+                    }
+                }
+
+                /**
+                 * 投递操作，队列满时让出时间片等待执行器消费
+                 */
+                void push(std::function<void(void)> const& action)
+                {
+                    while (!enqueue(action))
+                    {
+                        std::this_thread::yield();
+                    }
+
+                    wakeup();
+                }
+
+                /**
+                 * 执行器线程入口
+                 */
+                static void run(std::shared_ptr<LuaOperationExecutor> executor)
+                {
+                    std::function<void(void)> action;
+
+                    for (;;)
+                    {
+                        if (executor -> dequeue(action))
+                        {
+                            try
+                            {
+                                action();
+                            }
+                            catch (...)
+                            {
+                                //投递的操作没有等待者，异常在此处丢弃
+                            }
+
+                            action = nullptr;
+                            continue;
+                        }
+
+                        if (executor -> stopping.load())
+                        {
+                            break;
+                        }
+
+                        std::unique_lock<std::mutex> lock(executor -> idleMutex);
+                        executor -> idle.store(true);
+                        std::atomic_thread_fence(std::memory_order_seq_cst);
+                        executor -> idleCond.wait(lock, [&executor]() {
+                            return executor -> stopping.load() || executor -> hasPending();
+                        });
+                        executor -> idle.store(false);
+                    }
+                }
+            };
+
+            /**
+             * 同步操作的完成状态，位于等待线程的栈上，避免每次调用分配promise及future
+             */
+            struct LuaOperationCompletion
+            {
+                std::mutex mutex;
+                std::condition_variable cond;
+                bool done;
+                std::exception_ptr error;
+
+                LuaOperationCompletion()
+                    : done(false)
+                {
+
+                }
+            };
+        }
+    }
+}
 
 using namespace cn::vimfung::luascriptcore;
 
 LuaOperationQueue::LuaOperationQueue()
+    : _mode(LuaOperationQueueModeLock)
 {
 #if _WINDOWS
 	InitializeCriticalSection(&_lock);
@@ -21,8 +225,49 @@ LuaOperationQueue::LuaOperationQueue()
 #endif
 }
 
+LuaOperationQueue::LuaOperationQueue(LuaOperationQueueMode mode, int capacity)
+    : LuaOperationQueue()
+{
+    _mode = mode;
+
+    if (_mode == LuaOperationQueueModeExecutor)
+    {
+        //容量取整为2的幂，便于通过掩码定位单元
+        size_t size = 2;
+        while (size < (size_t)capacity)
+        {
+            size <<= 1;
+        }
+
+        _executor = std::make_shared<LuaOperationExecutor>(size);
+        _executor -> thread = std::thread(LuaOperationExecutor::run, _executor);
+        _executorId = _executor -> thread.get_id();
+    }
+}
+
 LuaOperationQueue::~LuaOperationQueue()
 {
+    if (_executor)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_executor -> idleMutex);
+            _executor -> stopping.store(true);
+        }
+        _executor -> idleCond.notify_one();
+
+        if (isExecutorThread())
+        {
+            //在执行器线程中销毁队列（如在回调中释放了上下文），无法等待自身结束，执行器状态由线程持有至退出
+            _executor -> thread.detach();
+        }
+        else if (_executor -> thread.joinable())
+        {
+            _executor -> thread.join();
+        }
+
+        _executor.reset();
+    }
+
 #if _WINDOWS
 	DeleteCriticalSection(&_lock);
 #else
@@ -30,15 +275,140 @@ LuaOperationQueue::~LuaOperationQueue()
 #endif
 }
 
+LuaOperationQueueMode LuaOperationQueue::getMode()
+{
+    return _mode;
+}
+
+bool LuaOperationQueue::isExecutorThread()
+{
+    return _mode == LuaOperationQueueModeExecutor && std::this_thread::get_id() == _executorId;
+}
+
 void LuaOperationQueue::performAction(std::function<void(void)> const& action)
 {
+    if (_mode == LuaOperationQueueModeExecutor)
+    {
+        if (isExecutorThread())
+        {
+            //重入调用直接执行
+            action();
+        }
+        else
+        {
+            LuaOperationCompletion completion;
+            LuaOperationCompletion *completionPtr = &completion;
+            const std::function<void(void)> *actionPtr = &action;
+
+            //仅捕获两个指针，可存放于std::function的内部存储中而无需分配内存
+            _executor -> push([completionPtr, actionPtr]() {
+
+                std::exception_ptr error;
+                try
+                {
+                    (*actionPtr)();
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+
+                //在锁内通知，等待线程只有在通知完成后才能返回并销毁完成状态
+                std::lock_guard<std::mutex> lock(completionPtr -> mutex);
+                completionPtr -> error = error;
+                completionPtr -> done = true;
+                completionPtr -> cond.notify_one();
+
+            });
+
+            std::unique_lock<std::mutex> lock(completion.mutex);
+            completion.cond.wait(lock, [&completion]() {
+                return completion.done;
+            });
+
+            if (completion.error)
+            {
+                std::rethrow_exception(completion.error);
+            }
+        }
+
+        return;
+    }
+
+    //操作抛出异常时需要先解锁再抛出，否则锁将一直被持有
 #if _WINDOWS
 	EnterCriticalSection(&_lock);
-	action();
+	try
+	{
+		action();
+	}
+	catch (...)
+	{
+		LeaveCriticalSection(&_lock);
+		throw;
+	}
 	LeaveCriticalSection(&_lock);
 #else
     pthread_mutex_lock(&_lock);
-    action();
+    try
+    {
+        action();
+    }
+    catch (...)
+    {
+        pthread_mutex_unlock(&_lock);
+        throw;
+    }
     pthread_mutex_unlock(&_lock);
 #endif
 }
+
+void LuaOperationQueue::post(std::function<void(void)> const& action)
+{
+    if (_mode != LuaOperationQueueModeExecutor)
+    {
+        performAction(action);
+    }
+    else if (!isExecutorThread())
+    {
+        _executor -> push(action);
+    }
+    else if (!_executor -> enqueue(action))
+    {
+        //执行器线程自身投递且队列已满时，无法等待自己出队，只能直接执行。
+        //此时该操作会先于已在队列中的操作执行，见头文件中post的说明
+        action();
+    }
+}
+
+std::future<void> LuaOperationQueue::submit(std::function<void(void)> const& action)
+{
+    std::shared_ptr<std::promise<void> > promise = std::make_shared<std::promise<void> >();
+    std::future<void> future = promise -> get_future();
+
+    std::function<void(void)> task = [promise, action]() {
+
+        try
+        {
+            action();
+            promise -> set_value();
+        }
+        catch (...)
+        {
+            promise -> set_exception(std::current_exception());
+        }
+
+    };
+
+    if (_mode == LuaOperationQueueModeExecutor && !isExecutorThread())
+    {
+        _executor -> push(task);
+    }
+    else
+    {
+        //加锁模式或执行器线程中提交的操作直接执行，避免等待自身造成死锁
+        performAction(task);
+    }
+
+    return future;
+}
@@ -6,9 +6,13 @@
 #define ANDROID_LUAOPERATIONQUEUE_H
 
 #include "LuaObject.h"
+#include "LuaDefined.h"
 #include <mutex>
 #include <functional>
 #include <thread>
+#include <atomic>
+#include <future>
+#include <memory>
 
 #if _WINDOWS
 
@@ -24,6 +28,8 @@ namespace cn {
     namespace vimfung {
         namespace luascriptcore {
 
+            struct LuaOperationExecutor;
+
             /**
              * 操作队列
              */
@@ -33,23 +39,73 @@ namespace cn {
             public:
 
                 /**
-                 * 初始化
+                 * 执行器模式下默认的队列容量
+                 */
+                static const int DefaultCapacity = 1024;
+
+                /**
+                 * 初始化，使用加锁模式
                  */
                 LuaOperationQueue();
 
+                /**
+                 * 初始化
+                 *
+                 * @param mode 队列模式
+                 * @param capacity 执行器模式下提交队列的容量，会向上取整为2的幂
+                 */
+                LuaOperationQueue(LuaOperationQueueMode mode, int capacity);
+
                 /**
                  * 销毁
                  */
                 ~LuaOperationQueue();
 
                 /**
-                 * 执行操作
+                 * 获取队列模式
+                 *
+                 * @return 队列模式
+                 */
+                LuaOperationQueueMode getMode();
+
+                /**
+                 * 判断当前线程是否为执行器线程
+                 *
+                 * @return true 表示当前处于执行器线程中，否则不是。加锁模式下始终返回false
+                 */
+                bool isExecutorThread();
+
+                /**
+                 * 执行操作，操作完成后返回。执行器模式下在其他线程调用时，操作中抛出的异常会在调用线程中重新抛出
                  * @param action 操作内容
                  */
                 void performAction(std::function<void(void)> const& action);
 
+                /**
+                 * 投递操作，不等待操作完成。加锁模式下直接执行操作。
+                 * 执行器模式下投递的操作按入队顺序执行，但有一个例外：在执行器线程中投递且队列已满时，
+                 * 由于执行器无法等待自身出队，操作会被立即执行，从而先于队列中已有的操作。
+                 * 需要严格顺序的调用方应避免在执行器线程中连续投递超过队列容量的操作。
+                 *
+                 * @param action 操作内容
+                 */
+                void post(std::function<void(void)> const& action);
+
+                /**
+                 * 提交操作
+                 *
+                 * @param action 操作内容
+                 * @return 操作完成的future，操作中抛出的异常会在get时重新抛出
+                 */
+                std::future<void> submit(std::function<void(void)> const& action);
+
             private:
 
+                /**
+                 * 队列模式
+                 */
+                LuaOperationQueueMode _mode;
+
                 /**
                  * 锁
                  */
@@ -58,6 +114,16 @@ namespace cn {
 #else
                 pthread_mutex_t _lock;
 #endif
+
+                /**
+                 * 执行器状态，由队列与执行器线程共同持有，保证在执行器线程中销毁队列时线程仍可安全退出
+                 */
+                std::shared_ptr<LuaOperationExecutor> _executor;
+
+                /**
+                 * 执行器线程标识
+                 */
+                std::thread::id _executorId;
             };
         }
     }
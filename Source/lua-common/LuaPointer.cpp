@@ -32,7 +32,6 @@ LuaPointer::LuaPointer(LuaContext *context, LuaUserdataRef userdata)
 {
     _needFree = false;
     _value = userdata;
-    _exchangeId = StringUtils::format("%p", _value);
 }
 
 LuaPointer::LuaPointer(LuaContext *context, const void *value)
@@ -41,7 +40,6 @@ LuaPointer::LuaPointer(LuaContext *context, const void *value)
     _needFree = true;
     _value = (LuaUserdataRef)malloc(sizeof(LuaUserdataRef));
     _value -> value = (void *)value;
-    _exchangeId = StringUtils::format("%p", _value);
 }
 
 LuaPointer::~LuaPointer()
@@ -63,7 +61,7 @@ LuaPointer::LuaPointer (LuaObjectDecoder *decoder)
     _value = (LuaUserdataRef)malloc(sizeof(LuaUserdataRef));
     _value -> value = (void *)objRef;
     
-    _exchangeId = decoder -> readString();
+    _linkId = atoi(decoder -> readString().c_str());
 }
 
 std::string LuaPointer::typeName()
@@ -81,7 +79,7 @@ void LuaPointer::serialization (LuaObjectEncoder *encoder)
 {
     LuaObject::serialization(encoder);
     encoder -> writeInt64((long long)_value -> value);
-    encoder -> writeString(_exchangeId);
+    encoder -> writeString(getExchangeId());
 }
 
 void LuaPointer::push(LuaContext *context)
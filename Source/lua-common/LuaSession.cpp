@@ -3,6 +3,7 @@
 //
 
 #include "LuaSession.h"
+#include "LuaContext.h"
 #include "LuaValue.h"
 #include "LuaTuple.h"
 #include "LuaEngineAdapter.hpp"
@@ -18,10 +19,7 @@ LuaSession::LuaSession(lua_State *state, LuaContext *context, bool lightweight)
 
 LuaSession::~LuaSession()
 {
-    if (!_lightweight)
-    {
-        _context -> gc();
-    }
+
 }
 
 lua_State* LuaSession::getState()
@@ -34,6 +32,20 @@ LuaContext* LuaSession::getContext()
     return _context;
 }
 
+bool LuaSession::isLightweight()
+{
+    return _lightweight;
+}
+
+void LuaSession::reset(lua_State *state, bool lightweight)
+{
+    _state = state;
+    _lightweight = lightweight;
+    _hasErr = false;
+    _lastErrMsg.clear();
+    prevSession = NULL;
+}
+
 void LuaSession::parseArguments(LuaArgumentList &argumentList)
 {
     parseArguments(argumentList, 1);
@@ -99,8 +111,38 @@ void LuaSession::checkException()
     }
 }
 
+bool LuaSession::takeException(std::string &message)
+{
+    if (!_hasErr)
+    {
+        return false;
+    }
+
+    _hasErr = false;
+    message.swap(_lastErrMsg);
+    _lastErrMsg = "";
+
+    return true;
+}
+
 void LuaSession::reportLuaException(std::string const& message)
 {
     _hasErr = true;
     _lastErrMsg = message;
 }
+
+LuaSessionScope::LuaSessionScope(lua_State *state, LuaContext *context, bool lightweight)
+    : _session(state, context, lightweight)
+{
+    context -> enterSession(&_session);
+}
+
+LuaSessionScope::~LuaSessionScope()
+{
+    _session.getContext() -> leaveSession(&_session);
+}
+
+LuaSession* LuaSessionScope::getSession()
+{
+    return &_session;
+}
@@ -37,7 +37,7 @@ namespace cn {
                  *
                  * @param state 状态
                  * @param context 上下文对象
-                 * @param lightweight 是否为轻量级会话，ture时表示绘画销毁时不需要进行内存回收，否则需要
+                 * @param lightweight 是否为轻量级会话，ture时表示离开会话时不需要请求内存回收，否则需要
                  */
                 LuaSession(lua_State *state, LuaContext *context, bool lightweight);
 
@@ -61,6 +61,21 @@ namespace cn {
                  * @return 上下文对象
                  */
                 LuaContext* getContext();
+
+                /**
+                 * 是否为轻量级会话
+                 *
+                 * @return true 表示离开会话时不需要请求内存回收
+                 */
+                bool isLightweight();
+
+                /**
+                 * 重置会话，用于复用会话对象
+                 *
+                 * @param state 状态
+                 * @param lightweight 是否为轻量级会话
+                 */
+                void reset(lua_State *state, bool lightweight);
                 
                 /**
                  上一个会话
@@ -103,6 +118,49 @@ namespace cn {
                  * 检测异常，如果存在异常则进行中断lua执行
                  */
                 void checkException();
+
+                /**
+                 * 取出异常信息，取出后异常被清除。用于在抛出Lua异常前先销毁原生对象
+                 *
+                 * @param message 异常信息
+                 *
+                 * @return true 表示存在异常，否则不存在
+                 */
+                bool takeException(std::string &message);
+            };
+
+            /**
+             * 会话作用域，在栈上创建会话并进入，离开作用域时自动离开会话，无需分配会话对象。
+             * 作用域内不能抛出Lua异常（longjmp不会执行析构），需要先取出异常信息，离开作用域后再抛出
+             */
+            class LuaSessionScope
+            {
+            private:
+
+                LuaSession _session;
+
+            public:
+
+                /**
+                 * 初始化，创建并进入会话
+                 *
+                 * @param state 状态
+                 * @param context 上下文对象
+                 * @param lightweight 是否为轻量级会话
+                 */
+                LuaSessionScope(lua_State *state, LuaContext *context, bool lightweight);
+
+                /**
+                 * 离开会话
+                 */
+                ~LuaSessionScope();
+
+                /**
+                 * 获取会话
+                 *
+                 * @return 会话对象
+                 */
+                LuaSession* getSession();
             };
         }
     }
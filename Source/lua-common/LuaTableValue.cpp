@@ -0,0 +1,408 @@
+#include "LuaTableValue.hpp"
+#include "LuaContext.h"
+#include "LuaSession.h"
+#include "LuaDataExchanger.h"
+#include "LuaEngineAdapter.hpp"
+#include "LuaOperationQueue.h"
+#include "StringUtils.h"
+
+using namespace cn::vimfung::luascriptcore;
+
+LuaTableValue::LuaTableValue(LuaContext *context, int index)
+{
+    //持有上下文直到释放表引用，避免上下文先于值对象销毁
+    _context = context;
+    _context -> retain();
+    _numberArray = NULL;
+    _integerArray = NULL;
+    _parsedValue = NULL;
+
+    _context -> getOperationQueue() -> performAction([=](){
+
+        lua_State *state = _context -> getCurrentSession() -> getState();
+
+        //在注册表中持有表，避免被回收
+        LuaEngineAdapter::pushValue(state, index);
+        _ref = LuaEngineAdapter::ref(state, LUA_REGISTRYINDEX);
+
+    });
+}
+
+LuaTableValue::~LuaTableValue()
+{
+    if (_parsedValue != NULL)
+    {
+        _parsedValue -> release();
+        _parsedValue = NULL;
+    }
+
+    if (_numberArray != NULL)
+    {
+        delete _numberArray;
+        _numberArray = NULL;
+    }
+
+    if (_integerArray != NULL)
+    {
+        delete _integerArray;
+        _integerArray = NULL;
+    }
+
+    _context -> getOperationQueue() -> performAction([=](){
+
+        lua_State *state = _context -> getCurrentSession() -> getState();
+        LuaEngineAdapter::unref(state, LUA_REGISTRYINDEX, _ref);
+
+    });
+
+    _context -> release();
+    _context = NULL;
+}
+
+void LuaTableValue::_pushTable()
+{
+    lua_State *state = _context -> getCurrentSession() -> getState();
+    LuaEngineAdapter::rawGetI(state, LUA_REGISTRYINDEX, _ref);
+}
+
+void LuaTableValue::_parseValue()
+{
+    if (_parsedValue != NULL)
+    {
+        return;
+    }
+
+    LuaValueType type = getType();
+
+    _context -> getOperationQueue() -> performAction([=](){
+
+        lua_State *state = _context -> getCurrentSession() -> getState();
+        LuaDataExchanger *dataExchanger = _context -> getDataExchanger();
+
+        _pushTable();
+
+        if (type == LuaValueTypeArray)
+        {
+            LuaValueList arrayValue;
+
+            size_t length = LuaEngineAdapter::rawLen(state, -1);
+            for (size_t i = 1; i <= length; i++)
+            {
+                LuaEngineAdapter::rawGetI(state, -1, (int)i);
+                arrayValue.push_back(dataExchanger -> getValue(-1));
+                LuaEngineAdapter::pop(state, 1);
+            }
+
+            _parsedValue = LuaValue::ArrayValue(arrayValue);
+        }
+        else
+        {
+            LuaValueMap dictValue;
+
+            LuaEngineAdapter::pushNil(state);
+            while (LuaEngineAdapter::next(state, -2))
+            {
+                switch (LuaEngineAdapter::type(state, -2))
+                {
+                    case LUA_TNUMBER:
+                    {
+                        std::string key = StringUtils::format("%g", LuaEngineAdapter::toNumber(state, -2));
+                        LuaValueMap::iterator it = dictValue.find(key);
+                        if (it != dictValue.end())
+                        {
+                            it -> second -> release();
+                        }
+                        dictValue[key] = dataExchanger -> getValue(-1);
+                        break;
+                    }
+                    case LUA_TSTRING:
+                    {
+                        size_t len = 0;
+                        const char *key = LuaEngineAdapter::toLString(state, -2, &len);
+                        dictValue[std::string(key, len)] = dataExchanger -> getValue(-1);
+                        break;
+                    }
+                    default:
+                        break;
+                }
+
+                LuaEngineAdapter::pop(state, 1);
+            }
+
+            _parsedValue = LuaValue::DictonaryValue(dictValue);
+        }
+
+        LuaEngineAdapter::pop(state, 1);
+
+    });
+}
+
+LuaValueType LuaTableValue::_checkTableType(lua_State *state, bool &isNumberSequence, bool &isIntegerSequence)
+{
+    //仅检查键及值的类型，不转换值。键的数量与长度一致且均为1到长度之间的整数时为数组
+    size_t length = LuaEngineAdapter::rawLen(state, -1);
+    size_t count = 0;
+    bool isArray = true;
+    isNumberSequence = true;
+    isIntegerSequence = true;
+
+    LuaEngineAdapter::pushNil(state);
+    while (LuaEngineAdapter::next(state, -2))
+    {
+        count++;
+
+        lua_Number key = 0;
+        if (LuaEngineAdapter::type(state, -2) == LUA_TNUMBER)
+        {
+            key = LuaEngineAdapter::toNumber(state, -2);
+        }
+
+        if (count > length || key < 1 || key > length || key != (lua_Number)(size_t)key)
+        {
+            isArray = false;
+            LuaEngineAdapter::pop(state, 2);
+            break;
+        }
+
+        if (isNumberSequence && LuaEngineAdapter::type(state, -1) != LUA_TNUMBER)
+        {
+            isNumberSequence = false;
+            isIntegerSequence = false;
+        }
+        else if (isIntegerSequence && !LuaEngineAdapter::isInteger(state, -1))
+        {
+            isIntegerSequence = false;
+        }
+
+        LuaEngineAdapter::pop(state, 1);
+    }
+
+    isArray = isArray && count == length;
+    isNumberSequence = isArray && isNumberSequence;
+    isIntegerSequence = isArray && isIntegerSequence;
+
+    return isArray ? LuaValueTypeArray : LuaValueTypeMap;
+}
+
+LuaValueType LuaTableValue::getType()
+{
+    LuaValueType type = LuaValueTypeMap;
+
+    _context -> getOperationQueue() -> performAction([=, &type](){
+
+        lua_State *state = _context -> getCurrentSession() -> getState();
+
+        _pushTable();
+
+        bool isNumberSequence = false;
+        bool isIntegerSequence = false;
+        type = _checkTableType(state, isNumberSequence, isIntegerSequence);
+
+        LuaEngineAdapter::pop(state, 1);
+
+    });
+
+    return type;
+}
+
+LuaValueList* LuaTableValue::toArray()
+{
+    _parseValue();
+    return _parsedValue -> toArray();
+}
+
+LuaValueMap* LuaTableValue::toMap()
+{
+    _parseValue();
+    return _parsedValue -> toMap();
+}
+
+LuaNumberArray* LuaTableValue::toNumberArray()
+{
+    bool isNumberSequence = false;
+
+    _context -> getOperationQueue() -> performAction([=, &isNumberSequence](){
+
+        lua_State *state = _context -> getCurrentSession() -> getState();
+
+        _pushTable();
+
+        bool isIntegerSequence = false;
+        _checkTableType(state, isNumberSequence, isIntegerSequence);
+
+        if (isNumberSequence)
+        {
+            size_t length = LuaEngineAdapter::rawLen(state, -1);
+            if (_numberArray == NULL)
+            {
+                _numberArray = new LuaNumberArray();
+            }
+            _numberArray -> clear();
+            _numberArray -> reserve(length);
+
+            for (size_t i = 1; i <= length; i++)
+            {
+                LuaEngineAdapter::rawGetI(state, -1, (int)i);
+                _numberArray -> push_back(LuaEngineAdapter::toNumber(state, -1));
+                LuaEngineAdapter::pop(state, 1);
+            }
+        }
+
+        LuaEngineAdapter::pop(state, 1);
+
+    });
+
+    return isNumberSequence ? _numberArray : NULL;
+}
+
+LuaIntegerArray* LuaTableValue::toIntegerArray()
+{
+    bool isIntegerSequence = false;
+
+    _context -> getOperationQueue() -> performAction([=, &isIntegerSequence](){
+
+        lua_State *state = _context -> getCurrentSession() -> getState();
+
+        _pushTable();
+
+        bool isNumberSequence = false;
+        _checkTableType(state, isNumberSequence, isIntegerSequence);
+
+        if (isIntegerSequence)
+        {
+            size_t length = LuaEngineAdapter::rawLen(state, -1);
+            if (_integerArray == NULL)
+            {
+                _integerArray = new LuaIntegerArray();
+            }
+            _integerArray -> clear();
+            _integerArray -> reserve(length);
+
+            for (size_t i = 1; i <= length; i++)
+            {
+                LuaEngineAdapter::rawGetI(state, -1, (int)i);
+                _integerArray -> push_back(LuaEngineAdapter::toInteger(state, -1));
+                LuaEngineAdapter::pop(state, 1);
+            }
+        }
+
+        LuaEngineAdapter::pop(state, 1);
+
+    });
+
+    return isIntegerSequence ? _integerArray : NULL;
+}
+
+void LuaTableValue::push(LuaContext *context)
+{
+    if (context != _context)
+    {
+        //入栈到其他上下文时需要复制表数据
+        _parseValue();
+        _parsedValue -> push(context);
+    }
+    else
+    {
+        _context -> getOperationQueue() -> performAction([=](){
+            _pushTable();
+        });
+    }
+}
+
+void LuaTableValue::serialization (LuaObjectEncoder *encoder)
+{
+    _parseValue();
+    _parsedValue -> serialization(encoder);
+}
+
+size_t LuaTableValue::getLength()
+{
+    size_t length = 0;
+
+    _context -> getOperationQueue() -> performAction([=, &length](){
+
+        lua_State *state = _context -> getCurrentSession() -> getState();
+
+        _pushTable();
+        length = LuaEngineAdapter::rawLen(state, -1);
+        LuaEngineAdapter::pop(state, 1);
+
+    });
+
+    return length;
+}
+
+LuaValue* LuaTableValue::getValueForKey(std::string const& key)
+{
+    LuaValue *value = NULL;
+
+    _context -> getOperationQueue() -> performAction([=, &key, &value](){
+
+        lua_State *state = _context -> getCurrentSession() -> getState();
+
+        _pushTable();
+        LuaEngineAdapter::pushString(state, key.c_str(), key.size());
+        LuaEngineAdapter::rawGet(state, -2);
+
+        value = LuaValue::ValueByIndex(_context, -1);
+
+        LuaEngineAdapter::pop(state, 2);
+
+    });
+
+    return value;
+}
+
+LuaValue* LuaTableValue::getValueAtIndex(lua_Integer index)
+{
+    LuaValue *value = NULL;
+
+    _context -> getOperationQueue() -> performAction([=, &value](){
+
+        lua_State *state = _context -> getCurrentSession() -> getState();
+
+        _pushTable();
+        LuaEngineAdapter::pushInteger(state, index);
+        LuaEngineAdapter::rawGet(state, -2);
+
+        value = LuaValue::ValueByIndex(_context, -1);
+
+        LuaEngineAdapter::pop(state, 2);
+
+    });
+
+    return value;
+}
+
+void LuaTableValue::enumerate(LuaTableEnumerateHandler handler)
+{
+    _context -> getOperationQueue() -> performAction([=, &handler](){
+
+        lua_State *state = _context -> getCurrentSession() -> getState();
+
+        _pushTable();
+
+        LuaEngineAdapter::pushNil(state);
+        while (LuaEngineAdapter::next(state, -2))
+        {
+            LuaValue *key = LuaValue::ValueByIndex(_context, -2);
+            LuaValue *value = LuaValue::ValueByIndex(_context, -1);
+
+            bool shouldContinue = handler(key, value);
+
+            key -> release();
+            value -> release();
+
+            if (!shouldContinue)
+            {
+                LuaEngineAdapter::pop(state, 2);
+                break;
+            }
+
+            LuaEngineAdapter::pop(state, 1);
+        }
+
+        LuaEngineAdapter::pop(state, 1);
+
+    });
+}
@@ -0,0 +1,174 @@
+#ifndef LuaTableValue_hpp
+#define LuaTableValue_hpp
+
+#include <stdio.h>
+#include "LuaValue.h"
+
+namespace cn
+{
+    namespace vimfung
+    {
+        namespace luascriptcore
+        {
+            class LuaContext;
+
+            /**
+             表值，在注册表中持有Lua表的引用，仅在访问时才读取字段、长度或进行遍历，
+             调用toArray或toMap时才会将整个表转换为数组或字典。
+             表值引用的是存活的Lua表而非快照，在Lua中修改表后再访问会读取到修改后的内容。
+             toArray、toMap的转换结果为首次转换时的快照，生成后不再更新。
+             表值会持有所属上下文，直到表值释放后上下文才会被销毁。
+             */
+            class LuaTableValue : public LuaValue
+            {
+            private:
+
+                /**
+                 注册表中的引用
+                 */
+                int _ref;
+
+                /**
+                 浮点数数组，调用toNumberArray时生成，之后每次调用重新读取表并复用该数组
+                 */
+                LuaNumberArray *_numberArray;
+
+                /**
+                 整数数组，调用toIntegerArray时生成，之后每次调用重新读取表并复用该数组
+                 */
+                LuaIntegerArray *_integerArray;
+
+                /**
+                 解析后值对象
+                 */
+                LuaValue *_parsedValue;
+
+            private:
+
+                /**
+                 解析值，将整个表转换为数组或字典
+                 */
+                void _parseValue();
+
+                /**
+                 将表入栈
+                 */
+                void _pushTable();
+
+                /**
+                 检测栈顶表的类型，每次调用都会遍历表
+
+                 @param state 状态
+                 @param isNumberSequence 返回是否为元素均为数值的数组
+                 @param isIntegerSequence 返回是否为元素均为整数的数组
+                 @return 类型，LuaValueTypeArray或LuaValueTypeMap
+                 */
+                LuaValueType _checkTableType(lua_State *state, bool &isNumberSequence, bool &isIntegerSequence);
+
+            public:
+
+                /**
+                 初始化
+
+                 @param context 上下文对象
+                 @param index 栈索引
+                 */
+                LuaTableValue(LuaContext *context, int index);
+
+                /**
+                 销毁对象
+                 */
+                virtual ~LuaTableValue();
+
+                /**
+                 序列化对象
+
+                 @param encoder 编码器
+                 */
+                virtual void serialization (LuaObjectEncoder *encoder);
+
+            public:
+
+                /**
+                 * 获取类型，表中仅包含从1开始的连续整数键时为数组，否则为字典。每次调用都会重新检测表
+                 *
+                 * @return 类型
+                 */
+                virtual LuaValueType getType();
+
+                /**
+                 * 转换为数组
+                 *
+                 * @return 数组
+                 */
+                virtual LuaValueList* toArray();
+
+                /**
+                 * 转换为字典
+                 *
+                 * @return 字典
+                 */
+                virtual LuaValueMap* toMap();
+
+                /**
+                 * 转换为浮点数数组，仅当表为元素均为数值的数组时有效，元素直接读入连续内存而无需创建值对象。
+                 * 每次调用都会重新读取表，并更新之前返回的数组
+                 *
+                 * @return 浮点数数组，表不是数值数组时返回NULL
+                 */
+                virtual LuaNumberArray* toNumberArray();
+
+                /**
+                 * 转换为整数数组，仅当表为元素均为整数的数组时有效，元素直接读入连续内存而无需创建值对象。
+                 * 每次调用都会重新读取表，并更新之前返回的数组
+                 *
+                 * @return 整数数组，表不是整数数组时返回NULL
+                 */
+                virtual LuaIntegerArray* toIntegerArray();
+
+                /**
+                 * 入栈数据，入栈到所属上下文时直接使用原始的表
+                 *
+                 * @param context 上下文对象
+                 */
+                virtual void push(LuaContext *context);
+
+            public:
+
+                /**
+                 * 获取表的长度，不触发元方法
+                 *
+                 * @return 长度
+                 */
+                size_t getLength();
+
+                /**
+                 * 获取字段值，不触发元方法
+                 *
+                 * @param key 字段名称
+                 *
+                 * @return 字段值，需要调用release释放
+                 */
+                LuaValue* getValueForKey(std::string const& key);
+
+                /**
+                 * 获取元素值，不触发元方法
+                 *
+                 * @param index 下标，与Lua一致从1开始
+                 *
+                 * @return 元素值，需要调用release释放
+                 */
+                LuaValue* getValueAtIndex(lua_Integer index);
+
+                /**
+                 * 遍历表
+                 *
+                 * @param handler 遍历处理器
+                 */
+                void enumerate(LuaTableEnumerateHandler handler);
+            };
+        }
+    }
+}
+
+#endif /* LuaTableValue_hpp */
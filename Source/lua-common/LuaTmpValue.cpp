@@ -97,6 +97,18 @@ LuaValueMap* LuaTmpValue::toMap()
     return _parsedValue -> toMap();
 }
 
+LuaNumberArray* LuaTmpValue::toNumberArray()
+{
+    _parseValue();
+    return _parsedValue -> toNumberArray();
+}
+
+LuaIntegerArray* LuaTmpValue::toIntegerArray()
+{
+    _parseValue();
+    return _parsedValue -> toIntegerArray();
+}
+
 LuaPointer* LuaTmpValue::toPointer()
 {
     _parseValue();
@@ -130,6 +130,20 @@ namespace cn
                  * @return 字典
                  */
                 virtual LuaValueMap* toMap();
+
+                /**
+                 * 转换为浮点数数组
+                 *
+                 * @return 浮点数数组
+                 */
+                virtual LuaNumberArray* toNumberArray();
+
+                /**
+                 * 转换为整数数组
+                 *
+                 * @return 整数数组
+                 */
+                virtual LuaIntegerArray* toIntegerArray();
                 
                 /**
                  * 转换为指针
@@ -25,7 +25,26 @@ LuaTuple::LuaTuple (LuaObjectDecoder *decoder)
     int size = decoder -> readInt32();    
     for (int i = 0; i < size; i++)
     {
-        LuaValue *item = dynamic_cast<LuaValue *>(decoder -> readObject());
+        LuaObject *object = decoder -> readObject();
+        if (decoder -> isTruncated())
+        {
+            if (object != NULL)
+            {
+                object -> release();
+            }
+            break;
+        }
+
+        //无法解析的返回值使用nil占位，保持返回值数量及顺序不变
+        LuaValue *item = dynamic_cast<LuaValue *>(object);
+        if (item == NULL)
+        {
+            if (object != NULL)
+            {
+                object -> release();
+            }
+            item = LuaValue::NilValue();
+        }
         _returnValues.push_back(item);
     }
 }
@@ -24,12 +24,102 @@ using namespace cn::vimfung::luascriptcore;
 
 DECLARE_NATIVE_CLASS(LuaValue);
 
+/**
+ * 每个线程空闲链表中保留的最大内存块数量
+ */
+static const size_t MaxFreeValueBlockCount = 1024;
+
+/**
+ * 空闲内存块
+ */
+struct LuaValueFreeBlock
+{
+    LuaValueFreeBlock *next;
+};
+
+/**
+ * 当前线程的空闲内存块链表
+ */
+static thread_local LuaValueFreeBlock *_freeValueBlocks = NULL;
+
+/**
+ * 当前线程空闲链表中的内存块数量
+ */
+static thread_local size_t _freeValueBlockCount = 0;
+
+/**
+ * 当前线程的空闲链表是否已销毁，线程退出后释放的内存块直接交还系统
+ */
+static thread_local bool _freeValueBlocksDestroyed = false;
+
+/**
+ * 空闲链表清理器，线程退出时释放链表中的内存块
+ */
+struct LuaValueFreeBlocksCleaner
+{
+    ~LuaValueFreeBlocksCleaner()
+    {
+        while (_freeValueBlocks != NULL)
+        {
+            LuaValueFreeBlock *next = _freeValueBlocks -> next;
+            ::operator delete(_freeValueBlocks);
+            _freeValueBlocks = next;
+        }
+
+        _freeValueBlockCount = 0;
+        _freeValueBlocksDestroyed = true;
+    }
+};
+
+static thread_local LuaValueFreeBlocksCleaner _freeValueBlocksCleaner;
+
+void* LuaValue::operator new(size_t size)
+{
+    if (size == sizeof(LuaValue) && _freeValueBlocks != NULL)
+    {
+        LuaValueFreeBlock *block = _freeValueBlocks;
+        _freeValueBlocks = block -> next;
+        _freeValueBlockCount --;
+
+        return block;
+    }
+
+    return ::operator new(size);
+}
+
+void LuaValue::operator delete(void *ptr, size_t size)
+{
+    if (ptr == NULL)
+    {
+        return;
+    }
+
+    if (size == sizeof(LuaValue)
+        && !_freeValueBlocksDestroyed
+        && _freeValueBlockCount < MaxFreeValueBlockCount)
+    {
+        //访问清理器以确保线程退出时释放空闲链表
+        (void)&_freeValueBlocksCleaner;
+
+        LuaValueFreeBlock *block = (LuaValueFreeBlock *)ptr;
+        block -> next = _freeValueBlocks;
+        _freeValueBlocks = block;
+        _freeValueBlockCount ++;
+
+        return;
+    }
+
+    ::operator delete(ptr);
+}
+
 LuaValue::LuaValue()
         : LuaObject()
 {
     _type = LuaValueTypeNil;
     _value = NULL;
+    _isInlineBytes = false;
     _hasManagedObject = false;
+    _context = NULL;
 }
 
 LuaValue::LuaValue(long value)
@@ -37,8 +127,9 @@ LuaValue::LuaValue(long value)
 {
     _type = LuaValueTypeInteger;
     _intValue = (lua_Integer)value;
-    _value = NULL;
+    _isInlineBytes = false;
     _hasManagedObject = false;
+    _context = NULL;
 }
 
 LuaValue::LuaValue(bool value)
@@ -46,8 +137,9 @@ LuaValue::LuaValue(bool value)
 {
     _type = LuaValueTypeBoolean;
     _booleanValue = value;
-    _value = NULL;
+    _isInlineBytes = false;
     _hasManagedObject = false;
+    _context = NULL;
 }
 
 LuaValue::LuaValue(double value)
@@ -55,26 +147,27 @@ LuaValue::LuaValue(double value)
 {
     _type = LuaValueTypeNumber;
     _numberValue = value;
-    _value = NULL;
+    _isInlineBytes = false;
     _hasManagedObject = false;
+    _context = NULL;
 }
 
 LuaValue::LuaValue(std::string const& value)
         : LuaObject()
 {
     _type = LuaValueTypeString;
-    _value = new std::string(value);
+    setBytes(value.c_str(), value.size());
     _hasManagedObject = false;
+    _context = NULL;
 }
 
 LuaValue::LuaValue(const char *bytes, size_t length)
         : LuaObject()
 {
     _type = LuaValueTypeData;
-    _bytesLen = length;
-    _value = new char[_bytesLen];
-    std::memcpy(_value, bytes, _bytesLen);
+    setBytes(bytes, length);
     _hasManagedObject = false;
+    _context = NULL;
 }
 
 LuaValue::LuaValue(LuaValueList value)
@@ -82,7 +175,9 @@ LuaValue::LuaValue(LuaValueList value)
 {
     _type = LuaValueTypeArray;
     _value = new LuaValueList(value);
+    _isInlineBytes = false;
     _hasManagedObject = false;
+    _context = NULL;
 }
 
 LuaValue::LuaValue(LuaValueMap value)
@@ -90,7 +185,29 @@ LuaValue::LuaValue(LuaValueMap value)
 {
     _type = LuaValueTypeMap;
     _value = new LuaValueMap (value);
+    _isInlineBytes = false;
+    _hasManagedObject = false;
+    _context = NULL;
+}
+
+LuaValue::LuaValue(LuaNumberArray const& value)
+        : LuaObject()
+{
+    _type = LuaValueTypeNumberArray;
+    _value = new LuaNumberArray(value);
+    _isInlineBytes = false;
+    _hasManagedObject = false;
+    _context = NULL;
+}
+
+LuaValue::LuaValue(LuaIntegerArray const& value)
+        : LuaObject()
+{
+    _type = LuaValueTypeIntegerArray;
+    _value = new LuaIntegerArray(value);
+    _isInlineBytes = false;
     _hasManagedObject = false;
+    _context = NULL;
 }
 
 LuaValue::LuaValue (LuaPointer *value)
@@ -100,7 +217,9 @@ LuaValue::LuaValue (LuaPointer *value)
 
     value -> retain();
     _value = (void *)value;
+    _isInlineBytes = false;
     _hasManagedObject = false;
+    _context = NULL;
 }
 
 LuaValue::LuaValue (LuaObjectDescriptor *value)
@@ -109,7 +228,9 @@ LuaValue::LuaValue (LuaObjectDescriptor *value)
 
     value -> retain();
     _value = (void *)value;
+    _isInlineBytes = false;
     _hasManagedObject = false;
+    _context = NULL;
 }
 
 LuaValue::LuaValue(LuaFunction *value)
@@ -118,7 +239,9 @@ LuaValue::LuaValue(LuaFunction *value)
 
     value -> retain();
     _value = (void *)value;
+    _isInlineBytes = false;
     _hasManagedObject = false;
+    _context = NULL;
 }
 
 LuaValue::LuaValue (LuaTuple *value)
@@ -127,7 +250,9 @@ LuaValue::LuaValue (LuaTuple *value)
 
     value -> retain();
     _value = (void *)value;
+    _isInlineBytes = false;
     _hasManagedObject = false;
+    _context = NULL;
 }
 
 LuaValue::LuaValue (LuaExportTypeDescriptor *value)
@@ -136,18 +261,18 @@ LuaValue::LuaValue (LuaExportTypeDescriptor *value)
 
     value -> retain();
     _value = (void *)value;
+    _isInlineBytes = false;
     _hasManagedObject = false;
+    _context = NULL;
 }
 
 LuaValue::LuaValue(LuaObjectDecoder *decoder)
     : LuaObject(decoder)
 {
     _hasManagedObject = false;
+    _context = NULL;
 	_value = NULL;
-	_intValue = 0;
-	_numberValue = 0;
-	_booleanValue = false;
-	_bytesLen = 0;
+    _isInlineBytes = false;
     _type = (LuaValueType)decoder -> readInt16();
 
     switch (_type)
@@ -162,18 +287,40 @@ LuaValue::LuaValue(LuaObjectDecoder *decoder)
             _booleanValue = decoder -> readByte();
             break;
         case LuaValueTypeString:
-            _value = new std::string(decoder -> readString());
-            break;
         case LuaValueTypeData:
-            decoder -> readBytes(&_value, (int *)&_bytesLen);
+        {
+            //直接从解码器的缓冲区复制数据，避免中间副本
+            int length = 0;
+            const char *bytes = decoder -> readBytesView(&length);
+            setBytes(bytes, (size_t)length);
             break;
+        }
         case LuaValueTypeArray:
         {
             int size = decoder -> readInt32();
             LuaValueList *list = new LuaValueList();
             for (int i = 0; i < size; i++)
             {
-                LuaValue *item = dynamic_cast<LuaValue *>(decoder -> readObject());
+                LuaObject *object = decoder -> readObject();
+                if (decoder -> isTruncated())
+                {
+                    if (object != NULL)
+                    {
+                        object -> release();
+                    }
+                    break;
+                }
+
+                //无法解析的元素使用nil占位，保持元素下标不变
+                LuaValue *item = dynamic_cast<LuaValue *>(object);
+                if (item == NULL)
+                {
+                    if (object != NULL)
+                    {
+                        object -> release();
+                    }
+                    item = LuaValue::NilValue();
+                }
                 list -> push_back(item);
             }
             _value = list;
@@ -183,7 +330,7 @@ LuaValue::LuaValue(LuaObjectDecoder *decoder)
         {
             int size = decoder -> readInt32();
             LuaValueMap *map = new LuaValueMap();
-            for (int i = 0; i < size; i++)
+            for (int i = 0; i < size && !decoder -> isTruncated(); i++)
             {
                 std::string key = decoder -> readString();
                 LuaValue *item = dynamic_cast<LuaValue *>(decoder -> readObject());
@@ -242,9 +389,18 @@ LuaValue::~LuaValue()
         _context -> getDataExchanger() -> releaseLuaObject(this);
     }
 
-    if (_value != NULL)
+    switch (_type)
     {
-        if (_type == LuaValueTypeArray)
+        case LuaValueTypeString:
+        case LuaValueTypeData:
+        {
+            if (!_isInlineBytes)
+            {
+                delete[] _bytesValue.buffer;
+            }
+            break;
+        }
+        case LuaValueTypeArray:
         {
             //对于Table类型需要释放其子对象内存
             LuaValueList *arrayValue = static_cast<LuaValueList *> (_value);
@@ -256,9 +412,12 @@ LuaValue::~LuaValue()
                     LuaValue *value = *i;
                     value -> release();
                 }
+
+                delete arrayValue;
             }
+            break;
         }
-        else if (_type == LuaValueTypeMap)
+        case LuaValueTypeMap:
         {
             //为字典对象
             LuaValueMap *mapValue = static_cast<LuaValueMap *> (_value);
@@ -268,36 +427,72 @@ LuaValue::~LuaValue()
                 {
                     i->second->release();
                 }
+
+                delete mapValue;
             }
+            break;
         }
-        else if (_type == LuaValueTypePtr
-                 || _type == LuaValueTypeObject
-                 || _type == LuaValueTypeFunction
-                 || _type == LuaValueTypeTuple
-                 || _type == LuaValueTypeClass)
+        case LuaValueTypeNumberArray:
         {
-            ((LuaObject *)_value) -> release();
+            delete static_cast<LuaNumberArray *>(_value);
+            break;
         }
-
-        if (_type != LuaValueTypePtr
-            && _type != LuaValueTypeObject
-            && _type != LuaValueTypeFunction
-            && _type != LuaValueTypeTuple
-            && _type != LuaValueTypeClass)
+        case LuaValueTypeIntegerArray:
+        {
+            delete static_cast<LuaIntegerArray *>(_value);
+            break;
+        }
+        case LuaValueTypePtr:
+        case LuaValueTypeObject:
+        case LuaValueTypeFunction:
+        case LuaValueTypeTuple:
+        case LuaValueTypeClass:
         {
-            if (_type == LuaValueTypeString)
+            if (_value != NULL)
             {
-                //fixed：string无法直接通过delete释放，需要使用swap来实现释放操作
-                std::string().swap(*((std::string *)_value));
+                ((LuaObject *)_value) -> release();
             }
-
-            delete[] (char *)_value;
+            break;
         }
+        default:
+            break;
+    }
 
-        _value = NULL;
+    _value = NULL;
+}
+
+void LuaValue::setBytes(const char *bytes, size_t length)
+{
+    if (length <= InlineBytesCapacity)
+    {
+        _isInlineBytes = true;
+        _inlineBytesLength = (unsigned char)length;
+        if (length > 0)
+        {
+            std::memcpy(_inlineBytes, bytes, length);
+        }
+        _inlineBytes[length] = '\0';
+    }
+    else
+    {
+        _isInlineBytes = false;
+        _bytesValue.length = length;
+        _bytesValue.buffer = new char[length + 1];
+        std::memcpy(_bytesValue.buffer, bytes, length);
+        _bytesValue.buffer[length] = '\0';
     }
 }
 
+const char* LuaValue::getBytes()
+{
+    return _isInlineBytes ? _inlineBytes : _bytesValue.buffer;
+}
+
+size_t LuaValue::getBytesLength()
+{
+    return _isInlineBytes ? _inlineBytesLength : _bytesValue.length;
+}
+
 LuaValue* LuaValue::NilValue()
 {
     return new LuaValue();
@@ -323,6 +518,15 @@ LuaValue* LuaValue::StringValue(std::string const& value)
     return new LuaValue(value);
 }
 
+LuaValue* LuaValue::StringValue(const char *value, size_t length)
+{
+    LuaValue *stringValue = new LuaValue();
+    stringValue -> _type = LuaValueTypeString;
+    stringValue -> setBytes(value, length);
+
+    return stringValue;
+}
+
 LuaValue* LuaValue::DataValue(const char *bytes, size_t length)
 {
     return new LuaValue(bytes, length);
@@ -338,6 +542,16 @@ LuaValue* LuaValue::DictonaryValue(LuaValueMap value)
     return new LuaValue(value);
 }
 
+LuaValue* LuaValue::NumberArrayValue(LuaNumberArray const& value)
+{
+    return new LuaValue(value);
+}
+
+LuaValue* LuaValue::IntegerArrayValue(LuaIntegerArray const& value)
+{
+    return new LuaValue(value);
+}
+
 LuaValue* LuaValue::PointerValue(LuaPointer *value)
 {
     return new LuaValue(value);
@@ -401,7 +615,7 @@ const std::string LuaValue::toString()
 {
     if (_type == LuaValueTypeString)
     {
-        return *((const std::string *)_value);
+        return std::string(getBytes(), getBytesLength());
     }
 
     return NULL;
@@ -431,7 +645,7 @@ const char* LuaValue::toData()
 {
     if (_type == LuaValueTypeData)
     {
-        return (const char *)_value;
+        return getBytes();
     }
 
     return NULL;
@@ -441,7 +655,7 @@ size_t LuaValue::getDataLength()
 {
     if (_type == LuaValueTypeData)
     {
-        return _bytesLen;
+        return getBytesLength();
     }
 
     return 0;
@@ -467,6 +681,26 @@ LuaValueMap* LuaValue::toMap()
     return NULL;
 }
 
+LuaNumberArray* LuaValue::toNumberArray()
+{
+    if (_type == LuaValueTypeNumberArray)
+    {
+        return static_cast<LuaNumberArray *>(_value);
+    }
+
+    return NULL;
+}
+
+LuaIntegerArray* LuaValue::toIntegerArray()
+{
+    if (_type == LuaValueTypeIntegerArray)
+    {
+        return static_cast<LuaIntegerArray *>(_value);
+    }
+
+    return NULL;
+}
+
 LuaPointer* LuaValue::toPointer()
 {
     if (_type == LuaValueTypePtr)
@@ -525,9 +759,18 @@ void LuaValue::serialization (LuaObjectEncoder *encoder)
 {
     LuaObject::serialization(encoder);
     
-    encoder -> writeInt16(getType());
+    LuaValueType type = getType();
+    if (type == LuaValueTypeNumberArray || type == LuaValueTypeIntegerArray)
+    {
+        //数值数组按普通数组序列化，保持与各平台的数据格式一致
+        encoder -> writeInt16(LuaValueTypeArray);
+    }
+    else
+    {
+        encoder -> writeInt16(type);
+    }
     
-    switch (getType())
+    switch (type)
     {
         case LuaValueTypeNumber:
         {
@@ -563,6 +806,30 @@ void LuaValue::serialization (LuaObjectEncoder *encoder)
             }
             break;
         }
+        case LuaValueTypeNumberArray:
+        {
+            LuaNumberArray *list = toNumberArray();
+            encoder -> writeInt32((int)list -> size());
+            for (LuaNumberArray::iterator it = list -> begin(); it != list -> end(); ++it)
+            {
+                LuaValue *value = LuaValue::NumberValue(*it);
+                encoder -> writeObject(value);
+                value -> release();
+            }
+            break;
+        }
+        case LuaValueTypeIntegerArray:
+        {
+            LuaIntegerArray *list = toIntegerArray();
+            encoder -> writeInt32((int)list -> size());
+            for (LuaIntegerArray::iterator it = list -> begin(); it != list -> end(); ++it)
+            {
+                LuaValue *value = LuaValue::IntegerValue((long)*it);
+                encoder -> writeObject(value);
+                value -> release();
+            }
+            break;
+        }
         case LuaValueTypeMap:
         {
             LuaValueMap *map = toMap();
@@ -33,13 +33,35 @@ namespace cn
             class LuaValue : public LuaObject
             {
             private:
+
+                /**
+                 * 内联存储的最大字节数，不超过该长度的字符串及二进制数据直接存储在值对象中，无需额外分配内存
+                 */
+                static const size_t InlineBytesCapacity = 23;
+
+                /**
+                 * 堆上存储的字节数据
+                 */
+                struct BytesValue
+                {
+                    char *buffer;       //数据缓冲区，以'\0'结尾
+                    size_t length;      //数据长度
+                };
+
                 LuaValueType _type;
-                lua_Integer _intValue;
-                bool _booleanValue;
-                double _numberValue;
-                size_t _bytesLen;
-                void *_value;
                 bool _hasManagedObject;
+                bool _isInlineBytes;
+                unsigned char _inlineBytesLength;
+
+                union
+                {
+                    lua_Integer _intValue;
+                    bool _booleanValue;
+                    double _numberValue;
+                    void *_value;
+                    BytesValue _bytesValue;
+                    char _inlineBytes[InlineBytesCapacity + 1];
+                };
                 
             protected:
                 
@@ -57,6 +79,47 @@ namespace cn
                  */
                 void managedObject(LuaContext *context);
 
+                /**
+                 * 设置字节数据，用于字符串及二进制数据
+                 *
+                 * @param bytes 数据
+                 * @param length 数据长度
+                 */
+                void setBytes(const char *bytes, size_t length);
+
+                /**
+                 * 获取字节数据
+                 *
+                 * @return 数据
+                 */
+                const char* getBytes();
+
+                /**
+                 * 获取字节数据长度
+                 *
+                 * @return 数据长度
+                 */
+                size_t getBytesLength();
+
+            public:
+
+                /**
+                 * 分配值对象内存，LuaValue大小的内存块优先从当前线程的空闲链表中获取
+                 *
+                 * @param size 内存大小
+                 *
+                 * @return 内存块
+                 */
+                static void* operator new(size_t size);
+
+                /**
+                 * 释放值对象内存，LuaValue大小的内存块将放回当前线程的空闲链表中
+                 *
+                 * @param ptr 内存块
+                 * @param size 内存大小
+                 */
+                static void operator delete(void *ptr, size_t size);
+
             public:
                 /**
                  * 初始化
@@ -121,6 +184,20 @@ namespace cn
                  */
                 LuaValue (LuaValueMap value);
 
+                /**
+                 * 初始化
+                 *
+                 * @param value 浮点数数组
+                 */
+                LuaValue (LuaNumberArray const& value);
+
+                /**
+                 * 初始化
+                 *
+                 * @param value 整数数组
+                 */
+                LuaValue (LuaIntegerArray const& value);
+
                 /**
                  * 初始化
                  *
@@ -240,6 +317,20 @@ namespace cn
                  */
                 virtual LuaValueMap* toMap();
 
+                /**
+                 * 转换为浮点数数组
+                 *
+                 * @return 浮点数数组
+                 */
+                virtual LuaNumberArray* toNumberArray();
+
+                /**
+                 * 转换为整数数组
+                 *
+                 * @return 整数数组
+                 */
+                virtual LuaIntegerArray* toIntegerArray();
+
                 /**
                  * 转换为指针
                  *
@@ -327,6 +418,16 @@ namespace cn
                  */
                 static LuaValue* StringValue(std::string const& value);
 
+                /**
+                 * 创建一个字符串值对象
+                 *
+                 * @param value 字符串
+                 * @param length 字符串长度
+                 *
+                 * @return 值对象
+                 */
+                static LuaValue* StringValue(const char *value, size_t length);
+
                 /**
                  * 创建一个二进制数组值对象
                  *
@@ -355,6 +456,24 @@ namespace cn
                  */
                 static LuaValue* DictonaryValue(LuaValueMap value);
 
+                /**
+                 * 创建一个浮点数数组值对象，数组元素连续存储，入栈时一次性写入预分配的表中
+                 *
+                 * @param value 浮点数数组
+                 *
+                 * @return 值对象
+                 */
+                static LuaValue* NumberArrayValue(LuaNumberArray const& value);
+
+                /**
+                 * 创建一个整数数组值对象，数组元素连续存储，入栈时一次性写入预分配的表中
+                 *
+                 * @param value 整数数组
+                 *
+                 * @return 值对象
+                 */
+                static LuaValue* IntegerArrayValue(LuaIntegerArray const& value);
+
                 /**
                  * 创建一个指针值对象
                  *